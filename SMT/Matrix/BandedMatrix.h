@@ -0,0 +1,356 @@
+#ifndef __BANDED_MATRIX_H__
+#define __BANDED_MATRIX_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Banded matrix
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixAlgorithms.h"
+#include "MatrixChecks.h"
+#include "MatrixSimd.h"
+#include "StandardMatrix.h"
+#include "../Threading/ThreadPool.h"
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Banded matrix.
+// Only elements of the band (LowerBandwidth() diagonals below the main one and UpperBandwidth() diagonals above it)
+// are nonzero. Every row of the band is stored in LowerBandwidth() + UpperBandwidth() + 1 elements: the element
+// (row, column) is Band()[row * width + column - row + LowerBandwidth()] (positions outside the matrix are zeros).
+//    So the matrix takes O(N * b) memory, sums and products of banded matrices take O(N * b^2) time and are banded,
+//    the determinant and linear solves use the banded LU decomposition (O(N * b^2) instead of O(N^3)).
+//    The matrix is immutable, so copies share the band.
+template <typename ElementType>
+class BandedMatrix : public Matrix<ElementType>
+{
+public:
+   using InitFunc = std::function<ElementType (size_t /*row*/, size_t /*column*/)>; // A function which initializes elements of the band
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+
+   // Creates a zero matrix
+   BandedMatrix(size_t size, size_t lowerBandwidth, size_t upperBandwidth)
+      : BandedMatrix(size, lowerBandwidth, upperBandwidth, std::vector<ElementType>(size * (lowerBandwidth + upperBandwidth + 1), MatrixSettings::Zero<ElementType>()))
+   {
+   }
+   // initFunc is called for elements of the band only
+   BandedMatrix(size_t size, size_t lowerBandwidth, size_t upperBandwidth, const InitFunc& initFunc)
+      : size_(size)
+      , lowerBandwidth_(lowerBandwidth)
+      , upperBandwidth_(upperBandwidth)
+   {
+      std::vector<ElementType> band(size_ * width(), MatrixSettings::Zero<ElementType>());
+      for (size_t row = 0; row < size_; ++row)
+      {
+         for (size_t column = firstColumn(row); column < lastColumn(row); ++column)
+         {
+            band[position(row, column)] = initFunc(row, column);
+         }
+      }
+      band_ = std::make_shared<const std::vector<ElementType>>(std::move(band));
+   }
+   // Takes the band of the matrix (the rest of it is ignored)
+   BandedMatrix(const Matrix<ElementType>& sourceMatrix, size_t lowerBandwidth, size_t upperBandwidth)
+      : size_(sourceMatrix.RowCount())
+      , lowerBandwidth_(lowerBandwidth)
+      , upperBandwidth_(upperBandwidth)
+   {
+      assert(sourceMatrix.RowCount() == sourceMatrix.ColumnCount());
+      std::vector<ElementType> band(size_ * width(), MatrixSettings::Zero<ElementType>());
+      for (size_t row = 0; row < size_; ++row)
+      {
+         sourceMatrix.CopyTile(row, firstColumn(row), 1, lastColumn(row) - firstColumn(row), &band[position(row, firstColumn(row))], width());
+      }
+      band_ = std::make_shared<const std::vector<ElementType>>(std::move(band));
+   }
+   // Adopts the band (size * (lowerBandwidth + upperBandwidth + 1) elements, see the class description)
+   BandedMatrix(size_t size, size_t lowerBandwidth, size_t upperBandwidth, std::vector<ElementType>&& band)
+      : size_(size)
+      , lowerBandwidth_(lowerBandwidth)
+      , upperBandwidth_(upperBandwidth)
+      , band_(std::make_shared<const std::vector<ElementType>>(std::move(band)))
+   {
+      assert(band_->size() == size_ * width());
+   }
+
+   size_t LowerBandwidth() const { return lowerBandwidth_; }
+   size_t UpperBandwidth() const { return upperBandwidth_; }
+   // Rows of the band (see the class description)
+   const ElementType* Band() const { return band_->data(); }
+   // LU decomposition of the matrix (it can be reused for several determinants and solves)
+   Algorithms::BandedLUDecomposition<ElementType> FactorizeLU() const { return Algorithms::BandedLUDecomposition<ElementType>(size_, lowerBandwidth_, upperBandwidth_, Band()); }
+
+   // Matrix
+   virtual size_t RowCount() const override { return size_; }
+   virtual size_t ColumnCount() const override { return size_; }
+   virtual ElementType Element(size_t row, size_t column) const override
+   {
+      return ((column >= firstColumn(row)) && (column < lastColumn(row))) ? (*band_)[position(row, column)] : MatrixSettings::Zero<ElementType>();
+   }
+   virtual std::string TypeName() const { return "BandedMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   // Rows of the band are contiguous, the rest of the tile is filled with zeros
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         std::fill(destination, destination + columnCount, MatrixSettings::Zero<ElementType>());
+         const size_t first = std::max(column, firstColumn(row + tileRow));
+         const size_t last = std::min(column + columnCount, lastColumn(row + tileRow));
+         if (first < last)
+         {
+            const ElementType* source = &(*band_)[position(row + tileRow, first)];
+            std::copy(source, source + (last - first), &destination[first - column]);
+         }
+      }
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<BandedMatrix<ElementType>>(*this);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The sum with a banded matrix is banded, other sums are standard
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override
+   {
+      return (dynamic_cast<const BandedMatrix<ElementType>*>(&otherMatrix) != nullptr) ? Complexity::Linear : Complexity::Quadratic;
+   }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override { return add(otherMatrix); }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Linear; }
+   virtual OperationResult MultiplyByNumber(const ElementType& number) const override
+   {
+      OperationResult result;
+      std::vector<ElementType> band(*band_);
+      Kernels::ScaleRow(band.data(), number, band.size());
+      result.Matrix_ = std::make_shared<BandedMatrix<ElementType>>(size_, lowerBandwidth_, upperBandwidth_, std::move(band));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The product with a banded matrix is banded (bandwidths are summed), other products are standard
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool /*anotherMatrixIsOnTheLeft*/) const override
+   {
+      return (dynamic_cast<const BandedMatrix<ElementType>*>(&anotherMatrix) != nullptr) ? Complexity::Linear : Complexity::Quadratic;
+   }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override { return multiply(anotherMatrix, anotherMatrixIsOnTheLeft); }
+   // The inverse of a banded matrix is dense in general: it is the solution for the identity matrix
+   virtual Complexity::Type InversionComplexity() const override { return Complexity::Quadratic; }
+   virtual OperationResult Invert() const override
+   {
+      OperationResult result = Solve(StandardMatrix<ElementType>(size_, size_, MatrixSettings::IdentityMatrixFunction<ElementType>()));
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         result.Description_ = "Matrix can't be inverted: it is not invertible";
+      }
+      return result;
+   }
+   // The transposed band has swapped bandwidths
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Linear; }
+   virtual OperationResult Transpose() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<BandedMatrix<ElementType>>(size_, upperBandwidth_, lowerBandwidth_, [this](size_t row, size_t column) { return Element(column, row); });
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // Banded LU decomposition: O(N * b^2)
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Linear; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      result.Value_.reset(new ElementType(FactorizeLU().Determinant()));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // Banded LU decomposition and substitution: O(N * b^2 + N * b * columns)
+   virtual Complexity::Type SolvingComplexity(const Matrix<ElementType>& rightHandSide) const override { return (rightHandSide.ColumnCount() == 1) ? Complexity::Linear : Complexity::Quadratic; }
+   virtual OperationResult Solve(const Matrix<ElementType>& rightHandSide) const override
+   {
+      OperationResult result;
+      CheckIfCanSolve(*this, rightHandSide, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const Algorithms::BandedLUDecomposition<ElementType> decomposition = FactorizeLU();
+      if (decomposition.IsSingular())
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Linear system can't be solved: the matrix is not invertible";
+         return result;
+      }
+      auto solution = std::make_shared<StandardMatrix<ElementType>>(rightHandSide);
+      decomposition.Solve(solution->Data(), rightHandSide.ColumnCount(), rightHandSide.ColumnCount());
+      result.Matrix_ = solution;
+      return result;
+   }
+
+private:
+   size_t size_;
+   size_t lowerBandwidth_;
+   size_t upperBandwidth_;
+   std::shared_ptr<const std::vector<ElementType>> band_;   // Immutable, shared with copies
+
+   size_t width() const { return lowerBandwidth_ + upperBandwidth_ + 1; }
+   // Columns [firstColumn(row), lastColumn(row)) of the row belong to the band
+   size_t firstColumn(size_t row) const { return (row > lowerBandwidth_) ? row - lowerBandwidth_ : 0; }
+   size_t lastColumn(size_t row) const { return std::min(size_, row + upperBandwidth_ + 1); }
+   size_t position(size_t row, size_t column) const { return row * width() + column + lowerBandwidth_ - row; }
+
+   // Calls func(firstRow, lastRow) for ranges of rows; large operations are distributed between threads of the
+   // library pool
+   template <typename RangeFunc>
+   static void forEachRowRange(size_t rowCount, double operationCount, const RangeFunc& func)
+   {
+      if ((rowCount < 2) || (operationCount < static_cast<double>(ParallelSettings::MultiplyThreshold())) || (ParallelSettings::ThreadCount() == 1))
+      {
+         func(0, rowCount);
+         return;
+      }
+      const size_t rangeCount = std::min(rowCount, 4 * ParallelSettings::ThreadCount());
+      ParallelSettings::Pool().ParallelFor(rangeCount, [&](size_t range)
+      {
+         func(rowCount * range / rangeCount, rowCount * (range + 1) / rangeCount);
+      });
+   }
+
+   OperationResult add(const Matrix<ElementType>& otherMatrix) const
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const BandedMatrix<ElementType>* bandedMatrix = dynamic_cast<const BandedMatrix<ElementType>*>(&otherMatrix);
+      if (bandedMatrix == nullptr)
+      {
+         return StandardMatrix<ElementType>::Add(otherMatrix, *this);
+      }
+      const size_t lowerBandwidth = std::max(lowerBandwidth_, bandedMatrix->lowerBandwidth_);
+      const size_t upperBandwidth = std::max(upperBandwidth_, bandedMatrix->upperBandwidth_);
+      std::vector<ElementType> band(size_ * (lowerBandwidth + upperBandwidth + 1), MatrixSettings::Zero<ElementType>());
+      for (const BandedMatrix<ElementType>* term : { this, bandedMatrix })
+      {
+         // Rows of the term are shifted inside the wider rows of the sum
+         for (size_t row = 0; row < size_; ++row)
+         {
+            const size_t first = term->firstColumn(row);
+            Kernels::SubtractScaledRow(&band[row * (lowerBandwidth + upperBandwidth + 1) + first + lowerBandwidth - row], &(*term->band_)[term->position(row, first)],
+               -MatrixSettings::One<ElementType>(), term->lastColumn(row) - first);
+         }
+      }
+      result.Matrix_ = std::make_shared<BandedMatrix<ElementType>>(size_, lowerBandwidth, upperBandwidth, std::move(band));
+      return result;
+   }
+
+   OperationResult multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(anotherMatrixIsOnTheLeft ? anotherMatrix : *this, anotherMatrixIsOnTheLeft ? *this : anotherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const BandedMatrix<ElementType>* bandedMatrix = dynamic_cast<const BandedMatrix<ElementType>*>(&anotherMatrix);
+      if (bandedMatrix != nullptr)
+      {
+         result.Matrix_ = anotherMatrixIsOnTheLeft ? bandedMatrix->multiplyBanded(*this) : multiplyBanded(*bandedMatrix);
+         return result;
+      }
+      anotherMatrix.PrepareForReuse(size_);
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&anotherMatrix);
+      std::unique_ptr<StandardMatrix<ElementType>> copy;
+      if (standardMatrix == nullptr)
+      {
+         copy.reset(new StandardMatrix<ElementType>(anotherMatrix));
+         standardMatrix = copy.get();
+      }
+      auto product = std::make_shared<StandardMatrix<ElementType>>(anotherMatrixIsOnTheLeft ? anotherMatrix.RowCount() : size_, anotherMatrixIsOnTheLeft ? size_ : anotherMatrix.ColumnCount());
+      if (anotherMatrixIsOnTheLeft)
+      {
+         multiplyDenseByBanded(*standardMatrix, product->Data());
+      }
+      else
+      {
+         multiplyBandedByDense(*standardMatrix, product->Data());
+      }
+      result.Matrix_ = product;
+      return result;
+   }
+
+   // Row i of the product is the sum of band rows of the right matrix scaled by the band row i of this one, it is
+   // banded with the summed bandwidths
+   std::shared_ptr<BandedMatrix<ElementType>> multiplyBanded(const BandedMatrix<ElementType>& right) const
+   {
+      const size_t lowerBandwidth = lowerBandwidth_ + right.lowerBandwidth_;
+      const size_t productWidth = lowerBandwidth + upperBandwidth_ + right.upperBandwidth_ + 1;
+      std::vector<ElementType> band(size_ * productWidth, MatrixSettings::Zero<ElementType>());
+      forEachRowRange(size_, static_cast<double>(size_) * width() * right.width(), [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            for (size_t inner = firstColumn(row); inner < lastColumn(row); ++inner)
+            {
+               const size_t first = right.firstColumn(inner);
+               Kernels::SubtractScaledRow(&band[row * productWidth + first + lowerBandwidth - row], &(*right.band_)[right.position(inner, first)], -(*band_)[position(row, inner)],
+                  right.lastColumn(inner) - first);
+            }
+         }
+      });
+      return std::make_shared<BandedMatrix<ElementType>>(size_, lowerBandwidth, upperBandwidth_ + right.upperBandwidth_, std::move(band));
+   }
+
+   // Product = This * matrix: row i of the product is the sum of rows of the matrix scaled by the band row i
+   void multiplyBandedByDense(const StandardMatrix<ElementType>& matrix, ElementType* product) const
+   {
+      const size_t columnCount = matrix.ColumnCount();
+      const ElementType* data = matrix.Data();
+      forEachRowRange(size_, static_cast<double>(size_) * width() * columnCount, [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            for (size_t inner = firstColumn(row); inner < lastColumn(row); ++inner)
+            {
+               Kernels::SubtractScaledRow(&product[row * columnCount], &data[inner * columnCount], -(*band_)[position(row, inner)], columnCount);
+            }
+         }
+      });
+   }
+
+   // Product = matrix * This: row i of the product is the sum of band rows scaled by the row i of the matrix
+   void multiplyDenseByBanded(const StandardMatrix<ElementType>& matrix, ElementType* product) const
+   {
+      const size_t rowCount = matrix.RowCount();
+      const ElementType* data = matrix.Data();
+      forEachRowRange(rowCount, static_cast<double>(rowCount) * size_ * width(), [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            for (size_t inner = 0; inner < size_; ++inner)
+            {
+               const ElementType& factor = data[row * size_ + inner];
+               // Only exact zeros are skipped: small factors are real values
+               if (factor != MatrixSettings::Zero<ElementType>())
+               {
+                  const size_t first = firstColumn(inner);
+                  Kernels::SubtractScaledRow(&product[row * size_ + first], &(*band_)[position(inner, first)], -factor, lastColumn(inner) - first);
+               }
+            }
+         }
+      });
+   }
+};
+
+} // namespace SMT
+
+#endif // __BANDED_MATRIX_H__
@@ -6,55 +6,90 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 
 #include "MatrixDefs.h"
 #include "MatrixOperations.h"
-#include "MatrixAlgorithms.h"
+#include "MatrixKernels.h"
+#include "MatrixMemory.h"
+#include "MatrixSimd.h"
 #include "StandardMatrix.h"
 
 namespace SMT
 {
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Block matrix.
-// It represents as a matrix of standard matrices.
+// It represents as a matrix of blocks (tiles) which are stored one after another in one buffer.
+//    The matrix is split into block rows of blockSize rows (the last one may be lower). Every block row is stored
+//    contiguously: its blocks go from left to right, every block is stored row by row and has its own width (blockSize
+//    or less for the last block column). So every block is a small contiguous row-major matrix.
 template <typename ElementType>
-class BlockMatrix 
+class BlockMatrix
    : public Matrix<ElementType>
    , public Matrix<ElementType>::IElementaryOperations
+   , public Matrix<ElementType>::IInPlaceOperations
 {
 public:
    using InitFunc = std::function<ElementType (size_t /*column*/, size_t /*row*/)>; // A function which initializes all matrix elements
-   BlockMatrix(size_t rowCount, size_t columnCount, std::uint32_t blockSize, InitFunc initFunc = InitFunc)
-      : ownData_(rowCount * columnCount, MatrixSettings::Zero<ElementType>())
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+   using IElementaryOperations = typename Matrix<ElementType>::IElementaryOperations;
+   using IInPlaceOperations = typename Matrix<ElementType>::IInPlaceOperations;
+
+   // blockSize == 0 means "select the block size automatically" (see AutoBlockSize()).
+   // Elements are allocated by the resource (nullptr means MemorySettings::DefaultResource()).
+   BlockMatrix(size_t rowCount, size_t columnCount, std::uint32_t blockSize, InitFunc initFunc = InitFunc(), MemoryResource* resource = nullptr)
+      : ownData_(std::make_shared<MatrixBuffer<ElementType>>(rowCount * columnCount, MatrixSettings::Zero<ElementType>(), resource))
       , rowCount_(rowCount)
       , columnCount_(columnCount)
-      , blockSize_(blockSize == 0 ? 1 : blockSize)
+      , blockSize_(blockSize == 0 ? AutoBlockSize() : blockSize)
    {
-      assert(blockSize != 0);
       if (initFunc)
       {
          init(initFunc);
       }
    }
-   BlockMatrix(const Matrix<ElementType>& sourceMatrix, std::uint32_t blockSize)
-      : ownData_(sourceMatrix.RowCount() * sourceMatrix.ColumnCount())
+   BlockMatrix(const Matrix<ElementType>& sourceMatrix, std::uint32_t blockSize, MemoryResource* resource = nullptr)
+      : ownData_(std::make_shared<MatrixBuffer<ElementType>>(sourceMatrix.RowCount() * sourceMatrix.ColumnCount(), resource))
       , rowCount_(sourceMatrix.RowCount())
       , columnCount_(sourceMatrix.ColumnCount())
-      , blockSize_(blockSize == 0 ? 1 : blockSize)
+      , blockSize_(blockSize == 0 ? AutoBlockSize() : blockSize)
    {
-      assert(blockSize != 0);
-      auto initFunc = [&sourceMatrix](size_t row, size_t column)->ElementType { return sourceMatrix.Element(row, column); };
-      init(initFunc);
+      copyBlocks(sourceMatrix);
    }
+   // The copy shares elements, they are copied on the first change of one of the matrices (copy-on-write)
    explicit BlockMatrix(const BlockMatrix<ElementType>& sourceMatrix)
-      : ownData_(sourceMatrix.rowCount_ * sourceMatrix.columnCount_)
+      : ownData_(sourceMatrix.ownData_)
       , rowCount_(sourceMatrix.rowCount_)
       , columnCount_(sourceMatrix.columnCount_)
-      , blockSize_(sourceMatrix.blockSize_ == 0 ? 1 : sourceMatrix.blockSize_)
-      , data_(sourceMatrix.data_)
+      , blockSize_(sourceMatrix.blockSize_)
+   {
+   }
+
+   // Size of the cache (in bytes) which has to hold the blocks that are involved in one block multiplication
+   static size_t CacheSize()
+   {
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+      const long cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+      if (cacheSize > 0)
+      {
+         return static_cast<size_t>(cacheSize);
+      }
+#endif
+      return 256 * 1024;
+   }
+   // The largest block size (a multiple of the GEMM register tile width) such that three blocks fit into the cache
+   static std::uint32_t AutoBlockSize()
    {
-      assert(sourceMatrix.blockSize_ != 0);
+      const size_t step = Kernels::GemmBlocking<ElementType>::NR;
+      const size_t blockSize = static_cast<size_t>(std::sqrt(static_cast<double>(CacheSize()) / (3.0 * sizeof(ElementType))));
+      return static_cast<std::uint32_t>(std::max(step, blockSize / step * step));
    }
 
    static OperationResult Add(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
@@ -65,12 +100,15 @@ public:
       {
          return result;
       }
-      const BlockMatrix<ElementType>& blockMatrix1 = dynamic_cast<const BlockMatrix<ElementType>&>(matrix1);
-      const BlockMatrix<ElementType>& blockMatrix2 = dynamic_cast<const BlockMatrix<ElementType>&>(matrix2);
-      if ( (blockMatrix1 != nullptr) && (blockMatrix2 != nullptr) && (blockMatrix1.blockSize_ == blockMatrix2.blockSize_) )
+      const BlockMatrix<ElementType>* blockMatrix1 = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix1);
+      const BlockMatrix<ElementType>* blockMatrix2 = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix2);
+      if ( (blockMatrix1 != nullptr) && (blockMatrix2 != nullptr) && (blockMatrix1->blockSize_ == blockMatrix2->blockSize_) )
       {
-         result.Matrix_ = std::make_shared<BlockMatrix<ElementType>>(matrix1.RowCount(), matrix1.ColumnCount(), blockSize_);
-         std::transform(blockMatrix1.ownData_.begin(), blockMatrix1.ownData_.end(), blockMatrix2.ownData_.begin(), result.Matrix_->ownData_.begin(), std::plus<ElementType>());
+         // Both matrices have the same layout, so their buffers are added together element by element
+         auto sum = std::make_shared<BlockMatrix<ElementType>>(matrix1.RowCount(), matrix1.ColumnCount(), static_cast<std::uint32_t>(blockMatrix1->blockSize_));
+         const ElementType* data1 = blockMatrix1->ownData_->Data();
+         std::transform(data1, data1 + blockMatrix1->ownData_->Size(), blockMatrix2->ownData_->Data(), sum->ownData_->Data(), std::plus<ElementType>());
+         result.Matrix_ = sum;
          result.Code_ = OperationResultCode::Ok;
       }
       else
@@ -79,7 +117,7 @@ public:
       }
       return result;
    }
-   
+
    static OperationResult Multiply(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix)
    {
       OperationResult result;
@@ -88,11 +126,11 @@ public:
       {
          return result;
       }
-      const BlockMatrix<ElementType>& blockMatrix1 = dynamic_cast<const BlockMatrix<ElementType>&>(matrix1);
-      const BlockMatrix<ElementType>& blockMatrix2 = dynamic_cast<const BlockMatrix<ElementType>&>(matrix2);
-      if ((blockMatrix1 != nullptr) && (blockMatrix2 != nullptr) && (blockMatrix1.blockSize_ == blockMatrix2.blockSize_))
+      const BlockMatrix<ElementType>* blockMatrix1 = dynamic_cast<const BlockMatrix<ElementType>*>(&leftMatrix);
+      const BlockMatrix<ElementType>* blockMatrix2 = dynamic_cast<const BlockMatrix<ElementType>*>(&rightMatrix);
+      if ((blockMatrix1 != nullptr) && (blockMatrix2 != nullptr) && (blockMatrix1->blockSize_ == blockMatrix2->blockSize_))
       {
-         result.Matrix_ = multiply(blockMatrix1, blockMatrix2);
+         result.Matrix_ = multiply(*blockMatrix1, *blockMatrix2);
          result.Code_ = (result.Matrix_ == nullptr) ? OperationResultCode::Error : OperationResultCode::Ok;
       }
       else
@@ -107,7 +145,28 @@ public:
    virtual size_t ColumnCount() const override { return columnCount_; }
    virtual ElementType Element(size_t row, size_t column) const override { return element(row, column); }
    virtual std::string TypeName() const { return "BlockMatrix"; }
-   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Quadratic; }
+   // Rows are contiguous only if there is one block column
+   virtual const ElementType* RowData(size_t row) const override { return (blockColumnCount() == 1) ? rowSegment(row, 0) : nullptr; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         // The row is copied segment by segment, every segment is a part of the block row
+         size_t tileColumn = 0;
+         while (tileColumn < columnCount)
+         {
+            const size_t currentColumn = column + tileColumn;
+            const size_t blockColumnIndex = currentColumn / blockSize_;
+            const size_t offset = currentColumn % blockSize_;
+            const size_t length = std::min(blockWidth(blockColumnIndex) - offset, columnCount - tileColumn);
+            const ElementType* segment = rowSegment(row + tileRow, blockColumnIndex) + offset;
+            std::copy(segment, segment + length, &buffer[tileRow * stride + tileColumn]);
+            tileColumn += length;
+         }
+      }
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
    virtual OperationResult Copy() const override { return copy(); }
    virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override { return Complexity::Quadratic; }
    virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override { return Add(*this, otherMatrix); }
@@ -116,57 +175,90 @@ public:
    virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override { return Complexity::Cubic; }
    virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override{ return anotherMatrixIsOnTheLeft ? Multiply(anotherMatrix, *this) : Multiply(*this, anotherMatrix); }
    virtual Complexity::Type InversionComplexity() const override { return Complexity::Cubic; }
-   virtual OperationResult Invert() const override { return Algorithms::GaussJordanEliminationBlock<ElementType>(*this, createIdentityMatrix); }
+   virtual OperationResult Invert() const override { return invert(); }
    virtual Complexity::Type TransposeComplexity() const override { return Complexity::Quadratic; }
    virtual OperationResult Transpose() const override { return transpose(); }
    virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Cubic; }
-   virtual ScalarOperationResult Determinant() const override { return Algorithms::CalcDeterminant_GaussJordanEliminationBlock<ElementType>(*this); }
+   virtual ScalarOperationResult Determinant() const override { return determinant(); }
    virtual IElementaryOperations* ElementaryOperations() { return this; }
+   // Matrix::IElementaryOperations
+   virtual bool SwapRows(size_t rowIndex1, size_t rowIndex2) { return swap(rowIndex1, rowIndex2); }
+   virtual bool MultiplyRowByNumber(size_t rowIndex, ElementType number) { return multiplyByNumber(rowIndex, number); }
+   virtual bool MultiplyAndSubtract(size_t rowIndex1, size_t rowIndex2, ElementType number) { return multiplyAndSubtract(rowIndex1, rowIndex2, number); }
+   virtual IInPlaceOperations* InPlaceOperations() override { return this; }
+   // Matrix::IInPlaceOperations
+   virtual OperationResult AddInPlace(const Matrix<ElementType>& matrix) override { return addInPlace(matrix); }
+   virtual OperationResult ScaleInPlace(const ElementType& number) override { return scaleInPlace(number); }
+   virtual OperationResult CopyFrom(const Matrix<ElementType>& matrix) override { return copyFrom(matrix); }
+   virtual OperationResult AddInto(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2) override { return addInto(matrix1, matrix2); }
+   virtual OperationResult MultiplyInto(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, const ElementType& alpha, const ElementType& beta) override { return multiplyInto(leftMatrix, rightMatrix, alpha, beta); }
+   virtual OperationResult TransposeInto(const Matrix<ElementType>& matrix) override { return transposeInto(matrix); }
+   virtual OperationResult InvertInto(const Matrix<ElementType>& matrix) override { return invertInto(matrix); }
 
-private:
-   using Block = std::shared_ptr<StandardMatrix<ElementType>>;
+   // Block parameters
+   size_t BlockSize() const { return blockSize_; }
 
 private:
-   std::vector<ElementType> ownData_;
+   std::shared_ptr<MatrixBuffer<ElementType>> ownData_;  // Shared with copies until one of them is changed
    const size_t rowCount_;
    const size_t columnCount_;
-   const std::uint64_t blockSize_;   
+   const size_t blockSize_;
 
-   void init(InitFunc initFunc)
+   // Copy-on-write: the matrix gets its own storage before it is changed. Elements are copied into it if keepElements
+   // is true (an operation which overwrites all elements doesn't need them).
+   void detach(bool keepElements = true)
    {
-      const size_t blockRowCount = (rowCount_ + blockSize_ - 1) / blockSize_;
-      const size_t blockColumnCount = (columnCount_ + blockSize_ - 1) / blockSize_;
-      for (size_t blockRowIndex = 0; blockRowIndex < blockRowCount; ++blockRowIndex)
+      if (ownData_.use_count() == 1)
       {
-         auto& blockRow = blocks_[blockRowIndex];
-         blockRow.resize(blockColumnCount);
-         for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount; ++blockColumnIndex)
+         // use_count() is a relaxed read: the fence orders the writes after the release of the storage by the copy
+         // which has been destroyed in another thread
+         std::atomic_thread_fence(std::memory_order_acquire);
+         return;
+      }
+      ownData_ = keepElements ? std::make_shared<MatrixBuffer<ElementType>>(*ownData_) : std::make_shared<MatrixBuffer<ElementType>>(ownData_->Size(), ownData_->Resource());
+   }
+
+   size_t blockRowCount() const { return (rowCount_ + blockSize_ - 1) / blockSize_; }
+   size_t blockColumnCount() const { return (columnCount_ + blockSize_ - 1) / blockSize_; }
+   // The number of rows in blocks of the block row
+   size_t blockHeight(size_t blockRowIndex) const { return std::min(blockSize_, rowCount_ - blockRowIndex * blockSize_); }
+   // The number of columns in blocks of the block column
+   size_t blockWidth(size_t blockColumnIndex) const { return std::min(blockSize_, columnCount_ - blockColumnIndex * blockSize_); }
+   // Position of the first element of the block in ownData_
+   size_t blockStart(size_t blockRowIndex, size_t blockColumnIndex) const
+   {
+      return blockRowIndex * blockSize_ * columnCount_ + blockHeight(blockRowIndex) * blockColumnIndex * blockSize_;
+   }
+   const ElementType* block(size_t blockRowIndex, size_t blockColumnIndex) const { return ownData_->Data() + blockStart(blockRowIndex, blockColumnIndex); }
+   ElementType* block(size_t blockRowIndex, size_t blockColumnIndex) { return ownData_->Data() + blockStart(blockRowIndex, blockColumnIndex); }
+   // The part of the row which is stored in the block column
+   const ElementType* rowSegment(size_t row, size_t blockColumnIndex) const { return block(row / blockSize_, blockColumnIndex) + (row % blockSize_) * blockWidth(blockColumnIndex); }
+   ElementType* rowSegment(size_t row, size_t blockColumnIndex) { return block(row / blockSize_, blockColumnIndex) + (row % blockSize_) * blockWidth(blockColumnIndex); }
+
+   void init(const InitFunc& initFunc)
+   {
+      for (size_t blockRowIndex = 0; blockRowIndex < blockRowCount(); ++blockRowIndex)
+      {
+         const size_t height = blockHeight(blockRowIndex);
+         for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
          {
-            const size_t blockWidth = ((blockRowIndex < blockRowCount - 1) || (rowCount_ % blockSize_ == 0)) ? blockSize_ : (rowCount_ % blockSize_);
-            const size_t blockHeight = ((blockColumnIndex < blockColumnCount - 1) || (columnCount_ % blockSize_ == 0)) ? blockSize_ : (columnCount_ % blockSize_);
-            auto blockInit = [=](size_t blockColumn, size_t blockRow) -> ElementType
+            const size_t width = blockWidth(blockColumnIndex);
+            ElementType* data = block(blockRowIndex, blockColumnIndex);
+            for (size_t blockRow = 0; blockRow < height; ++blockRow)
             {
-               size_t matrixColumn = 0;
-               size_t matrixRow = 0;
-               convertBlockCoordinatesToMatrixCoordinates(blockColumnIndex, blockRowIndex, blockColumn, blockRow, matrixColumn, matrixRow);
-               return initFunc(matrixRow, matrixColumn);
-            };
-            const size_t blockRowStart = blockRowIndex * blockSize_ * columnCount_;
-            const size_t blockStart = blockRowStart + blockColumnIndex * blockSize_ * blockSize_;
-            StandardMatrix<ElementItem>(blockHeight, blockWidth, ownData_[blockStart], blockInit);
+               for (size_t blockColumn = 0; blockColumn < width; ++blockColumn)
+               {
+                  data[blockRow * width + blockColumn] = initFunc(blockRowIndex * blockSize_ + blockRow, blockColumnIndex * blockSize_ + blockColumn);
+               }
+            }
          }
       }
    }
 
    ElementType element(size_t row, size_t column) const
    {
-      const size_t blockRowCount = (rowCount_ + blockSize_ - 1) / blockSize_;
-      const size_t blockRowIndex = row / blockSize_;
       const size_t blockColumnIndex = column / blockSize_;
-      const size_t blockWidth = ((blockRowIndex < blockRowCount - 1) || (rowCount_ % blockSize_ == 0)) ? blockSize_ : (rowCount_ % blockSize_);
-      const size_t blockRowStart = blockRowIndex * blockSize_ * columnCount_;
-      const size_t blockStart = blockRowStart + blockColumnIndex * blockSize_ * blockSize_;
-      return ownData_[blockStart + (row % blockSize_) * blockWidth + column % blockSize_];
+      return block(row / blockSize_, blockColumnIndex)[(row % blockSize_) * blockWidth(blockColumnIndex) + column % blockSize_];
    }
 
    OperationResult copy() const
@@ -178,72 +270,533 @@ private:
    }
 
    OperationResult multiplyByNumber(const ElementType& number) const
-   { 
+   {
       OperationResult result;
-      result.Matrix_ = std::make_shared<BlockMatrix<ElementType>>(*this);
-      auto& data = result.Matrix_->data_;
-      std::transform(data.begin(), data.end(), data.begin(), [number](ElementType& value)->ElementType { return value * number; });
-      result.Code_ = OperationResultCode::Ok;
+      auto product = std::make_shared<BlockMatrix<ElementType>>(*this);
+      result = product->scaleInPlace(number);
+      result.Matrix_ = product;
       return result;
    }
 
-   static typename BlockMatrix<ElementType>::SharedPtr multiply(const BlockMatrix<ElementType>& m1, const BlockMatrix<ElementType>& m2)
+   // Tile-by-tile GEMM: the product is computed by multiplyBlocks()
+   static typename Matrix<ElementType>::SharedPtr multiply(const BlockMatrix<ElementType>& m1, const BlockMatrix<ElementType>& m2)
    {
       if (m1.blockSize_ != m2.blockSize_)
       {
          return nullptr;
       }
-      BlockMatrix<ElementType>::SharedPtr result(std::make_shared<BlockMatrix<ElementType>>(m1.RowCount(), m2.ColumnCount(), m1.blockSize_));
-
-      const size_t blockRowCount1 = (m1.RowCount() + blockSize_ - 1) / blockSize_;
-      const size_t blockColumnCount1 = (m1.ColumnCount() + blockSize_ - 1) / blockSize_;
-      const size_t blockRowCount2 = (m2.RowCount() + blockSize_ - 1) / blockSize_;
-      const size_t blockColumnCount2 = (m2.ColumnCount() + blockSize_ - 1) / blockSize_;
+      auto result = std::make_shared<BlockMatrix<ElementType>>(m1.RowCount(), m2.ColumnCount(), static_cast<std::uint32_t>(m1.blockSize_));
+      result->multiplyBlocks(m1, m2, MatrixSettings::One<ElementType>(), MatrixSettings::Zero<ElementType>());
+      return result;
+   }
 
-      for (size_t blockColumnIndexResult = 0; blockColumnIndexResult < blockColumnCount2; ++blockColumnIndexResult) 
+   // This = alpha * m1 * m2 + beta * This for matrices of the same block size (the storage of the result mustn't be an operand).
+   // Every block of the result is accumulated from products of contiguous blocks of the operands.
+   // Blocks of the result are independent, so they are distributed between threads of the library pool.
+   void multiplyBlocks(const BlockMatrix<ElementType>& m1, const BlockMatrix<ElementType>& m2, const ElementType& alpha, const ElementType& beta)
+   {
+      const size_t resultBlockColumnCount = blockColumnCount();
+      // The inner size may be zero, then the result is only scaled by beta (by one GEMM call with the empty inner size)
+      const size_t innerBlockCount = std::max<size_t>(1, m1.blockColumnCount());
+      auto multiplyBlock = [&](size_t resultBlockIndex)
+      {
+         const size_t blockRowIndex = resultBlockIndex / resultBlockColumnCount;
+         const size_t blockColumnIndex = resultBlockIndex % resultBlockColumnCount;
+         const size_t height = blockHeight(blockRowIndex);
+         const size_t width = blockWidth(blockColumnIndex);
+         ElementType* resultBlock = block(blockRowIndex, blockColumnIndex);
+         for (size_t innerBlockIndex = 0; innerBlockIndex < innerBlockCount; ++innerBlockIndex)
+         {
+            const size_t innerSize = m1.blockWidth(innerBlockIndex);
+            Kernels::Gemm<ElementType>(height, width, innerSize,
+               alpha, m1.block(blockRowIndex, innerBlockIndex), innerSize, m2.block(innerBlockIndex, blockColumnIndex), width,
+               (innerBlockIndex == 0) ? beta : MatrixSettings::One<ElementType>(), resultBlock, width);
+         }
+      };
+      const size_t blockCount = blockRowCount() * resultBlockColumnCount;
+      if (static_cast<double>(m1.RowCount()) * m2.ColumnCount() * m1.ColumnCount() < static_cast<double>(ParallelSettings::MultiplyThreshold()))
       {
-         for (size_t blockRowIndexResult = 0; blockRowIndexResult < blockRowCount1; ++blockRowIndexResult)
+         for (size_t resultBlockIndex = 0; resultBlockIndex < blockCount; ++resultBlockIndex)
          {
-            const size_t blockWidth = ((blockRowIndexResult < blockRowCount1 - 1) || (m1.RowCount() % blockSize_ == 0)) ? blockSize_ : (m1.RowCount() % blockSize_);
-            const size_t blockHeight = ((blockColumnIndexResult < blockColumnCount2 - 1) || (m2.ColumnCount() % blockSize_ == 0)) ? blockSize_ : (m2.ColumnCount() % blockSize_);
-            auto& dataStart = ownData_[blockStart + (row % blockSize_) * blockWidth + column % blockSize_]
-            StandardMatrix<ElementType> resultBlock(blockHeight, blockWidth, );
+            multiplyBlock(resultBlockIndex);
+         }
+      }
+      else
+      {
+         ParallelSettings::Pool().ParallelFor(blockCount, multiplyBlock);
+      }
+   }
 
+   // The matrix itself if it has the same layout and isn't this matrix, otherwise its copy with the block size of this matrix
+   const BlockMatrix<ElementType>* sameLayoutOperand(const Matrix<ElementType>& matrix, std::unique_ptr<BlockMatrix<ElementType>>& copy) const
+   {
+      const BlockMatrix<ElementType>* blockMatrix = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix);
+      if ((blockMatrix != nullptr) && (blockMatrix != this) && (blockMatrix->blockSize_ == blockSize_))
+      {
+         return blockMatrix;
+      }
+      copy.reset(new BlockMatrix<ElementType>(matrix, static_cast<std::uint32_t>(blockSize_)));
+      return copy.get();
+   }
 
+   // Every block is copied from the source matrix as a tile
+   void copyBlocks(const Matrix<ElementType>& sourceMatrix)
+   {
+      for (size_t blockRowIndex = 0; blockRowIndex < blockRowCount(); ++blockRowIndex)
+      {
+         for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
+         {
+            const size_t width = blockWidth(blockColumnIndex);
+            sourceMatrix.CopyTile(blockRowIndex * blockSize_, blockColumnIndex * blockSize_, blockHeight(blockRowIndex), width, block(blockRowIndex, blockColumnIndex), width);
          }
       }
+   }
 
-      const size_t blockRowIndex = row / blockSize_;
-      const size_t blockColumnIndex = column / blockSize_;
-      const size_t blockWidth = ((blockRowIndex < blockRowCount - 1) || (rowCount_ % blockSize_ == 0)) ? blockSize_ : (rowCount_ % blockSize_);
-      const size_t blockRowStart = blockRowIndex * blockSize_ * columnCount_;
-      const size_t blockStart = blockRowStart + blockColumnIndex * blockSize_ * blockSize_;
+   OperationResult addInPlace(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, matrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      detach();
+      const BlockMatrix<ElementType>* blockMatrix = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix);
+      if ((blockMatrix != nullptr) && (blockMatrix->blockSize_ == blockSize_))
+      {
+         // Both matrices have the same layout, so their buffers are added together element by element
+         ElementType* data = ownData_->Data();
+         std::transform(data, data + ownData_->Size(), blockMatrix->ownData_->Data(), data, std::plus<ElementType>());
+         return result;
+      }
+      RowReader<ElementType> reader(matrix);
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         const ElementType* source = reader.Row(row);
+         for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
+         {
+            ElementType* segment = rowSegment(row, blockColumnIndex);
+            const ElementType* sourceSegment = &source[blockColumnIndex * blockSize_];
+            for (size_t column = 0; column < blockWidth(blockColumnIndex); ++column)
+            {
+               segment[column] += sourceSegment[column];
+            }
+         }
+      }
+      return result;
+   }
+
+   OperationResult scaleInPlace(const ElementType& number)
+   {
+      OperationResult result;
+      detach();
+      Kernels::ScaleRow(ownData_->Data(), number, ownData_->Size());
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+   OperationResult copyFrom(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      CheckIfCanHoldResult(*this, matrix.RowCount(), matrix.ColumnCount(), result.Code_, result.Description_);
+      if ((result.Code_ == OperationResultCode::Error) || (&matrix == this))
+      {
+         return result;
+      }
+      detach(false);
+      const BlockMatrix<ElementType>* blockMatrix = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix);
+      if ((blockMatrix != nullptr) && (blockMatrix->blockSize_ == blockSize_))
+      {
+         std::copy(blockMatrix->ownData_->Data(), blockMatrix->ownData_->Data() + ownData_->Size(), ownData_->Data());
+         return result;
+      }
+      copyBlocks(matrix);
+      return result;
+   }
+
+   OperationResult addInto(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(matrix1, matrix2, result.Code_, result.Description_);
+      if (result.Code_ != OperationResultCode::Error)
+      {
+         CheckIfCanHoldResult(*this, matrix1.RowCount(), matrix1.ColumnCount(), result.Code_, result.Description_);
+      }
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      // Addition is commutative, so the matrix itself is never overwritten before it is read
+      if (&matrix2 == this)
+      {
+         return addInPlace(matrix1);
+      }
+      copyFrom(matrix1);
+      return addInPlace(matrix2);
+   }
 
+   // Operands of other types (or block sizes) are converted into the layout of this matrix, then the tile-by-tile GEMM is used
+   OperationResult multiplyInto(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, const ElementType& alpha, const ElementType& beta)
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(leftMatrix, rightMatrix, result.Code_, result.Description_);
+      if (result.Code_ != OperationResultCode::Error)
+      {
+         CheckIfCanHoldResult(*this, leftMatrix.RowCount(), rightMatrix.ColumnCount(), result.Code_, result.Description_);
+      }
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      leftMatrix.PrepareForReuse(rightMatrix.ColumnCount());
+      rightMatrix.PrepareForReuse(leftMatrix.RowCount());
+      std::unique_ptr<BlockMatrix<ElementType>> leftCopy;
+      std::unique_ptr<BlockMatrix<ElementType>> rightCopy;
+      const BlockMatrix<ElementType>* leftBlockMatrix = sameLayoutOperand(leftMatrix, leftCopy);
+      const BlockMatrix<ElementType>* rightBlockMatrix = sameLayoutOperand(rightMatrix, rightCopy);
+      // Operands don't share the storage of this matrix now, elements are needed only if they are scaled by beta
+      detach(beta != MatrixSettings::Zero<ElementType>());
+      multiplyBlocks(*leftBlockMatrix, *rightBlockMatrix, alpha, beta);
       return result;
    }
-   
+
    OperationResult transpose() const
    {
       OperationResult result;
-      auto initFunc = [this](size_t row, size_t column)->ElementType { return Element(column, row); };
-      result.Matrix_ = std::make_shared<BlockMatrix<ElementType>>(ColumnCount(), RowCount(), initFunc);
+      auto transposed = std::make_shared<BlockMatrix<ElementType>>(columnCount_, rowCount_, static_cast<std::uint32_t>(blockSize_));
+      result = transposed->transposeInto(*this);
+      result.Matrix_ = transposed;
+      return result;
+   }
+
+   OperationResult transposeInto(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      CheckIfCanHoldResult(*this, matrix.ColumnCount(), matrix.RowCount(), result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const BlockMatrix<ElementType>* blockMatrix = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix);
+      if ((blockMatrix != nullptr) && (blockMatrix->blockSize_ == blockSize_))
+      {
+         // Every block is transposed into the mirrored block of the result (the matrix itself is copied before)
+         std::unique_ptr<BlockMatrix<ElementType>> copy;
+         if (blockMatrix == this)
+         {
+            copy.reset(new BlockMatrix<ElementType>(*this));
+            blockMatrix = copy.get();
+         }
+         detach(false);
+         for (size_t blockRowIndex = 0; blockRowIndex < blockMatrix->blockRowCount(); ++blockRowIndex)
+         {
+            const size_t height = blockMatrix->blockHeight(blockRowIndex);
+            for (size_t blockColumnIndex = 0; blockColumnIndex < blockMatrix->blockColumnCount(); ++blockColumnIndex)
+            {
+               const size_t width = blockMatrix->blockWidth(blockColumnIndex);
+               Kernels::Transpose(height, width, blockMatrix->block(blockRowIndex, blockColumnIndex), width, block(blockColumnIndex, blockRowIndex), height);
+            }
+         }
+         return result;
+      }
+      // Other matrices are read by tiles which are mirrored blocks of the result
+      detach(false);
+      std::vector<ElementType> tile(blockSize_ * blockSize_);
+      for (size_t blockRowIndex = 0; blockRowIndex < blockRowCount(); ++blockRowIndex)
+      {
+         const size_t height = blockHeight(blockRowIndex);
+         for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
+         {
+            const size_t width = blockWidth(blockColumnIndex);
+            matrix.CopyTile(blockColumnIndex * blockSize_, blockRowIndex * blockSize_, width, height, tile.data(), height);
+            Kernels::Transpose(width, height, tile.data(), height, block(blockRowIndex, blockColumnIndex), width);
+         }
+      }
+      return result;
+   }
+
+   OperationResult invert() const
+   {
+      OperationResult result;
+      auto inverse = std::make_shared<BlockMatrix<ElementType>>(rowCount_, columnCount_, static_cast<std::uint32_t>(blockSize_));
+      result = inverse->invertInto(*this);
+      if (result.Code_ != OperationResultCode::Error)
+      {
+         result.Matrix_ = inverse;
+      }
+      return result;
+   }
+
+   // A^(-1) = U^(-1) * L^(-1) * P: the identity matrix with permuted rows is solved by L and U block by block
+   OperationResult invertInto(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      if (matrix.RowCount() != matrix.ColumnCount())
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Matrix can't be inverted: the number of rows (=" + std::to_string(matrix.RowCount()) + ") doesn't equal the number of columns (=" + std::to_string(matrix.ColumnCount()) + ")";
+         return result;
+      }
+      CheckIfCanHoldResult(*this, matrix.RowCount(), matrix.ColumnCount(), result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      // The factors are kept in a copy of the matrix, so the matrix may be inverted into itself
+      std::unique_ptr<BlockMatrix<ElementType>> factors;
+      const BlockMatrix<ElementType>* blockMatrix = dynamic_cast<const BlockMatrix<ElementType>*>(&matrix);
+      if ((blockMatrix != nullptr) && (blockMatrix->blockSize_ == blockSize_))
+      {
+         factors.reset(new BlockMatrix<ElementType>(*blockMatrix));
+      }
+      else
+      {
+         factors.reset(new BlockMatrix<ElementType>(matrix, static_cast<std::uint32_t>(blockSize_)));
+      }
+      std::vector<size_t> pivots;
+      ElementType sign = MatrixSettings::One<ElementType>();
+      if (!factors->factorizeLU(pivots, sign))
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Matrix can't be inverted: it is not invertible";
+         return result;
+      }
+
+      // P * I: row i has the one in the column permutation[i]
+      std::vector<size_t> permutation(rowCount_);
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         permutation[row] = row;
+      }
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         std::swap(permutation[row], permutation[pivots[row]]);
+      }
+      detach(false);
+      std::fill(ownData_->Data(), ownData_->Data() + ownData_->Size(), MatrixSettings::Zero<ElementType>());
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         rowSegment(row, permutation[row] / blockSize_)[permutation[row] % blockSize_] = MatrixSettings::One<ElementType>();
+      }
+
+      const size_t blockCount = blockRowCount();
+      // Forward substitution: X(k, J) = L(k, k)^(-1) * X(k, J), then it is eliminated from the block rows below
+      for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+      {
+         for (size_t blockColumnIndex = 0; blockColumnIndex < blockCount; ++blockColumnIndex)
+         {
+            solveUnitLower(factors->block(blockIndex, blockIndex), blockHeight(blockIndex), block(blockIndex, blockColumnIndex), blockWidth(blockColumnIndex));
+         }
+         subtractBlockProducts(*factors, blockIndex, blockIndex + 1, blockCount, 0);
+      }
+      // Backward substitution: X(k, J) = U(k, k)^(-1) * X(k, J), then it is eliminated from the block rows above
+      for (size_t blockIndex = blockCount; blockIndex-- > 0; )
+      {
+         for (size_t blockColumnIndex = 0; blockColumnIndex < blockCount; ++blockColumnIndex)
+         {
+            solveUpper(factors->block(blockIndex, blockIndex), blockHeight(blockIndex), block(blockIndex, blockColumnIndex), blockWidth(blockColumnIndex));
+         }
+         subtractBlockProducts(*factors, blockIndex, 0, blockIndex, 0);
+      }
+      return result;
+   }
+
+   ScalarOperationResult determinant() const
+   {
+      ScalarOperationResult result;
+      if (rowCount_ != columnCount_)
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Determinant can't be calculated: the number of rows (=" + std::to_string(rowCount_) + ") doesn't equal the number of columns (=" + std::to_string(columnCount_) + ")";
+         return result;
+      }
+      // det(A) = (-1)^(number of row swaps) * product of U diagonal
+      BlockMatrix<ElementType> factors(*this);
+      std::vector<size_t> pivots;
+      ElementType value = MatrixSettings::One<ElementType>();
+      if (factors.factorizeLU(pivots, value))
+      {
+         for (size_t i = 0; i < rowCount_; ++i)
+         {
+            value *= factors.element(i, i);
+         }
+      }
+      else
+      {
+         value = MatrixSettings::Zero<ElementType>();
+      }
+      result.Value_.reset(new ElementType(value));
       result.Code_ = OperationResultCode::Ok;
       return result;
    }
 
-   static Matrix<ElementType>::SharedPtr createIdentityMatrix(size_t size)
+   // LU decomposition with partial pivoting (P * A = L * U) of the square matrix on its own blocks: L (unit lower
+   // triangular) and U replace the elements. It is blocked and right-looking like Algorithms::LUDecomposition, but its
+   // panels are the block columns: the panel is factorized, the blocks of U to the right of it are solved and every
+   // trailing block is updated by one GEMM call on contiguous blocks.
+   // Row i has been swapped with row pivots[i] at step i, sign is multiplied by -1 for every swap. Returns false if a zero
+   // pivot is found (the matrix is singular), the elements are partially factorized then.
+   bool factorizeLU(std::vector<size_t>& pivots, ElementType& sign)
+   {
+      detach();
+      const size_t blockCount = blockRowCount();
+      pivots.resize(rowCount_);
+      for (size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+      {
+         const size_t panelStart = blockIndex * blockSize_;
+         const size_t panelWidth = blockWidth(blockIndex);
+         // Panel factorization (unblocked): the block column, rows [panelStart, rowCount_)
+         for (size_t j = 0; j < panelWidth; ++j)
+         {
+            const size_t column = panelStart + j;
+            size_t pivotRow = column;
+            ElementType pivotValue = absoluteValue(rowSegment(column, blockIndex)[j]);
+            for (size_t row = column + 1; row < rowCount_; ++row)
+            {
+               const ElementType value = absoluteValue(rowSegment(row, blockIndex)[j]);
+               if (value > pivotValue)
+               {
+                  pivotRow = row;
+                  pivotValue = value;
+               }
+            }
+            pivots[column] = pivotRow;
+            if (MatrixSettings::CanAssumeItIsZero<ElementType>(pivotValue))
+            {
+               return false;
+            }
+            if (pivotRow != column)
+            {
+               swap(column, pivotRow);
+               sign = -sign;
+            }
+            const ElementType* pivotSegment = rowSegment(column, blockIndex);
+            for (size_t row = column + 1; row < rowCount_; ++row)
+            {
+               ElementType* segment = rowSegment(row, blockIndex);
+               segment[j] /= pivotSegment[j];
+               if (j + 1 < panelWidth)
+               {
+                  Kernels::SubtractScaledRow(&segment[j + 1], &pivotSegment[j + 1], segment[j], panelWidth - j - 1);
+               }
+            }
+         }
+         // U(k, J) = L(k, k)^(-1) * A(k, J), then A(I, J) = A(I, J) - L(I, k) * U(k, J)
+         for (size_t blockColumnIndex = blockIndex + 1; blockColumnIndex < blockCount; ++blockColumnIndex)
+         {
+            solveUnitLower(block(blockIndex, blockIndex), panelWidth, block(blockIndex, blockColumnIndex), blockWidth(blockColumnIndex));
+         }
+         subtractBlockProducts(*this, blockIndex, blockIndex + 1, blockCount, blockIndex + 1);
+      }
+      return true;
+   }
+
+   // X(I, J) = X(I, J) - A(I, k) * X(k, J) for the block rows I from [blockRowBegin, blockRowEnd) and the block columns
+   // J from blockColumnBegin (X is this matrix, A has the same layout). Blocks are independent, so they are distributed
+   // between threads of the library pool.
+   void subtractBlockProducts(const BlockMatrix<ElementType>& a, size_t blockIndex, size_t blockRowBegin, size_t blockRowEnd, size_t blockColumnBegin)
    {
-      auto initFunc = [](size_t row, size_t column) -> ElementType
+      if (blockRowBegin >= blockRowEnd || blockColumnBegin >= blockColumnCount())
+      {
+         return;
+      }
+      const size_t updatedBlockColumnCount = blockColumnCount() - blockColumnBegin;
+      const size_t innerSize = a.blockWidth(blockIndex);
+      auto updateBlock = [&](size_t updatedBlockIndex)
       {
-         return (row == column) ? MatrixSettings::One<ElementType>() : MatrixSettings::Zero<ElementType>();
+         const size_t blockRowIndex = blockRowBegin + updatedBlockIndex / updatedBlockColumnCount;
+         const size_t blockColumnIndex = blockColumnBegin + updatedBlockIndex % updatedBlockColumnCount;
+         const size_t width = blockWidth(blockColumnIndex);
+         Kernels::Gemm<ElementType>(blockHeight(blockRowIndex), width, innerSize,
+            -MatrixSettings::One<ElementType>(), a.block(blockRowIndex, blockIndex), innerSize, block(blockIndex, blockColumnIndex), width,
+            MatrixSettings::One<ElementType>(), block(blockRowIndex, blockColumnIndex), width);
       };
-      return std::make_shared<BlockMatrix<ElementType>>(size, size, initFunc, blockSize_);
+      const size_t updatedBlockCount = (blockRowEnd - blockRowBegin) * updatedBlockColumnCount;
+      const double rowCount = static_cast<double>(std::min(rowCount_, blockRowEnd * blockSize_) - blockRowBegin * blockSize_);
+      const double columnCount = static_cast<double>(columnCount_ - blockColumnBegin * blockSize_);
+      if (rowCount * columnCount * innerSize < static_cast<double>(ParallelSettings::MultiplyThreshold()))
+      {
+         for (size_t updatedBlockIndex = 0; updatedBlockIndex < updatedBlockCount; ++updatedBlockIndex)
+         {
+            updateBlock(updatedBlockIndex);
+         }
+      }
+      else
+      {
+         ParallelSettings::Pool().ParallelFor(updatedBlockCount, updateBlock);
+      }
+   }
+
+   // B = L^(-1) * B: L is the unit lower triangle of the size x size block, B is a size x width block
+   static void solveUnitLower(const ElementType* l, size_t size, ElementType* b, size_t width)
+   {
+      for (size_t j = 0; j < size; ++j)
+      {
+         for (size_t i = j + 1; i < size; ++i)
+         {
+            Kernels::SubtractScaledRow(&b[i * width], &b[j * width], l[i * size + j], width);
+         }
+      }
+   }
+   // B = U^(-1) * B: U is the upper triangle of the size x size block, B is a size x width block
+   static void solveUpper(const ElementType* u, size_t size, ElementType* b, size_t width)
+   {
+      for (size_t j = size; j-- > 0; )
+      {
+         Kernels::ScaleRow(&b[j * width], MatrixSettings::One<ElementType>() / u[j * size + j], width);
+         for (size_t i = 0; i < j; ++i)
+         {
+            Kernels::SubtractScaledRow(&b[i * width], &b[j * width], u[i * size + j], width);
+         }
+      }
+   }
+
+   static ElementType absoluteValue(ElementType value) { return (value < MatrixSettings::Zero<ElementType>()) ? -value : value; }
+
+   bool swap(size_t rowIndex1, size_t rowIndex2)
+   {
+      if (rowIndex1 >= rowCount_ || rowIndex2 >= rowCount_)
+      {
+         return false;
+      }
+      if (rowIndex1 == rowIndex2)
+      {
+         return true;
+      }
+      detach();
+      for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
+      {
+         Kernels::SwapRows(rowSegment(rowIndex1, blockColumnIndex), rowSegment(rowIndex2, blockColumnIndex), blockWidth(blockColumnIndex));
+      }
+      return true;
    }
 
-   static void convertBlockCoordinatesToMatrixCoordinates(size_t blockColumnIndex, size_t blockRowIndex, size_t blockColumn, size_t blockRow, size_t& matrixColumn, size_t& matrixRow)
+   bool multiplyByNumber(size_t rowIndex, ElementType number)
    {
-      matrixColumn = blockColumnIndex * blockSize_ + blockColumn;
-      matrixRow = blockRowIndex * blockSize_ + blockRow;
+      if (rowIndex >= rowCount_)
+      {
+         return false;
+      }
+      detach();
+      for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
+      {
+         Kernels::ScaleRow(rowSegment(rowIndex, blockColumnIndex), number, blockWidth(blockColumnIndex));
+      }
+      return true;
+   }
+
+   bool multiplyAndSubtract(size_t rowIndex1, size_t rowIndex2, ElementType number)
+   {
+      if (rowIndex1 >= rowCount_ || rowIndex2 >= rowCount_)
+      {
+         return false;
+      }
+      detach();
+      for (size_t blockColumnIndex = 0; blockColumnIndex < blockColumnCount(); ++blockColumnIndex)
+      {
+         Kernels::SubtractScaledRow(rowSegment(rowIndex1, blockColumnIndex), rowSegment(rowIndex2, blockColumnIndex), number, blockWidth(blockColumnIndex));
+      }
+      return true;
    }
 };
 
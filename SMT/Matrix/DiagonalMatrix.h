@@ -0,0 +1,518 @@
+#ifndef __DIAGONAL_MATRIX_H__
+#define __DIAGONAL_MATRIX_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Diagonal, scalar, identity and zero matrices
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixChecks.h"
+#include "MatrixOperations.h"
+#include "MatrixSimd.h"
+#include "StandardMatrix.h"
+
+namespace SMT
+{
+template <typename ElementType> class DiagonalMatrix;
+template <typename ElementType> class ScalarMatrix;
+template <typename ElementType> class IdentityMatrix;
+template <typename ElementType> class ZeroMatrix;
+
+namespace Details
+{
+// Matrices which keep their diagonal only (a square zero matrix is one of them too)
+template <typename ElementType>
+bool KeepsDiagonalOnly(const Matrix<ElementType>& matrix)
+{
+   return (dynamic_cast<const DiagonalMatrix<ElementType>*>(&matrix) != nullptr) || (dynamic_cast<const ScalarMatrix<ElementType>*>(&matrix) != nullptr)
+      || ((dynamic_cast<const ZeroMatrix<ElementType>*>(&matrix) != nullptr) && (matrix.RowCount() == matrix.ColumnCount()));
+}
+
+// Fills the tile of a matrix with the given diagonal (diagonal(index) is the element at (index, index))
+template <typename ElementType, typename DiagonalFunc>
+void CopyDiagonalTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride, const DiagonalFunc& diagonal)
+{
+   for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+   {
+      ElementType* destination = &buffer[tileRow * stride];
+      std::fill(destination, destination + columnCount, MatrixSettings::Zero<ElementType>());
+      const size_t index = row + tileRow;
+      if ((index >= column) && (index < column + columnCount))
+      {
+         destination[index - column] = diagonal(index);
+      }
+   }
+}
+
+// Standard matrix = matrix + diagonal
+template <typename ElementType, typename DiagonalFunc>
+typename Matrix<ElementType>::SharedPtr AddDiagonal(const Matrix<ElementType>& matrix, const DiagonalFunc& diagonal)
+{
+   auto sum = std::make_shared<StandardMatrix<ElementType>>(matrix);
+   ElementType* data = sum->Data();
+   const size_t size = matrix.RowCount();
+   for (size_t index = 0; index < size; ++index)
+   {
+      data[index * size + index] += diagonal(index);
+   }
+   return sum;
+}
+
+// Standard matrix = diagonal * matrix (rows of the matrix are scaled) or matrix * diagonal (columns are scaled)
+template <typename ElementType, typename DiagonalFunc>
+typename Matrix<ElementType>::SharedPtr MultiplyByDiagonal(const Matrix<ElementType>& matrix, const DiagonalFunc& diagonal, bool diagonalIsOnTheLeft)
+{
+   auto product = std::make_shared<StandardMatrix<ElementType>>(matrix);
+   ElementType* data = product->Data();
+   const size_t rowCount = matrix.RowCount();
+   const size_t columnCount = matrix.ColumnCount();
+   for (size_t row = 0; row < rowCount; ++row)
+   {
+      ElementType* rowData = &data[row * columnCount];
+      if (diagonalIsOnTheLeft)
+      {
+         Kernels::ScaleRow(rowData, diagonal(row), columnCount);
+         continue;
+      }
+      for (size_t column = 0; column < columnCount; ++column)
+      {
+         rowData[column] *= diagonal(column);
+      }
+   }
+   return product;
+}
+
+// The result of an operation which is a copy or a multiple of its operand (see Copy() and MultiplyByNumber()):
+// the description of the copying is dropped, so the caller describes the operation
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult OperandResult(typename Matrix<ElementType>::OperationResult result)
+{
+   if (result.Code_ == OperationResultCode::Ok)
+   {
+      result.Description_.clear();
+   }
+   return result;
+}
+} // namespace Details
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Diagonal matrix.
+// It represents as a vector of diagonal elements (O(N) memory), other elements are zeros.
+// Operations with matrices which keep their diagonal only (diagonal, scalar, identity and square zero ones) give
+// diagonal matrices in O(N), operations with other matrices give standard ones (rows or columns are scaled).
+// The matrix is immutable, so copies share the diagonal.
+template <typename ElementType>
+class DiagonalMatrix : public Matrix<ElementType>
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+
+   // The size of the matrix is the number of diagonal elements
+   explicit DiagonalMatrix(std::vector<ElementType> diagonal)
+      : diagonal_(std::make_shared<const std::vector<ElementType>>(std::move(diagonal)))
+   {
+   }
+
+   // Diagonal elements (RowCount() elements)
+   const ElementType* Diagonal() const { return diagonal_->data(); }
+
+   // Matrix
+   virtual size_t RowCount() const override { return diagonal_->size(); }
+   virtual size_t ColumnCount() const override { return diagonal_->size(); }
+   virtual ElementType Element(size_t row, size_t column) const override { return (row == column) ? (*diagonal_)[row] : MatrixSettings::Zero<ElementType>(); }
+   virtual std::string TypeName() const { return "DiagonalMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      Details::CopyDiagonalTile(row, column, rowCount, columnCount, buffer, stride, [this](size_t index) { return (*diagonal_)[index]; });
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<DiagonalMatrix<ElementType>>(*this);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override { return Details::KeepsDiagonalOnly(otherMatrix) ? Complexity::Linear : Complexity::Quadratic; }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      if (Details::KeepsDiagonalOnly(otherMatrix))
+      {
+         result.Matrix_ = combine(otherMatrix, [](const ElementType& element1, const ElementType& element2) { return element1 + element2; });
+         return result;
+      }
+      result.Matrix_ = Details::AddDiagonal(otherMatrix, [this](size_t index) { return (*diagonal_)[index]; });
+      return result;
+   }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Linear; }
+   virtual OperationResult MultiplyByNumber(const ElementType& number) const override
+   {
+      OperationResult result;
+      std::vector<ElementType> diagonal(*diagonal_);
+      Kernels::ScaleRow(diagonal.data(), number, diagonal.size());
+      result.Matrix_ = std::make_shared<DiagonalMatrix<ElementType>>(std::move(diagonal));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool /*anotherMatrixIsOnTheLeft*/) const override { return Details::KeepsDiagonalOnly(anotherMatrix) ? Complexity::Linear : Complexity::Quadratic; }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(anotherMatrixIsOnTheLeft ? anotherMatrix : *this, anotherMatrixIsOnTheLeft ? *this : anotherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      if (Details::KeepsDiagonalOnly(anotherMatrix))
+      {
+         result.Matrix_ = combine(anotherMatrix, [](const ElementType& element1, const ElementType& element2) { return element1 * element2; });
+         return result;
+      }
+      result.Matrix_ = Details::MultiplyByDiagonal(anotherMatrix, [this](size_t index) { return (*diagonal_)[index]; }, !anotherMatrixIsOnTheLeft);
+      return result;
+   }
+   virtual Complexity::Type InversionComplexity() const override { return Complexity::Linear; }
+   virtual OperationResult Invert() const override
+   {
+      OperationResult result;
+      std::vector<ElementType> diagonal(diagonal_->size());
+      for (size_t index = 0; index < diagonal.size(); ++index)
+      {
+         if (MatrixSettings::CanAssumeItIsZero<ElementType>((*diagonal_)[index]))
+         {
+            result.Code_ = OperationResultCode::Error;
+            result.Description_ = "Matrix can't be inverted: it is not invertible";
+            return result;
+         }
+         diagonal[index] = MatrixSettings::One<ElementType>() / (*diagonal_)[index];
+      }
+      result.Matrix_ = std::make_shared<DiagonalMatrix<ElementType>>(std::move(diagonal));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The matrix is symmetric
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Transpose() const override { return Copy(); }
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Linear; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      ElementType determinant = MatrixSettings::One<ElementType>();
+      for (const ElementType& element : *diagonal_)
+      {
+         determinant *= element;
+      }
+      result.Value_.reset(new ElementType(determinant));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+private:
+   std::shared_ptr<const std::vector<ElementType>> diagonal_;   // Immutable, shared with copies
+
+   // Diagonal matrix = operation(this diagonal, diagonal of the matrix) for a matrix which keeps its diagonal only
+   template <typename Operation>
+   typename Matrix<ElementType>::SharedPtr combine(const Matrix<ElementType>& matrix, const Operation& operation) const
+   {
+      std::vector<ElementType> diagonal(diagonal_->size());
+      for (size_t index = 0; index < diagonal.size(); ++index)
+      {
+         diagonal[index] = operation((*diagonal_)[index], matrix.Element(index, index));
+      }
+      return std::make_shared<DiagonalMatrix<ElementType>>(std::move(diagonal));
+   }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar matrix.
+// It is a diagonal matrix whose diagonal elements equal one number (O(1) memory), so it multiplies other matrices
+// by the number: the product is MultiplyByNumber() of another matrix.
+template <typename ElementType>
+class ScalarMatrix : public Matrix<ElementType>
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+
+   ScalarMatrix(size_t size, const ElementType& value)
+      : size_(size)
+      , value_(value)
+   {
+   }
+
+   // The diagonal element
+   const ElementType& Value() const { return value_; }
+
+   // Matrix
+   virtual size_t RowCount() const override { return size_; }
+   virtual size_t ColumnCount() const override { return size_; }
+   virtual ElementType Element(size_t row, size_t column) const override { return (row == column) ? value_ : MatrixSettings::Zero<ElementType>(); }
+   virtual std::string TypeName() const { return "ScalarMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      Details::CopyDiagonalTile(row, column, rowCount, columnCount, buffer, stride, [this](size_t) { return value_; });
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<ScalarMatrix<ElementType>>(size_, value_);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // A sum with a scalar matrix is a scalar matrix, a sum with another diagonal one is diagonal
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override
+   {
+      if (dynamic_cast<const ScalarMatrix<ElementType>*>(&otherMatrix) != nullptr)
+      {
+         return Complexity::Constant;
+      }
+      return Details::KeepsDiagonalOnly(otherMatrix) ? Complexity::Linear : Complexity::Quadratic;
+   }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const ScalarMatrix<ElementType>* scalarMatrix = dynamic_cast<const ScalarMatrix<ElementType>*>(&otherMatrix);
+      if (scalarMatrix != nullptr)
+      {
+         result.Matrix_ = std::make_shared<ScalarMatrix<ElementType>>(size_, value_ + scalarMatrix->value_);
+         return result;
+      }
+      if (Details::KeepsDiagonalOnly(otherMatrix))
+      {
+         std::vector<ElementType> diagonal(size_);
+         for (size_t index = 0; index < size_; ++index)
+         {
+            diagonal[index] = value_ + otherMatrix.Element(index, index);
+         }
+         result.Matrix_ = std::make_shared<DiagonalMatrix<ElementType>>(std::move(diagonal));
+         return result;
+      }
+      result.Matrix_ = Details::AddDiagonal(otherMatrix, [this](size_t) { return value_; });
+      return result;
+   }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult MultiplyByNumber(const ElementType& number) const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<ScalarMatrix<ElementType>>(size_, value_ * number);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // It is the complexity of the multiplication of another matrix by the number (the standard one if it isn't implemented)
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool /*anotherMatrixIsOnTheLeft*/) const override { return std::min<Complexity::Type>(anotherMatrix.MultiplyByNumberComplexity(), Complexity::Quadratic); }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(anotherMatrixIsOnTheLeft ? anotherMatrix : *this, anotherMatrixIsOnTheLeft ? *this : anotherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      return Details::OperandResult<ElementType>(SMT::MultiplyByNumber(anotherMatrix, value_));
+   }
+   virtual Complexity::Type InversionComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Invert() const override
+   {
+      OperationResult result;
+      if (MatrixSettings::CanAssumeItIsZero<ElementType>(value_))
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Matrix can't be inverted: it is not invertible";
+         return result;
+      }
+      result.Matrix_ = std::make_shared<ScalarMatrix<ElementType>>(size_, MatrixSettings::One<ElementType>() / value_);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Transpose() const override { return Copy(); }
+   // The power is calculated by repeated squaring
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Logarithmic; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      ElementType determinant = MatrixSettings::One<ElementType>();
+      ElementType power = value_;
+      for (size_t exponent = size_; exponent != 0; exponent /= 2)
+      {
+         if ((exponent % 2) != 0)
+         {
+            determinant *= power;
+         }
+         power *= power;
+      }
+      result.Value_.reset(new ElementType(determinant));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+private:
+   size_t size_;
+   ElementType value_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Identity matrix.
+// A product with it is a copy of another matrix, so it costs CopyingComplexity() of another matrix.
+template <typename ElementType>
+class IdentityMatrix : public ScalarMatrix<ElementType>
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+
+   explicit IdentityMatrix(size_t size)
+      : ScalarMatrix<ElementType>(size, MatrixSettings::One<ElementType>())
+   {
+   }
+
+   // Matrix
+   virtual std::string TypeName() const { return "IdentityMatrix"; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<IdentityMatrix<ElementType>>(this->RowCount());
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool /*anotherMatrixIsOnTheLeft*/) const override { return std::min<Complexity::Type>(anotherMatrix.CopyingComplexity(), Complexity::Quadratic); }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(anotherMatrixIsOnTheLeft ? anotherMatrix : *this, anotherMatrixIsOnTheLeft ? *this : anotherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      return Details::OperandResult<ElementType>(SMT::Copy(anotherMatrix));
+   }
+   virtual OperationResult Invert() const override { return Copy(); }
+   virtual OperationResult Transpose() const override { return Copy(); }
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Constant; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      result.Value_.reset(new ElementType(MatrixSettings::One<ElementType>()));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Zero matrix.
+// It keeps its size only. A sum with it is a copy of another matrix (so it costs CopyingComplexity() of another
+// matrix), a product with it is a zero matrix.
+template <typename ElementType>
+class ZeroMatrix : public Matrix<ElementType>
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+
+   ZeroMatrix(size_t rowCount, size_t columnCount)
+      : rowCount_(rowCount)
+      , columnCount_(columnCount)
+   {
+   }
+
+   // Matrix
+   virtual size_t RowCount() const override { return rowCount_; }
+   virtual size_t ColumnCount() const override { return columnCount_; }
+   virtual ElementType Element(size_t /*row*/, size_t /*column*/) const override { return MatrixSettings::Zero<ElementType>(); }
+   virtual std::string TypeName() const { return "ZeroMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   virtual void CopyTile(size_t /*row*/, size_t /*column*/, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         std::fill(&buffer[tileRow * stride], &buffer[tileRow * stride] + columnCount, MatrixSettings::Zero<ElementType>());
+      }
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override { return create(rowCount_, columnCount_); }
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override { return std::min<Complexity::Type>(otherMatrix.CopyingComplexity(), Complexity::Quadratic); }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      return Details::OperandResult<ElementType>(SMT::Copy(otherMatrix));
+   }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult MultiplyByNumber(const ElementType& /*number*/) const override { return Copy(); }
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& /*anotherMatrix*/, bool /*anotherMatrixIsOnTheLeft*/) const override { return Complexity::Constant; }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override
+   {
+      OperationResult result;
+      const Matrix<ElementType>& leftMatrix = anotherMatrixIsOnTheLeft ? anotherMatrix : *this;
+      const Matrix<ElementType>& rightMatrix = anotherMatrixIsOnTheLeft ? *this : anotherMatrix;
+      CheckIfCanMultiplyTogether(leftMatrix, rightMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      return create(leftMatrix.RowCount(), rightMatrix.ColumnCount());
+   }
+   virtual Complexity::Type InversionComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Invert() const override
+   {
+      OperationResult result;
+      result.Code_ = OperationResultCode::Error;
+      result.Description_ = "Matrix can't be inverted: it is not invertible";
+      return result;
+   }
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Transpose() const override { return create(columnCount_, rowCount_); }
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Constant; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      if (rowCount_ != columnCount_)
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Determinant can't be calculated: the number of rows (=" + std::to_string(rowCount_) + ") doesn't equal the number of columns (=" + std::to_string(columnCount_) + ")";
+         return result;
+      }
+      result.Value_.reset(new ElementType(MatrixSettings::Zero<ElementType>()));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+private:
+   size_t rowCount_;
+   size_t columnCount_;
+
+   static OperationResult create(size_t rowCount, size_t columnCount)
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<ZeroMatrix<ElementType>>(rowCount, columnCount);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+};
+
+} // namespace SMT
+
+#endif // __DIAGONAL_MATRIX_H__
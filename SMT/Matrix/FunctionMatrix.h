@@ -5,40 +5,290 @@
 // Function matrix
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "MatrixCache.h"
 #include "MatrixDefs.h"
 #include "MatrixOperations.h"
+#include "StandardMatrix.h"
+#include "../Threading/ThreadPool.h"
 
 namespace SMT
 {
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Function matrices of all function types implement it, so they can be combined with each other at run time
+template <typename ElementType>
+struct IFunctionMatrix
+{
+   using ElementFunc = std::function<ElementType (size_t /*row*/, size_t /*column*/)>;
+   // Fills the tile [row, row + rowCount) x [column, column + columnCount) into buffer row by row (stride is the distance
+   // between rows in buffer). A batch generator lets the compiler vectorize a formula along rows.
+   using TileFunc = std::function<void (size_t /*row*/, size_t /*column*/, size_t /*rowCount*/, size_t /*columnCount*/, ElementType* /*buffer*/, size_t /*stride*/)>;
+   virtual ~IFunctionMatrix() {}
+   // The function of the matrix (type-erased). It is immutable and shared with the matrix.
+   virtual std::shared_ptr<const ElementFunc> ElementFunction() const = 0;
+   // The batch generator of the matrix (nullptr if the matrix has no batch generator)
+   virtual std::shared_ptr<const TileFunc> TileFunction() const = 0;
+   // Threads of the library pool may call the functions to fill large tiles (see FunctionMatrix::SetParallelFill())
+   virtual bool ParallelFill() const = 0;
+};
+
+namespace Details
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compositions of element functions.
+// They keep the composed functions by value, so a chain of compositions is one type and its calls are inlined.
+template <typename ElementType, typename Fn>
+struct ScaledFunction
+{
+   Fn Func_;
+   ElementType Number_;
+   ElementType operator()(size_t row, size_t column) const { return Func_(row, column) * Number_; }
+};
+template <typename ElementType, typename Fn>
+struct TransposedFunction
+{
+   Fn Func_;
+   ElementType operator()(size_t row, size_t column) const { return Func_(column, row); }
+};
+template <typename ElementType, typename Fn1, typename Fn2>
+struct SumFunction
+{
+   Fn1 Func1_;
+   Fn2 Func2_;
+   ElementType operator()(size_t row, size_t column) const { return Func1_(row, column) + Func2_(row, column); }
+};
+
+// A function which is shared by matrices. Results of Matrix operations refer to the (immutable) functions of their
+// operands instead of copying them: a result doesn't depend on the lifetime of the operands and copies no captures.
+template <typename ElementType, typename Fn>
+struct SharedFunction
+{
+   std::shared_ptr<const Fn> Func_;
+   ElementType operator()(size_t row, size_t column) const { return (*Func_)(row, column); }
+};
+
+// Type-erased compositions (the results of Matrix operations). A transposed type-erased function is unwrapped. A scaled
+// one is wrapped once more: (f * a) * b is rounded twice like the elements of a stored matrix scaled twice, and f * (a * b)
+// may differ from it in the last bit.
+template <typename ElementType>
+using SharedElementFunc = std::shared_ptr<const std::function<ElementType (size_t, size_t)>>;
+
+template <typename ElementType, typename Fn>
+SharedElementFunc<ElementType> EraseFunction(const std::shared_ptr<const Fn>& func)
+{
+   return std::make_shared<const std::function<ElementType (size_t, size_t)>>(SharedFunction<ElementType, Fn>{ func });
+}
+template <typename ElementType>
+SharedElementFunc<ElementType> EraseFunction(const SharedElementFunc<ElementType>& func)
+{
+   return func;
+}
+template <typename ElementType, typename Fn>
+SharedElementFunc<ElementType> ScaleFunction(const std::shared_ptr<const Fn>& func, const ElementType& number)
+{
+   return std::make_shared<const std::function<ElementType (size_t, size_t)>>(ScaledFunction<ElementType, SharedFunction<ElementType, Fn>>{ { func }, number });
+}
+template <typename ElementType>
+SharedElementFunc<ElementType> ScaleFunction(const SharedElementFunc<ElementType>& func, const ElementType& number)
+{
+   using ScaledSharedFunction = ScaledFunction<ElementType, SharedFunction<ElementType, std::function<ElementType (size_t, size_t)>>>;
+   return std::make_shared<const std::function<ElementType (size_t, size_t)>>(ScaledSharedFunction{ { func }, number });
+}
+template <typename ElementType, typename Fn>
+SharedElementFunc<ElementType> TransposeFunction(const std::shared_ptr<const Fn>& func)
+{
+   return std::make_shared<const std::function<ElementType (size_t, size_t)>>(TransposedFunction<ElementType, SharedFunction<ElementType, Fn>>{ { func } });
+}
+template <typename ElementType>
+SharedElementFunc<ElementType> TransposeFunction(const SharedElementFunc<ElementType>& func)
+{
+   using TransposedSharedFunction = TransposedFunction<ElementType, SharedFunction<ElementType, std::function<ElementType (size_t, size_t)>>>;
+   const TransposedSharedFunction* transposed = func->template target<TransposedSharedFunction>();
+   return (transposed != nullptr) ? transposed->Func_.Func_ : std::make_shared<const std::function<ElementType (size_t, size_t)>>(TransposedSharedFunction{ { func } });
+}
+
+// Adapter of a batch generator to the element function (a 1 x 1 tile)
+template <typename ElementType>
+struct TileElementFunction
+{
+   typename IFunctionMatrix<ElementType>::TileFunc TileFunc_;
+   ElementType operator()(size_t row, size_t column) const
+   {
+      ElementType element;
+      TileFunc_(row, column, 1, 1, &element, 1);
+      return element;
+   }
+};
+// Adapter of a shared element function to the batch generator
+template <typename ElementType, typename Fn>
+struct ElementTileFunction
+{
+   std::shared_ptr<const Fn> Func_;
+   void operator()(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      const Fn& func = *Func_;
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         for (size_t tileColumn = 0; tileColumn < columnCount; ++tileColumn)
+         {
+            destination[tileColumn] = func(row + tileRow, column + tileColumn);
+         }
+      }
+   }
+};
+
+// Batch compositions (results of Matrix operations on matrices with batch generators): whole tiles are processed
+template <typename ElementType>
+struct ScaledTileFunction
+{
+   std::shared_ptr<const typename IFunctionMatrix<ElementType>::TileFunc> Func_;
+   ElementType Number_;
+   void operator()(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      (*Func_)(row, column, rowCount, columnCount, buffer, stride);
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         Kernels::ScaleRow(&buffer[tileRow * stride], Number_, columnCount);
+      }
+   }
+};
+template <typename ElementType>
+struct TransposedTileFunction
+{
+   std::shared_ptr<const typename IFunctionMatrix<ElementType>::TileFunc> Func_;
+   void operator()(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      std::vector<ElementType> tile(rowCount * columnCount);
+      (*Func_)(column, row, columnCount, rowCount, tile.data(), rowCount);
+      Kernels::Transpose(columnCount, rowCount, tile.data(), rowCount, buffer, stride);
+   }
+};
+template <typename ElementType>
+struct SumTileFunction
+{
+   std::shared_ptr<const typename IFunctionMatrix<ElementType>::TileFunc> Func1_;
+   std::shared_ptr<const typename IFunctionMatrix<ElementType>::TileFunc> Func2_;
+   void operator()(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      (*Func1_)(row, column, rowCount, columnCount, buffer, stride);
+      std::vector<ElementType> tile(rowCount * columnCount);
+      (*Func2_)(row, column, rowCount, columnCount, tile.data(), columnCount);
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         const ElementType* source = &tile[tileRow * columnCount];
+         for (size_t tileColumn = 0; tileColumn < columnCount; ++tileColumn)
+         {
+            destination[tileColumn] += source[tileColumn];
+         }
+      }
+   }
+};
+
+// Only a type-erased function can be empty
+template <typename ElementType>
+void SetZeroFunctionIfEmpty(std::function<ElementType (size_t, size_t)>& func)
+{
+   if (!func)
+   {
+      const ElementType retValue = MatrixSettings::Zero<ElementType>();
+      func = [retValue](size_t /*row*/, size_t /*column*/)->ElementType { return retValue; };
+   }
+}
+template <typename Fn>
+void SetZeroFunctionIfEmpty(Fn& /*func*/)
+{
+}
+} // namespace Details
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Function matrix.
 // It represents as a function.
-template <typename ElementType>
-class FunctionMatrix : public Matrix<ElementType>
+// Fn is the type of the function. FunctionMatrix<ElementType> keeps a type-erased function (std::function), it is the
+// type which crosses the runtime boundary (results of Matrix operations). Matrices with their own function types (see
+// MakeFunctionMatrix()) are composed at compile time by Scaled(), Transposed() and Plus(): elements of the result are
+// computed by inlined calls instead of a chain of indirect ones.
+// An optional batch generator fills whole tiles for bulk access (see MakeBatchFunctionMatrix()), it is kept by results of
+// Add(), MultiplyByNumber() and Transpose().
+// Computed elements can be kept by the tile cache (it is off by default, see CachePolicy) if the function is expensive.
+// Functions are immutable and shared (by copies and by results of operations), so a result of an operation stays valid
+// when its operands are destroyed. Elements can be computed from many threads at once if the functions allow it, large
+// tiles are filled in parallel only if the matrix allows it (see SetParallelFill()).
+template <typename ElementType, typename Fn = std::function<ElementType (size_t /*row*/, size_t /*column*/)>>
+class FunctionMatrix 
+   : public Matrix<ElementType>
+   , public IFunctionMatrix<ElementType>
 {
 public:
-   using ElementFunc = std::function<ElementType (size_t /*column*/, size_t /*row*/)>; // A function which defines this matrix
-   FunctionMatrix(size_t rowCount, size_t columnCount, const ElementFunc& elementFunc = ElementFunc())
+   using ElementFunc = std::function<ElementType (size_t /*row*/, size_t /*column*/)>; // A type-erased function which defines a matrix
+   using Function = Fn;                         // The function which defines this matrix
+   using TileFunc = typename IFunctionMatrix<ElementType>::TileFunc;
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   // Caching of computed elements
+   struct CachePolicy
+   {
+      size_t ByteBudget_ = 0;                   // Memory for computed elements (0 - caching is off)
+      size_t TileSize_ = 64;                    // Elements are computed and kept by TileSize_ x TileSize_ tiles
+      size_t MaterializeReuseCount_ = 0;        // The whole matrix is computed and kept (if it fits into the budget) when a reader reuses every element at least this number of times, e.g. a product (0 - never)
+   };
+
+   // The functions are called only by threads which read the matrix, unless SetParallelFill() allows the library pool to
+   // call them.
+   FunctionMatrix(size_t rowCount, size_t columnCount, const Fn& elementFunc = Fn())
       : rowCount_(rowCount)
       , columnCount_(columnCount)
-      , func_(elementFunc)
+      , func_(makeFunction(elementFunc))
+   {
+   }
+   // The batch generator fills tiles (bulk access: copying, conversion, multiplication), the element function is used by
+   // Element(). They have to define the same matrix.
+   FunctionMatrix(size_t rowCount, size_t columnCount, const Fn& elementFunc, const TileFunc& tileFunc)
+      : rowCount_(rowCount)
+      , columnCount_(columnCount)
+      , func_(makeFunction(elementFunc))
+      , tileFunc_(tileFunc ? std::make_shared<const TileFunc>(tileFunc) : nullptr)
    {
-      setZeroFuncIfEmpy();
    }
-   FunctionMatrix(const FunctionMatrix<ElementType>& sourceMatrix)
+   // The copy shares the functions and the cache of the source matrix
+   FunctionMatrix(const FunctionMatrix<ElementType, Fn>& sourceMatrix)
       : rowCount_(sourceMatrix.rowCount_)
       , columnCount_(sourceMatrix.columnCount_)
       , func_(sourceMatrix.func_)
+      , tileFunc_(sourceMatrix.tileFunc_)
+      , cachePolicy_(sourceMatrix.cachePolicy_)
+      , cache_(sourceMatrix.cache_)
+      , parallelFill_(sourceMatrix.parallelFill_)
    {
-      assert(func_);
-      setZeroFuncIfEmpy();
    }
 
    // Matrix
    virtual size_t RowCount() const override { return rowCount_; }
    virtual size_t ColumnCount() const override { return columnCount_; }
-   virtual ElementType Element(size_t row, size_t column) const override { return func_(row, column); }
+   virtual ElementType Element(size_t row, size_t column) const override { return cache_ ? cache_->Element(row, column, computeFunc()) : (*func_)(row, column); }
    virtual std::string TypeName() const { return "FunctionMatrix"; }
+   // Rows exist only if the matrix is materialized by the cache
+   virtual const ElementType* RowData(size_t row) const override
+   {
+      const ElementType* data = cache_ ? cache_->Data() : nullptr;
+      return (data != nullptr) ? &data[row * columnCount_] : nullptr;
+   }
+   // The batch generator fills the tile or the function is called directly for every element (no virtual call per element)
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      if (cache_)
+      {
+         cache_->CopyTile(row, column, rowCount, columnCount, buffer, stride, computeFunc());
+         return;
+      }
+      compute(row, column, rowCount, columnCount, buffer, stride);
+   }
+   virtual void PrepareForReuse(size_t reuseCount) const override
+   {
+      if (cache_ && (cachePolicy_.MaterializeReuseCount_ != 0) && (reuseCount >= cachePolicy_.MaterializeReuseCount_))
+      {
+         cache_->Materialize(computeFunc());
+      }
+   }
    virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
    virtual OperationResult Copy() const override { return copy(); }
    virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override { return additionComplexity(otherMatrix); }
@@ -47,28 +297,138 @@ public:
    virtual OperationResult MultiplyByNumber(const ElementType& number) const override{ return multiplyByNumber(number); }
    virtual Complexity::Type TransposeComplexity() const override { return Complexity::Constant; }
    virtual OperationResult Transpose() const override{ return transpose(); }
+   // IFunctionMatrix
+   virtual std::shared_ptr<const ElementFunc> ElementFunction() const override { return Details::EraseFunction<ElementType>(func_); }
+   virtual std::shared_ptr<const TileFunc> TileFunction() const override { return tileFunc_; }
+   virtual bool ParallelFill() const override { return parallelFill_; }
+
+   const Fn& GetFunction() const { return *func_; }
+
+   // -- Compile-time composition (the results don't inherit the cache policy and the batch generator)
+   FunctionMatrix<ElementType, Details::ScaledFunction<ElementType, Fn>> Scaled(const ElementType& number) const
+   {
+      FunctionMatrix<ElementType, Details::ScaledFunction<ElementType, Fn>> result(rowCount_, columnCount_, Details::ScaledFunction<ElementType, Fn>{ *func_, number });
+      result.parallelFill_ = parallelFill_;
+      return result;
+   }
+   FunctionMatrix<ElementType, Details::TransposedFunction<ElementType, Fn>> Transposed() const
+   {
+      FunctionMatrix<ElementType, Details::TransposedFunction<ElementType, Fn>> result(columnCount_, rowCount_, Details::TransposedFunction<ElementType, Fn>{ *func_ });
+      result.parallelFill_ = parallelFill_;
+      return result;
+   }
+   // The sizes of matrices have to be equal
+   template <typename OtherFn>
+   FunctionMatrix<ElementType, Details::SumFunction<ElementType, Fn, OtherFn>> Plus(const FunctionMatrix<ElementType, OtherFn>& otherMatrix) const
+   {
+      assert((rowCount_ == otherMatrix.RowCount()) && (columnCount_ == otherMatrix.ColumnCount()));
+      FunctionMatrix<ElementType, Details::SumFunction<ElementType, Fn, OtherFn>> result(rowCount_, columnCount_, Details::SumFunction<ElementType, Fn, OtherFn>{ *func_, otherMatrix.GetFunction() });
+      result.parallelFill_ = parallelFill_ && otherMatrix.ParallelFill();
+      return result;
+   }
+
+   // Turns the cache on or off (kept elements are dropped). It has to be set before the matrix is shared between threads.
+   // Results of operations (e.g. MultiplyByNumber()) don't inherit the policy.
+   void SetCachePolicy(const CachePolicy& policy)
+   {
+      cachePolicy_ = policy;
+      cache_.reset((policy.ByteBudget_ != 0) ? new TileCache<ElementType>(rowCount_, columnCount_, policy.TileSize_, policy.ByteBudget_) : nullptr);
+   }
+   const CachePolicy& GetCachePolicy() const { return cachePolicy_; }
+   // Lets threads of the library pool fill tiles of ParallelSettings::FillThreshold() elements or more, so the functions
+   // have to be thread-safe then. It is off by default. Copies keep it, results of operations keep it if all their
+   // operands allow it.
+   void SetParallelFill(bool parallelFill) { parallelFill_ = parallelFill; }
+   // nullptr if caching is off
+   std::shared_ptr<const TileCache<ElementType>> Cache() const { return cache_; }
 
 private:
+   template <typename, typename> friend class FunctionMatrix;
+   using SharedTileFunc = std::shared_ptr<const TileFunc>;
+
    const size_t rowCount_;
    const size_t columnCount_;
-   ElementFunc func_;
+   std::shared_ptr<const Fn> func_;
+   SharedTileFunc tileFunc_;                    // Optional batch generator
+   CachePolicy cachePolicy_;
+   std::shared_ptr<TileCache<ElementType>> cache_;
+   bool parallelFill_ = false;                  // See SetParallelFill()
+
+   // A result of an operation which shares the functions of its operands
+   FunctionMatrix(size_t rowCount, size_t columnCount, const std::shared_ptr<const Fn>& elementFunc, const SharedTileFunc& tileFunc, bool parallelFill)
+      : rowCount_(rowCount)
+      , columnCount_(columnCount)
+      , func_(elementFunc)
+      , tileFunc_(tileFunc)
+      , parallelFill_(parallelFill)
+   {
+   }
+
+   static std::shared_ptr<const Fn> makeFunction(const Fn& elementFunc)
+   {
+      Fn func = elementFunc;
+      Details::SetZeroFunctionIfEmpty(func);
+      return std::make_shared<const Fn>(std::move(func));
+   }
+
+   // Elements are independent, so large tiles are filled by panels of rows in parallel if the matrix allows it
+   void compute(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      if (parallelFill_ && (rowCount > 1) && (rowCount * columnCount >= ParallelSettings::FillThreshold()) && (ParallelSettings::ThreadCount() > 1))
+      {
+         const size_t threadCount = ParallelSettings::ThreadCount();
+         const size_t panelHeight = (rowCount + 4 * threadCount - 1) / (4 * threadCount);
+         const size_t panelCount = (rowCount + panelHeight - 1) / panelHeight;
+         ParallelSettings::Pool().ParallelFor(panelCount, [&](size_t panel)
+         {
+            const size_t firstRow = panel * panelHeight;
+            computeSerially(row + firstRow, column, std::min(panelHeight, rowCount - firstRow), columnCount, &buffer[firstRow * stride], stride);
+         });
+         return;
+      }
+      computeSerially(row, column, rowCount, columnCount, buffer, stride);
+   }
+   void computeSerially(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      if (tileFunc_)
+      {
+         (*tileFunc_)(row, column, rowCount, columnCount, buffer, stride);
+         return;
+      }
+      const Fn& func = *func_;
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         for (size_t tileColumn = 0; tileColumn < columnCount; ++tileColumn)
+         {
+            destination[tileColumn] = func(row + tileRow, column + tileColumn);
+         }
+      }
+   }
+   // The cache calls it only during the call which gets it, so the shared cache never refers to this matrix later
+   typename TileCache<ElementType>::ComputeFunc computeFunc() const
+   {
+      return [this](size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) { compute(row, column, rowCount, columnCount, buffer, stride); };
+   }
 
    OperationResult copy() const
    {
       OperationResult result;
-      result.Matrix_ = std::make_shared<FunctionMatrix<ElementType>>(*this);
+      result.Matrix_ = std::make_shared<FunctionMatrix<ElementType, Fn>>(*this);
       result.Code_ = OperationResultCode::Ok;
       return result;
    }
 
    Complexity::Type additionComplexity(const Matrix<ElementType>& otherMatrix) const
    {
-      return (dynamic_cast<const FunctionMatrix<ElementType>*>(&otherMatrix) != nullptr) ? Complexity::Constant : Complexity::Quadratic;
+      return (dynamic_cast<const IFunctionMatrix<ElementType>*>(&otherMatrix) != nullptr) ? Complexity::Constant : Complexity::Quadratic;
    }
 
+   // A matrix of the same function type is added without type erasure of its function.
+   // Results don't copy the functions of the operands, they share them.
    OperationResult add(const Matrix<ElementType>& otherMatrix) const
    {
-      const FunctionMatrix<ElementType>* otherFuncMatrix = dynamic_cast<const FunctionMatrix<ElementType>*>(&otherMatrix);
+      const IFunctionMatrix<ElementType>* otherFuncMatrix = dynamic_cast<const IFunctionMatrix<ElementType>*>(&otherMatrix);
       if (otherFuncMatrix != nullptr)
       {
          OperationResult result;
@@ -77,13 +437,19 @@ private:
          {
             return result;
          }
-         auto func1 = func_;
-         auto func2 = otherFuncMatrix->func_;
-         auto newFunc = [func1, func2](size_t column, size_t row)->ElementType
+         const FunctionMatrix<ElementType, Fn>* sameTypeMatrix = dynamic_cast<const FunctionMatrix<ElementType, Fn>*>(&otherMatrix);
+         const std::shared_ptr<const ElementFunc> newFunc = (sameTypeMatrix != nullptr)
+            ? std::make_shared<const ElementFunc>(Details::SumFunction<ElementType, Details::SharedFunction<ElementType, Fn>, Details::SharedFunction<ElementType, Fn>>{ { func_ }, { sameTypeMatrix->func_ } })
+            : std::make_shared<const ElementFunc>(Details::SumFunction<ElementType, Details::SharedFunction<ElementType, Fn>, Details::SharedFunction<ElementType, ElementFunc>>{ { func_ }, { otherFuncMatrix->ElementFunction() } });
+         // The sum has a batch generator if any of the matrices has it
+         const SharedTileFunc otherTileFunc = otherFuncMatrix->TileFunction();
+         SharedTileFunc newTileFunc;
+         if (tileFunc_ || otherTileFunc)
          {
-            return func1(column, row) + func2(column, row);
-         };
-         result.Matrix_ = std::make_shared<FunctionMatrix<ElementType>>(rowCount_, columnCount_, newFunc);
+            const SharedTileFunc secondTileFunc = otherTileFunc ? otherTileFunc : std::make_shared<const TileFunc>(Details::ElementTileFunction<ElementType, ElementFunc>{ otherFuncMatrix->ElementFunction() });
+            newTileFunc = std::make_shared<const TileFunc>(Details::SumTileFunction<ElementType>{ tileFunction(), secondTileFunc });
+         }
+         result.Matrix_ = std::shared_ptr<FunctionMatrix<ElementType>>(new FunctionMatrix<ElementType>(rowCount_, columnCount_, newFunc, newTileFunc, parallelFill_ && otherFuncMatrix->ParallelFill()));
          return result;
       }
       return StandardMatrix<ElementType>::Add(*this, otherMatrix);
@@ -92,8 +458,8 @@ private:
    OperationResult multiplyByNumber(const ElementType& number) const
    { 
       OperationResult result;
-      auto func = [this, number](size_t row, size_t column)->ElementType { return func_(row, column) * number; };
-      result.Matrix_ = std::make_shared<FunctionMatrix<ElementType>>(RowCount(), ColumnCount(), func);
+      const SharedTileFunc tileFunc = tileFunc_ ? std::make_shared<const TileFunc>(Details::ScaledTileFunction<ElementType>{ tileFunc_, number }) : nullptr;
+      result.Matrix_ = std::shared_ptr<FunctionMatrix<ElementType>>(new FunctionMatrix<ElementType>(RowCount(), ColumnCount(), Details::ScaleFunction(func_, number), tileFunc, parallelFill_));
       result.Code_ = OperationResultCode::Ok;
       return result;
    }
@@ -106,21 +472,29 @@ private:
    OperationResult transpose() const
    {
       OperationResult result;
-      auto func = [this](size_t row, size_t column)->ElementType { return func_(column, row); };
-      result.Matrix_ = std::make_shared<FunctionMatrix<ElementType>>(ColumnCount(), RowCount(), func);
+      const SharedTileFunc tileFunc = tileFunc_ ? std::make_shared<const TileFunc>(Details::TransposedTileFunction<ElementType>{ tileFunc_ }) : nullptr;
+      result.Matrix_ = std::shared_ptr<FunctionMatrix<ElementType>>(new FunctionMatrix<ElementType>(ColumnCount(), RowCount(), Details::TransposeFunction<ElementType>(func_), tileFunc, parallelFill_));
       result.Code_ = OperationResultCode::Ok;
       return result;
    }
 
-   void setZeroFuncIfEmpy()
-   {
-      if (!func_) {
-         const ElementType retValue = MatrixSettings::Zero<ElementType>();
-         func_ = [retValue](size_t /*row*/, size_t /*column*/)->ElementType { return retValue; };
-      }
-   }
+   SharedTileFunc tileFunction() const { return tileFunc_ ? tileFunc_ : std::make_shared<const TileFunc>(Details::ElementTileFunction<ElementType, Fn>{ func_ }); }
 };
 
+// A function matrix of the own function type (e.g. a lambda) which can be composed at compile time
+template <typename ElementType, typename Fn>
+FunctionMatrix<ElementType, typename std::decay<Fn>::type> MakeFunctionMatrix(size_t rowCount, size_t columnCount, Fn&& func)
+{
+   return FunctionMatrix<ElementType, typename std::decay<Fn>::type>(rowCount, columnCount, std::forward<Fn>(func));
+}
+
+// A function matrix which is defined by a batch generator only (Element() computes a 1 x 1 tile)
+template <typename ElementType>
+FunctionMatrix<ElementType> MakeBatchFunctionMatrix(size_t rowCount, size_t columnCount, const typename IFunctionMatrix<ElementType>::TileFunc& tileFunc)
+{
+   return FunctionMatrix<ElementType>(rowCount, columnCount, Details::TileElementFunction<ElementType>{ tileFunc }, tileFunc);
+}
+
 } // namespace SMT
 
 #endif // __FUNCTION_MATRIX_H__
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef __MATRIX_ALGORITHMS_H__
 #define __MATRIX_ALGORITHMS_H__
 
+#include <cmath>
 #include <functional>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -8,7 +9,8 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "MatrixDefs.h"
-#include "MatrixOperations.h"
+#include "MatrixKernels.h"
+#include "MatrixSimd.h"
 
 namespace SMT
 {
@@ -19,7 +21,7 @@ namespace Algorithms
 template <typename ElementType>
 ElementType DistanceToOne(ElementType value)
 {
-   const ElementType absValue = std::abs<ElementType>(value);
+   const ElementType absValue = std::abs(value);
    const ElementType one = MatrixSettings::One<ElementType>();
    if (MatrixSettings::CanAssumeItIsZero<ElementType>(absValue - one))
    {
@@ -45,7 +47,7 @@ typename Matrix<ElementType>::OperationResult GaussJordanElimination(const Matri
    {
       return matrixCopyResult;
    }
-   Matrix<ElementType>::OperationResult result;
+   typename Matrix<ElementType>::OperationResult result;
    result.Code_ = matrixCopyResult.Code_;
    result.Description_ = matrixCopyResult.Description_;
    auto matrix = matrixCopyResult.Matrix_;
@@ -134,7 +136,7 @@ template <typename ElementType>
 typename Matrix<ElementType>::ScalarOperationResult CalcDeterminant_GaussJordanElimination(const Matrix<ElementType>& matrixConst)
 {
    auto matrixCopyResult = matrixConst.Copy();
-   Matrix<ElementType>::ScalarOperationResult result;
+   typename Matrix<ElementType>::ScalarOperationResult result;
    result.Code_ = matrixCopyResult.Code_;
    result.Description_ = matrixCopyResult.Description_;
    if (result.Code_ == OperationResultCode::Error || result.Code_ == OperationResultCode::NotImplemented)
@@ -209,6 +211,529 @@ typename Matrix<ElementType>::ScalarOperationResult CalcDeterminant_GaussJordanE
    return result;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LU decomposition with partial pivoting: P * A = L * U
+//    L is unit lower triangular, U is upper triangular. Both factors are kept in one row-major buffer.
+//    The factorization is blocked and right-looking: a narrow panel of columns is factorized, then the rows of U to the
+//    right of the panel are solved and the trailing matrix is updated by the (multithreaded) GEMM kernel.
+//    Factorization costs ~n^3/3 multiply-adds once; after that the determinant is O(n) and every solve is O(n^2) per
+//    right-hand side, so one object can be reused for the determinant, the inverse and any number of linear systems.
+template <typename ElementType>
+class LUDecomposition
+{
+public:
+   static const size_t DefaultBlockSize = 64;
+
+   // Factorizes a square row-major matrix (ld is the distance between rows)
+   LUDecomposition(size_t size, const ElementType* data, size_t ld, size_t blockSize = DefaultBlockSize)
+      : size_(size)
+      , lu_(size * size)
+   {
+      for (size_t row = 0; row < size_; ++row)
+      {
+         std::copy(&data[row * ld], &data[row * ld] + size_, &lu_[row * size_]);
+      }
+      factorize(blockSize);
+   }
+   // Factorizes any square matrix (elements are copied by bulk access, see Matrix::CopyTo())
+   explicit LUDecomposition(const Matrix<ElementType>& matrix, size_t blockSize = DefaultBlockSize)
+      : size_(matrix.RowCount())
+   {
+      if (matrix.RowCount() != matrix.ColumnCount())
+      {
+         code_ = OperationResultCode::Error;
+         description_ = "Matrix can't be factorized: the number of rows (=" + std::to_string(matrix.RowCount()) + ") doesn't equal the number of columns (=" + std::to_string(matrix.ColumnCount()) + ")";
+         size_ = 0;
+         return;
+      }
+      lu_.resize(size_ * size_);
+      matrix.CopyTo(lu_.data(), size_);
+      factorize(blockSize);
+   }
+
+   // The result of the factorization. Error means that the matrix isn't square.
+   OperationResultCode Code() const { return code_; }
+   const std::string& Description() const { return description_; }
+   size_t Size() const { return size_; }
+   // A zero pivot has been found: the matrix is not invertible (its determinant is zero)
+   bool IsSingular() const { return singular_; }
+
+   // det(A) = (-1)^(number of row swaps) * product of U diagonal
+   ElementType Determinant() const
+   {
+      if (singular_)
+      {
+         return MatrixSettings::Zero<ElementType>();
+      }
+      ElementType result = sign_;
+      for (size_t i = 0; i < size_; ++i)
+      {
+         result *= lu_[i * size_ + i];
+      }
+      return result;
+   }
+
+   // Solves A * X = B. B is a row-major Size() x columnCount matrix (ldb is the distance between rows); it is replaced by X.
+   bool Solve(ElementType* b, size_t columnCount, size_t ldb) const
+   {
+      if (code_ == OperationResultCode::Error || singular_)
+      {
+         return false;
+      }
+      for (size_t i = 0; i < size_; ++i)
+      {
+         if (pivots_[i] != i)
+         {
+            Kernels::SwapRows(&b[i * ldb], &b[pivots_[i] * ldb], columnCount);
+         }
+      }
+      solveLower(b, columnCount, ldb);
+      solveUpper(b, columnCount, ldb);
+      return true;
+   }
+
+   // Writes A^(-1) into a row-major Size() x Size() buffer
+   bool Invert(ElementType* inverse, size_t ld) const
+   {
+      if (code_ == OperationResultCode::Error || singular_)
+      {
+         return false;
+      }
+      for (size_t row = 0; row < size_; ++row)
+      {
+         std::fill(&inverse[row * ld], &inverse[row * ld] + size_, MatrixSettings::Zero<ElementType>());
+         inverse[row * ld + row] = MatrixSettings::One<ElementType>();
+      }
+      return Solve(inverse, size_, ld);
+   }
+
+private:
+   size_t size_;
+   std::vector<ElementType> lu_;
+   std::vector<size_t> pivots_;                 // Row i has been swapped with row pivots_[i] at step i
+   ElementType sign_ = MatrixSettings::One<ElementType>();
+   bool singular_ = false;
+   OperationResultCode code_ = OperationResultCode::Ok;
+   std::string description_;
+
+   static ElementType absoluteValue(ElementType value) { return (value < MatrixSettings::Zero<ElementType>()) ? -value : value; }
+
+   void factorize(size_t blockSize)
+   {
+      const size_t n = size_;
+      const size_t nb = (blockSize == 0) ? DefaultBlockSize : blockSize;
+      ElementType* a = lu_.data();
+      pivots_.resize(n);
+      for (size_t k0 = 0; k0 < n; k0 += nb)
+      {
+         const size_t kb = std::min(nb, n - k0);
+         const size_t panelEnd = k0 + kb;
+         // Panel factorization (unblocked): columns [k0, panelEnd), rows [k0, n)
+         for (size_t j = k0; j < panelEnd; ++j)
+         {
+            size_t pivotRow = j;
+            ElementType pivotValue = absoluteValue(a[j * n + j]);
+            for (size_t i = j + 1; i < n; ++i)
+            {
+               const ElementType value = absoluteValue(a[i * n + j]);
+               if (value > pivotValue)
+               {
+                  pivotRow = i;
+                  pivotValue = value;
+               }
+            }
+            pivots_[j] = pivotRow;
+            if (MatrixSettings::CanAssumeItIsZero<ElementType>(pivotValue))
+            {
+               singular_ = true;
+               return;
+            }
+            if (pivotRow != j)
+            {
+               Kernels::SwapRows(&a[j * n], &a[pivotRow * n], n);
+               sign_ = -sign_;
+            }
+            const ElementType pivot = a[j * n + j];
+            for (size_t i = j + 1; i < n; ++i)
+            {
+               ElementType* row = &a[i * n];
+               row[j] /= pivot;
+               if (j + 1 < panelEnd)
+               {
+                  Kernels::SubtractScaledRow(&row[j + 1], &a[j * n + j + 1], row[j], panelEnd - j - 1);
+               }
+            }
+         }
+         if (panelEnd == n)
+         {
+            break;
+         }
+         // U12 = L11^(-1) * A12
+         for (size_t j = k0; j < panelEnd; ++j)
+         {
+            for (size_t i = j + 1; i < panelEnd; ++i)
+            {
+               Kernels::SubtractScaledRow(&a[i * n + panelEnd], &a[j * n + panelEnd], a[i * n + j], n - panelEnd);
+            }
+         }
+         // A22 = A22 - L21 * U12
+         Kernels::ParallelGemm<ElementType>(n - panelEnd, n - panelEnd, kb,
+            -MatrixSettings::One<ElementType>(), &a[panelEnd * n + k0], n, &a[k0 * n + panelEnd], n,
+            MatrixSettings::One<ElementType>(), &a[panelEnd * n + panelEnd], n);
+      }
+   }
+
+   // B = L^(-1) * B (forward substitution, blocked by DefaultBlockSize rows)
+   void solveLower(ElementType* b, size_t columnCount, size_t ldb) const
+   {
+      const size_t n = size_;
+      const ElementType* a = lu_.data();
+      for (size_t k0 = 0; k0 < n; k0 += DefaultBlockSize)
+      {
+         const size_t blockEnd = std::min(k0 + DefaultBlockSize, n);
+         for (size_t j = k0; j < blockEnd; ++j)
+         {
+            for (size_t i = j + 1; i < blockEnd; ++i)
+            {
+               Kernels::SubtractScaledRow(&b[i * ldb], &b[j * ldb], a[i * n + j], columnCount);
+            }
+         }
+         if (blockEnd < n)
+         {
+            Kernels::ParallelGemm<ElementType>(n - blockEnd, columnCount, blockEnd - k0,
+               -MatrixSettings::One<ElementType>(), &a[blockEnd * n + k0], n, &b[k0 * ldb], ldb,
+               MatrixSettings::One<ElementType>(), &b[blockEnd * ldb], ldb);
+         }
+      }
+   }
+
+   // B = U^(-1) * B (backward substitution, blocked by DefaultBlockSize rows)
+   void solveUpper(ElementType* b, size_t columnCount, size_t ldb) const
+   {
+      const size_t n = size_;
+      const ElementType* a = lu_.data();
+      for (size_t blockEnd = n; blockEnd > 0; )
+      {
+         const size_t k0 = (blockEnd > DefaultBlockSize) ? blockEnd - DefaultBlockSize : 0;
+         for (size_t j = blockEnd; j-- > k0; )
+         {
+            Kernels::ScaleRow(&b[j * ldb], MatrixSettings::One<ElementType>() / a[j * n + j], columnCount);
+            for (size_t i = k0; i < j; ++i)
+            {
+               Kernels::SubtractScaledRow(&b[i * ldb], &b[j * ldb], a[i * n + j], columnCount);
+            }
+         }
+         if (k0 > 0)
+         {
+            Kernels::ParallelGemm<ElementType>(k0, columnCount, blockEnd - k0,
+               -MatrixSettings::One<ElementType>(), &a[k0], n, &b[k0 * ldb], ldb,
+               MatrixSettings::One<ElementType>(), b, ldb);
+         }
+         blockEnd = k0;
+      }
+   }
+};
+template <typename ElementType> const size_t LUDecomposition<ElementType>::DefaultBlockSize;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LU decomposition of a band matrix with partial pivoting
+//    The band matrix has lowerBandwidth nonzero diagonals below the main one and upperBandwidth ones above it. Its
+//    rows are stored one after another, every row keeps lowerBandwidth + upperBandwidth + 1 elements: row i keeps the
+//    columns [i - lowerBandwidth, i + upperBandwidth] (positions outside the matrix are zeros).
+//    A pivot is chosen from the lowerBandwidth rows below the diagonal, so the upper bandwidth of U grows to
+//    lowerBandwidth + upperBandwidth at most: the factorization costs O(n * kl * (kl + ku)) and every solve costs
+//    O(n * (2 * kl + ku)) per right-hand side (instead of O(n^3) and O(n^2) for dense matrices).
+//    L is kept as the sequence of eliminations (multipliers aren't swapped by later pivots).
+template <typename ElementType>
+class BandedLUDecomposition
+{
+public:
+   BandedLUDecomposition(size_t size, size_t lowerBandwidth, size_t upperBandwidth, const ElementType* band)
+      : size_(size)
+      , lowerBandwidth_(lowerBandwidth)
+      , upperBandwidth_(lowerBandwidth + upperBandwidth)
+      , width_(lowerBandwidth_ + upperBandwidth_ + 1)
+      , lu_(size * width_, MatrixSettings::Zero<ElementType>())
+      , pivots_(size)
+   {
+      const size_t bandWidth = lowerBandwidth + upperBandwidth + 1;
+      for (size_t row = 0; row < size_; ++row)
+      {
+         std::copy(&band[row * bandWidth], &band[row * bandWidth] + bandWidth, &lu_[row * width_]);
+      }
+      factorize();
+   }
+
+   size_t Size() const { return size_; }
+   // A zero pivot has been found: the matrix is not invertible (its determinant is zero)
+   bool IsSingular() const { return singular_; }
+
+   // det(A) = (-1)^(number of row swaps) * product of U diagonal
+   ElementType Determinant() const
+   {
+      if (singular_)
+      {
+         return MatrixSettings::Zero<ElementType>();
+      }
+      ElementType result = sign_;
+      for (size_t i = 0; i < size_; ++i)
+      {
+         result *= at(i, i);
+      }
+      return result;
+   }
+
+   // Solves A * X = B. B is a row-major Size() x columnCount matrix (ldb is the distance between rows); it is replaced by X.
+   bool Solve(ElementType* b, size_t columnCount, size_t ldb) const
+   {
+      if (singular_)
+      {
+         return false;
+      }
+      const size_t n = size_;
+      for (size_t j = 0; j < n; ++j)
+      {
+         if (pivots_[j] != j)
+         {
+            Kernels::SwapRows(&b[j * ldb], &b[pivots_[j] * ldb], columnCount);
+         }
+         for (size_t i = j + 1; i < std::min(n, j + lowerBandwidth_ + 1); ++i)
+         {
+            Kernels::SubtractScaledRow(&b[i * ldb], &b[j * ldb], at(i, j), columnCount);
+         }
+      }
+      for (size_t j = n; j-- > 0; )
+      {
+         for (size_t column = j + 1; column < std::min(n, j + upperBandwidth_ + 1); ++column)
+         {
+            Kernels::SubtractScaledRow(&b[j * ldb], &b[column * ldb], at(j, column), columnCount);
+         }
+         Kernels::ScaleRow(&b[j * ldb], MatrixSettings::One<ElementType>() / at(j, j), columnCount);
+      }
+      return true;
+   }
+
+private:
+   size_t size_;
+   size_t lowerBandwidth_;
+   size_t upperBandwidth_;                      // Of U (including the fill-in of pivoting)
+   size_t width_;
+   std::vector<ElementType> lu_;                // Row i keeps the columns [i - lowerBandwidth_, i + upperBandwidth_]
+   std::vector<size_t> pivots_;                 // Row i has been swapped with row pivots_[i] at step i
+   ElementType sign_ = MatrixSettings::One<ElementType>();
+   bool singular_ = false;
+
+   static ElementType absoluteValue(ElementType value) { return (value < MatrixSettings::Zero<ElementType>()) ? -value : value; }
+
+   // The element (row, column); the column has to be inside the kept part of the row
+   ElementType& at(size_t row, size_t column) { return lu_[row * width_ + column + lowerBandwidth_ - row]; }
+   const ElementType& at(size_t row, size_t column) const { return lu_[row * width_ + column + lowerBandwidth_ - row]; }
+
+   void factorize()
+   {
+      const size_t n = size_;
+      for (size_t j = 0; j < n; ++j)
+      {
+         const size_t lastRow = std::min(n, j + lowerBandwidth_ + 1);
+         const size_t lastColumn = std::min(n, j + upperBandwidth_ + 1);
+         size_t pivotRow = j;
+         ElementType pivotValue = absoluteValue(at(j, j));
+         for (size_t i = j + 1; i < lastRow; ++i)
+         {
+            const ElementType value = absoluteValue(at(i, j));
+            if (value > pivotValue)
+            {
+               pivotRow = i;
+               pivotValue = value;
+            }
+         }
+         pivots_[j] = pivotRow;
+         if (MatrixSettings::CanAssumeItIsZero<ElementType>(pivotValue))
+         {
+            singular_ = true;
+            return;
+         }
+         // Rows keep their columns at different positions, so the pivot row is swapped element by element
+         if (pivotRow != j)
+         {
+            for (size_t column = j; column < lastColumn; ++column)
+            {
+               std::swap(at(j, column), at(pivotRow, column));
+            }
+            sign_ = -sign_;
+         }
+         const ElementType pivot = at(j, j);
+         for (size_t i = j + 1; i < lastRow; ++i)
+         {
+            ElementType& multiplier = at(i, j);
+            multiplier /= pivot;
+            if (j + 1 < lastColumn)
+            {
+               Kernels::SubtractScaledRow(&at(i, j + 1), &at(j, j + 1), multiplier, lastColumn - j - 1);
+            }
+         }
+      }
+   }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cholesky decomposition of a symmetric positive definite matrix: A = L * L^T
+//    Only the lower triangle of A is read. L is lower triangular with a positive diagonal, it is kept in a row-major
+//    buffer (the upper triangle of the buffer isn't used).
+//    The factorization is blocked and right-looking like LUDecomposition, but it updates the lower part of the
+//    trailing matrix only and needs no pivoting: it costs ~n^3/6 multiply-adds (half of LU).
+//    A pivot which isn't positive means that the matrix isn't positive definite: the factorization stops and
+//    IsPositiveDefinite() is false (LUDecomposition factorizes such matrices).
+template <typename ElementType>
+class CholeskyDecomposition
+{
+public:
+   static const size_t DefaultBlockSize = 64;
+
+   // Factorizes a square row-major matrix (ld is the distance between rows)
+   CholeskyDecomposition(size_t size, const ElementType* data, size_t ld, size_t blockSize = DefaultBlockSize)
+      : size_(size)
+      , l_(size * size, MatrixSettings::Zero<ElementType>())
+   {
+      for (size_t row = 0; row < size_; ++row)
+      {
+         std::copy(&data[row * ld], &data[row * ld] + row + 1, &l_[row * size_]);
+      }
+      factorize(blockSize);
+   }
+
+   size_t Size() const { return size_; }
+   bool IsPositiveDefinite() const { return positiveDefinite_; }
+
+   // det(A) = (product of L diagonal)^2
+   ElementType Determinant() const
+   {
+      ElementType result = MatrixSettings::One<ElementType>();
+      for (size_t i = 0; i < size_; ++i)
+      {
+         result *= l_[i * size_ + i] * l_[i * size_ + i];
+      }
+      return result;
+   }
+
+   // Solves A * X = B. B is a row-major Size() x columnCount matrix (ldb is the distance between rows); it is replaced by X.
+   bool Solve(ElementType* b, size_t columnCount, size_t ldb) const
+   {
+      if (!positiveDefinite_)
+      {
+         return false;
+      }
+      const size_t n = size_;
+      const ElementType* l = l_.data();
+      // B = L^(-1) * B (forward substitution, blocked by DefaultBlockSize rows)
+      for (size_t k0 = 0; k0 < n; k0 += DefaultBlockSize)
+      {
+         const size_t blockEnd = std::min(k0 + DefaultBlockSize, n);
+         for (size_t j = k0; j < blockEnd; ++j)
+         {
+            Kernels::ScaleRow(&b[j * ldb], MatrixSettings::One<ElementType>() / l[j * n + j], columnCount);
+            for (size_t i = j + 1; i < blockEnd; ++i)
+            {
+               Kernels::SubtractScaledRow(&b[i * ldb], &b[j * ldb], l[i * n + j], columnCount);
+            }
+         }
+         if (blockEnd < n)
+         {
+            Kernels::ParallelGemm<ElementType>(n - blockEnd, columnCount, blockEnd - k0,
+               -MatrixSettings::One<ElementType>(), &l[blockEnd * n + k0], n, &b[k0 * ldb], ldb,
+               MatrixSettings::One<ElementType>(), &b[blockEnd * ldb], ldb);
+         }
+      }
+      // B = L^(-T) * B (backward substitution: row j of L is column j of L^T)
+      for (size_t j = n; j-- > 0; )
+      {
+         Kernels::ScaleRow(&b[j * ldb], MatrixSettings::One<ElementType>() / l[j * n + j], columnCount);
+         for (size_t i = 0; i < j; ++i)
+         {
+            Kernels::SubtractScaledRow(&b[i * ldb], &b[j * ldb], l[j * n + i], columnCount);
+         }
+      }
+      return true;
+   }
+
+private:
+   size_t size_;
+   std::vector<ElementType> l_;
+   bool positiveDefinite_ = true;
+
+   void factorize(size_t blockSize)
+   {
+      const size_t n = size_;
+      const size_t nb = (blockSize == 0) ? DefaultBlockSize : blockSize;
+      ElementType* a = l_.data();
+      std::vector<ElementType> column(nb);
+      std::vector<ElementType> panel;
+      for (size_t k0 = 0; k0 < n; k0 += nb)
+      {
+         const size_t kb = std::min(nb, n - k0);
+         const size_t panelEnd = k0 + kb;
+         // Panel factorization (unblocked): columns [k0, panelEnd), rows [k0, n)
+         for (size_t j = k0; j < panelEnd; ++j)
+         {
+            const ElementType pivot = a[j * n + j];
+            if (!(pivot > MatrixSettings::Zero<ElementType>()) || MatrixSettings::CanAssumeItIsZero<ElementType>(pivot))
+            {
+               positiveDefinite_ = false;
+               return;
+            }
+            const ElementType diagonal = std::sqrt(pivot);
+            a[j * n + j] = diagonal;
+            for (size_t i = j + 1; i < n; ++i)
+            {
+               a[i * n + j] /= diagonal;
+            }
+            // Column j of L inside the panel is gathered, so the update of every row is contiguous
+            for (size_t p = j + 1; p < panelEnd; ++p)
+            {
+               column[p - k0] = a[p * n + j];
+            }
+            for (size_t i = j + 1; i < n; ++i)
+            {
+               const size_t last = std::min(i + 1, panelEnd);
+               if (j + 1 < last)
+               {
+                  Kernels::SubtractScaledRow(&a[i * n + j + 1], &column[j + 1 - k0], a[i * n + j], last - j - 1);
+               }
+            }
+         }
+         if (panelEnd == n)
+         {
+            break;
+         }
+         // A22 = A22 - L21 * L21^T (the lower part: block rows of A22 are updated up to their diagonal blocks)
+         const size_t trailingSize = n - panelEnd;
+         panel.resize(kb * trailingSize);
+         Kernels::Transpose(trailingSize, kb, &a[panelEnd * n + k0], n, panel.data(), trailingSize);
+         const size_t blockCount = (trailingSize + nb - 1) / nb;
+         auto updateBlockRow = [&](size_t block)
+         {
+            const size_t firstRow = panelEnd + block * nb;
+            const size_t lastRow = std::min(firstRow + nb, n);
+            Kernels::Gemm<ElementType>(lastRow - firstRow, lastRow - panelEnd, kb,
+               -MatrixSettings::One<ElementType>(), &a[firstRow * n + k0], n, panel.data(), trailingSize,
+               MatrixSettings::One<ElementType>(), &a[firstRow * n + panelEnd], n);
+         };
+         if ((blockCount < 2) || (0.5 * trailingSize * trailingSize * kb < static_cast<double>(ParallelSettings::MultiplyThreshold())) || (ParallelSettings::ThreadCount() == 1))
+         {
+            for (size_t block = 0; block < blockCount; ++block)
+            {
+               updateBlockRow(block);
+            }
+         }
+         else
+         {
+            ParallelSettings::Pool().ParallelFor(blockCount, updateBlockRow);
+         }
+      }
+   }
+};
+template <typename ElementType> const size_t CholeskyDecomposition<ElementType>::DefaultBlockSize;
+
 } // namespace Algorithms
 } // namespace SMT
 
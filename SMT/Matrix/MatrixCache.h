@@ -0,0 +1,230 @@
+#ifndef __MATRIX_CACHE_H__
+#define __MATRIX_CACHE_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cache of computed matrix elements (for matrices which compute their elements, e.g. function matrices)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tile cache.
+// Elements are computed by TileSize() x TileSize() tiles and kept in an LRU list while their bytes fit into the budget.
+// The whole matrix can be materialized (computed and kept as one row-major array) if it fits into the budget, then
+// tiles aren't needed any more. The compute function is passed to every call, so the cache doesn't keep references to
+// its owner and can be shared by copies of the matrix. It is thread-safe: a tile is computed without the lock (two
+// threads may compute the same tile, one of the results is kept).
+template <typename ElementType>
+class TileCache
+{
+public:
+   // Computes the tile [row, row + rowCount) x [column, column + columnCount) into buffer row by row
+   using ComputeFunc = std::function<void(size_t /*row*/, size_t /*column*/, size_t /*rowCount*/, size_t /*columnCount*/, ElementType* /*buffer*/, size_t /*stride*/)>;
+
+   TileCache(size_t rowCount, size_t columnCount, size_t tileSize, size_t byteBudget)
+      : rowCount_(rowCount)
+      , columnCount_(columnCount)
+      , tileSize_(std::max<size_t>(1, tileSize))
+      , byteBudget_(byteBudget)
+      , data_(nullptr)
+   {
+   }
+
+   size_t TileSize() const { return tileSize_; }
+   size_t ByteBudget() const { return byteBudget_; }
+   // Statistics: tiles which have been found in the cache and tiles which have been computed
+   size_t HitCount() const { return hitCount_; }
+   size_t MissCount() const { return missCount_; }
+   // Bytes of kept elements (tiles or the materialized matrix)
+   size_t ByteCount() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return byteCount_;
+   }
+
+   // Row-major elements of the whole matrix or nullptr if it isn't materialized
+   const ElementType* Data() const { return data_.load(std::memory_order_acquire); }
+
+   // Computes and keeps the whole matrix if it fits into the budget. Returns true if the matrix is materialized.
+   bool Materialize(const ComputeFunc& compute)
+   {
+      if (Data() != nullptr)
+      {
+         return true;
+      }
+      const size_t elementCount = rowCount_ * columnCount_;
+      if (elementCount * sizeof(ElementType) > byteBudget_)
+      {
+         return false;
+      }
+      // The matrix is computed at once (the compute function may fill it in parallel), not tile by tile through the LRU list
+      std::unique_ptr<std::vector<ElementType>> elements(new std::vector<ElementType>(elementCount));
+      compute(0, 0, rowCount_, columnCount_, elements->data(), columnCount_);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (materialized_ == nullptr)
+      {
+         // Tiles are the part of the matrix now
+         tiles_.clear();
+         index_.clear();
+         materialized_ = std::move(elements);
+         byteCount_ = elementCount * sizeof(ElementType);
+         data_.store(materialized_->data(), std::memory_order_release);
+      }
+      return true;
+   }
+
+   ElementType Element(size_t row, size_t column, const ComputeFunc& compute)
+   {
+      const ElementType* data = Data();
+      if (data != nullptr)
+      {
+         return data[row * columnCount_ + column];
+      }
+      const size_t tileRowIndex = row / tileSize_;
+      const size_t tileColumnIndex = column / tileSize_;
+      const TilePtr tile = findOrCompute(tileRowIndex, tileColumnIndex, compute);
+      if (tile == nullptr)
+      {
+         ElementType element;
+         compute(row, column, 1, 1, &element, 1);
+         return element;
+      }
+      return (*tile)[(row - tileRowIndex * tileSize_) * tileWidth(tileColumnIndex) + (column - tileColumnIndex * tileSize_)];
+   }
+
+   // Copies the part of the matrix into buffer row by row; missing tiles are computed and kept
+   void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride, const ComputeFunc& compute)
+   {
+      copyTile(row, column, rowCount, columnCount, buffer, stride, compute);
+   }
+
+private:
+   using TilePtr = std::shared_ptr<const std::vector<ElementType>>;
+   struct Tile
+   {
+      std::uint64_t Key_;
+      TilePtr Elements_;
+   };
+
+   const size_t rowCount_;
+   const size_t columnCount_;
+   const size_t tileSize_;
+   const size_t byteBudget_;
+
+   mutable std::mutex mutex_;
+   std::list<Tile> tiles_;                      // The most recently used tile is the first
+   std::unordered_map<std::uint64_t, typename std::list<Tile>::iterator> index_;
+   size_t byteCount_ = 0;
+   std::unique_ptr<std::vector<ElementType>> materialized_;
+   std::atomic<const ElementType*> data_;
+   std::atomic<size_t> hitCount_{ 0 };
+   std::atomic<size_t> missCount_{ 0 };
+
+   size_t tileHeight(size_t tileRowIndex) const { return std::min(tileSize_, rowCount_ - tileRowIndex * tileSize_); }
+   size_t tileWidth(size_t tileColumnIndex) const { return std::min(tileSize_, columnCount_ - tileColumnIndex * tileSize_); }
+   std::uint64_t key(size_t tileRowIndex, size_t tileColumnIndex) const
+   {
+      const std::uint64_t tileColumnCount = (columnCount_ + tileSize_ - 1) / tileSize_;
+      return static_cast<std::uint64_t>(tileRowIndex) * tileColumnCount + tileColumnIndex;
+   }
+
+   // Returns nullptr if a tile doesn't fit into the budget at all (elements are computed directly then)
+   TilePtr findOrCompute(size_t tileRowIndex, size_t tileColumnIndex, const ComputeFunc& compute)
+   {
+      const size_t height = tileHeight(tileRowIndex);
+      const size_t width = tileWidth(tileColumnIndex);
+      const size_t tileBytes = height * width * sizeof(ElementType);
+      if (tileBytes > byteBudget_)
+      {
+         return nullptr;
+      }
+      const std::uint64_t tileKey = key(tileRowIndex, tileColumnIndex);
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         const auto position = index_.find(tileKey);
+         if (position != index_.end())
+         {
+            tiles_.splice(tiles_.begin(), tiles_, position->second);
+            ++hitCount_;
+            return position->second->Elements_;
+         }
+      }
+
+      ++missCount_;
+      std::shared_ptr<std::vector<ElementType>> elements = std::make_shared<std::vector<ElementType>>(height * width);
+      compute(tileRowIndex * tileSize_, tileColumnIndex * tileSize_, height, width, elements->data(), width);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      if ((materialized_ != nullptr) || (index_.find(tileKey) != index_.end()))
+      {
+         return elements;
+      }
+      while (!tiles_.empty() && (byteCount_ + tileBytes > byteBudget_))
+      {
+         byteCount_ -= tiles_.back().Elements_->size() * sizeof(ElementType);
+         index_.erase(tiles_.back().Key_);
+         tiles_.pop_back();
+      }
+      tiles_.push_front(Tile{ tileKey, elements });
+      index_[tileKey] = tiles_.begin();
+      byteCount_ += tileBytes;
+      return elements;
+   }
+
+   void copyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride, const ComputeFunc& compute)
+   {
+      if ((rowCount == 0) || (columnCount == 0))
+      {
+         return;
+      }
+      const ElementType* data = Data();
+      if (data != nullptr)
+      {
+         for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+         {
+            const ElementType* source = &data[(row + tileRow) * columnCount_ + column];
+            std::copy(source, source + columnCount, &buffer[tileRow * stride]);
+         }
+         return;
+      }
+      // Every cached tile which intersects the requested part is copied by its intersection
+      for (size_t tileRowIndex = row / tileSize_; tileRowIndex * tileSize_ < row + rowCount; ++tileRowIndex)
+      {
+         const size_t firstRow = std::max(row, tileRowIndex * tileSize_);
+         const size_t lastRow = std::min(row + rowCount, tileRowIndex * tileSize_ + tileHeight(tileRowIndex));
+         for (size_t tileColumnIndex = column / tileSize_; tileColumnIndex * tileSize_ < column + columnCount; ++tileColumnIndex)
+         {
+            const size_t firstColumn = std::max(column, tileColumnIndex * tileSize_);
+            const size_t lastColumn = std::min(column + columnCount, tileColumnIndex * tileSize_ + tileWidth(tileColumnIndex));
+            ElementType* destination = &buffer[(firstRow - row) * stride + (firstColumn - column)];
+            const TilePtr tile = findOrCompute(tileRowIndex, tileColumnIndex, compute);
+            if (tile == nullptr)
+            {
+               compute(firstRow, firstColumn, lastRow - firstRow, lastColumn - firstColumn, destination, stride);
+               continue;
+            }
+            const size_t width = tileWidth(tileColumnIndex);
+            for (size_t sourceRow = firstRow; sourceRow < lastRow; ++sourceRow)
+            {
+               const ElementType* source = &(*tile)[(sourceRow - tileRowIndex * tileSize_) * width + (firstColumn - tileColumnIndex * tileSize_)];
+               std::copy(source, source + (lastColumn - firstColumn), &destination[(sourceRow - firstRow) * stride]);
+            }
+         }
+      }
+   }
+};
+
+} // namespace SMT
+
+#endif // __MATRIX_CACHE_H__
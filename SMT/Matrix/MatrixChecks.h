@@ -0,0 +1,147 @@
+#ifndef __MATRIX_CHECKS_H__
+#define __MATRIX_CHECKS_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Checks of matrices: sizes of operands and properties of elements
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+#include "MatrixDefs.h"
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// -- Functions that check if we can do some actions
+// Standard checks
+template <typename ElementType>
+void CheckIfCanAddTogether(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2, 
+   /*out*/ OperationResultCode& code, /*out*/ std::string& description)
+{
+   if (matrix1.RowCount() != matrix2.RowCount())
+   {
+      code = OperationResultCode::Error;
+      description = "Matrices that are added together have a different number of rows.";
+      return;
+   }
+   if (matrix1.ColumnCount() != matrix2.ColumnCount())
+   {
+      code = OperationResultCode::Error;
+      description = "Matrices that are added together have a different number of columns.";
+      return;
+   }
+   code = OperationResultCode::Ok;
+   description.clear();
+}
+
+template <typename ElementType>
+void CheckIfCanMultiplyTogether(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, 
+   /*out*/ OperationResultCode& code, /*out*/ std::string& description)
+{
+   if (leftMatrix.ColumnCount() != rightMatrix.RowCount())
+   {
+      code = OperationResultCode::Error;
+      description = "Matrices that are multiplyed together have a wrong number of column and rows: the left matrix has " + std::to_string(leftMatrix.ColumnCount()) + " column(s), the right matrix has " + std::to_string(rightMatrix.RowCount()) + " row(s)";
+      return;
+   }
+   code = OperationResultCode::Ok;
+   description.clear();
+}
+
+// The matrix of the linear system (matrix * X = rightHandSide) has to be square, the right-hand side has to have the same number of rows
+template <typename ElementType>
+void CheckIfCanSolve(const Matrix<ElementType>& matrix, const Matrix<ElementType>& rightHandSide,
+   /*out*/ OperationResultCode& code, /*out*/ std::string& description)
+{
+   if (matrix.RowCount() != matrix.ColumnCount())
+   {
+      code = OperationResultCode::Error;
+      description = "Linear system can't be solved: the number of rows (=" + std::to_string(matrix.RowCount()) + ") doesn't equal the number of columns (=" + std::to_string(matrix.ColumnCount()) + ")";
+      return;
+   }
+   if (matrix.RowCount() != rightHandSide.RowCount())
+   {
+      code = OperationResultCode::Error;
+      description = "Linear system can't be solved: the matrix has " + std::to_string(matrix.RowCount()) + " row(s), the right-hand side has " + std::to_string(rightHandSide.RowCount()) + " row(s)";
+      return;
+   }
+   code = OperationResultCode::Ok;
+   description.clear();
+}
+
+// The matrix which the result is written into (see Matrix::IInPlaceOperations) has to have the size of the result
+template <typename ElementType>
+void CheckIfCanHoldResult(const Matrix<ElementType>& resultMatrix, size_t rowCount, size_t columnCount,
+   /*out*/ OperationResultCode& code, /*out*/ std::string& description)
+{
+   if ((resultMatrix.RowCount() != rowCount) || (resultMatrix.ColumnCount() != columnCount))
+   {
+      code = OperationResultCode::Error;
+      description = "Matrix (" + std::to_string(resultMatrix.RowCount()) + "x" + std::to_string(resultMatrix.ColumnCount()) + ") can't hold the result of the operation (" + std::to_string(rowCount) + "x" + std::to_string(columnCount) + ")";
+      return;
+   }
+   code = OperationResultCode::Ok;
+   description.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// -- Functions that check matrix settings
+// Function moves through all elements and checks.
+// Elements are read row by row (see RowReader), so there is no virtual call per element.
+template <typename ElementType>
+bool Check(const Matrix<ElementType>& matrix, bool(*predicate)(size_t column, size_t row, ElementType element))
+{
+   if (predicate == nullptr)
+   {
+      return false;
+   }
+   const size_t rowCount = matrix.RowCount();
+   const size_t columnCount = matrix.ColumnCount();
+   RowReader<ElementType> reader(matrix);
+   for (size_t row = 0; row < rowCount; ++row)
+   {
+      const ElementType* rowData = reader.Row(row);
+      for (size_t column = 0; column < columnCount; ++column)
+      {
+         if (!predicate(row, column, rowData[column]))
+         {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+// Standard checks
+template <typename ElementType>
+bool CheckIfIdentityMatrix(const Matrix<ElementType>& matrix)
+{
+   auto isIdentityMatrixElement = [](size_t column, size_t row, ElementType element)
+   {
+      const ElementType requiredElement = (column == row) ? MatrixSettings::One<ElementType>() : MatrixSettings::Zero<ElementType>();
+      return MatrixSettings::CanAssumeItIsZero<ElementType>(requiredElement - element);
+   };
+   return Check<ElementType>(matrix, isIdentityMatrixElement);
+}
+template <typename ElementType>
+bool CheckIfZeroMatrix(const Matrix<ElementType>& matrix)
+{
+   auto isZeroMatrixElement = [](size_t /*column*/, size_t /*row*/, ElementType element)
+   {
+      return MatrixSettings::CanAssumeItIsZero<ElementType>(element);
+   };
+   return Check<ElementType>(matrix, isZeroMatrixElement);
+}
+template <typename ElementType>
+bool CheckIfDiagonalMatrix(const Matrix<ElementType>& matrix)
+{
+   auto isDiaginalMatrixElement = [](size_t column, size_t row, ElementType element)
+   {
+      return column == row ? true : MatrixSettings::CanAssumeItIsZero<ElementType>(element);
+   };
+   return Check<ElementType>(matrix, isDiaginalMatrixElement);
+}
+
+} // namespace SMT
+
+#endif // __MATRIX_CHECKS_H__
@@ -8,8 +8,10 @@
 // The main objects that are related to matrices
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -91,6 +93,42 @@ public:
    // Name of matrix type
    virtual std::string TypeName() const = 0;
 
+   // -- Bulk access to matrix data
+   //    Generic algorithms read matrices through these methods: one virtual call per row or per tile instead of one per element.
+   // Contiguous elements of the row (ColumnCount() elements).
+   // It returns nullptr if the storage doesn't keep the row contiguously (use CopyTile() in this case)
+   virtual const ElementType* RowData(size_t /*row*/) const { return nullptr; }
+   // Copies the tile [row, row + rowCount) x [column, column + columnCount) into buffer row by row (stride is the distance between rows in buffer).
+   // If the tile doesn't fit into the matrix behavior is undefined
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         const ElementType* rowData = RowData(row + tileRow);
+         if (rowData != nullptr)
+         {
+            std::copy(rowData + column, rowData + column + columnCount, destination);
+            continue;
+         }
+         for (size_t tileColumn = 0; tileColumn < columnCount; ++tileColumn)
+         {
+            destination[tileColumn] = Element(row + tileRow, column + tileColumn);
+         }
+      }
+   }
+   // Copies all elements into buffer row by row (stride is the distance between rows in buffer)
+   void CopyTo(ElementType* buffer, size_t stride) const { CopyTile(0, 0, RowCount(), ColumnCount(), buffer, stride); }
+   // Tells the matrix that every element is going to be read reuseCount times (e.g. by a product: the left operand is
+   // reused by every column of the right one). Matrices which compute their elements may keep them (see FunctionMatrix).
+   virtual void PrepareForReuse(size_t /*reuseCount*/) const {}
+   // Cost hint of the operation planner (see MatrixPlanner.h): indirect calls (virtual methods, functions) paid per element
+   // by bulk access. It is 0 if the elements are copied from memory, so the default CopyTile() (Element() per element) costs 1.
+   virtual double CallsPerElement() const { return ((RowCount() != 0) && (RowData(0) != nullptr)) ? 0.0 : 1.0; }
+   // Cost hint of the operation planner: bytes which the matrix keeps (with its indices), a native operation or a conversion
+   // reads them. All RowCount() x ColumnCount() elements by default, only nonzeros for a sparse matrix.
+   virtual double StoredBytes() const { return static_cast<double>(RowCount()) * ColumnCount() * sizeof(ElementType); }
+
    // -- Operations
    //    (!) The complexity includes the creation of the result.
    //    Examples:
@@ -119,6 +157,9 @@ public:
    // Determinant
    virtual Complexity::Type DeterminantEvaluationComplexity() const { return Complexity::Undefined; }
    virtual ScalarOperationResult Determinant() const { return ScalarOperationResult(); }
+   // Solution of the linear system This * X = rightHandSide (X has the size of rightHandSide)
+   virtual Complexity::Type SolvingComplexity(const Matrix<ElementType>& /*rightHandSide*/) const { return Complexity::Undefined; }
+   virtual OperationResult Solve(const Matrix<ElementType>& /*rightHandSide*/) const { return OperationResult(); }
 
    // Interface for elementary operations
    struct IElementaryOperations
@@ -131,9 +172,59 @@ public:
       virtual bool MultiplyAndSubtract(size_t rowIndex1, size_t rowIndex2, ElementType number) = 0;
    };
    virtual IElementaryOperations* ElementaryOperations() { return nullptr; }
+
+   // Interface for operations which write the result into the matrix itself (so no matrix is allocated for it).
+   //    The matrix has to have the size of the result, operands may be matrices of any types (including the matrix itself).
+   //    OperationResult::Matrix_ is always nullptr: the result is the matrix.
+   struct IInPlaceOperations
+   {
+      // This = This + matrix
+      virtual OperationResult AddInPlace(const Matrix<ElementType>& matrix) = 0;
+      // This = This * number
+      virtual OperationResult ScaleInPlace(const ElementType& number) = 0;
+      // This = matrix (elements are copied)
+      virtual OperationResult CopyFrom(const Matrix<ElementType>& matrix) = 0;
+      // This = matrix1 + matrix2
+      virtual OperationResult AddInto(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2) = 0;
+      // This = alpha * leftMatrix * rightMatrix + beta * This (GEMM). If beta equals zero the matrix isn't read.
+      virtual OperationResult MultiplyInto(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, const ElementType& alpha, const ElementType& beta) = 0;
+      // This = transposed matrix
+      virtual OperationResult TransposeInto(const Matrix<ElementType>& matrix) = 0;
+      // This = inverse of the matrix
+      virtual OperationResult InvertInto(const Matrix<ElementType>& matrix) = 0;
+   };
+   virtual IInPlaceOperations* InPlaceOperations() { return nullptr; }
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Row by row reading of any matrix.
+// Row() returns RowData() if the storage keeps rows contiguously, otherwise the row is copied into the own buffer by
+// CopyTile(). The pointer is valid until the next call.
+template <typename ElementType>
+class RowReader
+{
+public:
+   explicit RowReader(const Matrix<ElementType>& matrix)
+      : matrix_(matrix)
+   {
+   }
+   const ElementType* Row(size_t row)
+   {
+      const ElementType* rowData = matrix_.RowData(row);
+      if (rowData != nullptr)
+      {
+         return rowData;
+      }
+      const size_t columnCount = matrix_.ColumnCount();
+      buffer_.resize(columnCount);
+      matrix_.CopyTile(row, 0, 1, columnCount, buffer_.data(), columnCount);
+      return buffer_.data();
+   }
+
+private:
+   const Matrix<ElementType>& matrix_;
+   std::vector<ElementType> buffer_;
+};
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -151,7 +242,7 @@ template <typename ElementType>
 template <typename ElementType>
    typename std::enable_if<std::is_floating_point<ElementType>::value, ElementType>::type Epsilon() { return std::numeric_limits<ElementType>::epsilon(); }
 template <typename ElementType>
-   bool CanAssumeItIsZero(const ElementType& element, ElementType factor = One<ElementType>()) { return std::abs<ElementType>(element - Zero<ElementType>()) <= factor * Epsilon<ElementType>(); }
+   bool CanAssumeItIsZero(const ElementType& element, ElementType factor = One<ElementType>()) { return std::abs(element - Zero<ElementType>()) <= factor * Epsilon<ElementType>(); }
 template <typename ElementType>
    std::function<ElementType(size_t row, size_t column)> IdentityMatrixFunction() { return [](size_t row, size_t column) -> ElementType { return (column == row) ? One<ElementType>() : Zero<ElementType>(); }; }
 } // namespace MatrixSettings
@@ -0,0 +1,307 @@
+#ifndef __MATRIX_EXPRESSION_H__
+#define __MATRIX_EXPRESSION_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lazy matrix expressions
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixKernels.h"
+#include "StandardMatrix.h"
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lazy matrix expression.
+// An expression is kept as a linear combination of terms: sum(Coefficient * Matrix) + sum(Coefficient * Left * Right).
+// Operators only build the combination, nothing is computed until Evaluate()/EvaluateTo() is called. Then
+//    - all elementwise terms are summed in one pass over memory (row by row),
+//    - every product term is accumulated right into the result by the GEMM kernel (C = alpha * A * B + beta * C).
+// So A * B + 2 * C doesn't create temporaries, and EvaluateTo(C) of alpha * A * B + beta * C is one GEMM call.
+// Matrices are referenced, not copied: they must live until the expression is evaluated.
+// A compound operand of a product (e.g. A + B in (A + B) * C) is evaluated when the product is built.
+//    Example:
+//       auto result = (SMT::Lazy(a) * b + 2.0 * SMT::Lazy(c)).Evaluate();
+template <typename ElementType>
+class MatrixExpression
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+
+   // An expression which consists of one matrix
+   MatrixExpression(const Matrix<ElementType>& matrix)
+      : rowCount_(matrix.RowCount())
+      , columnCount_(matrix.ColumnCount())
+   {
+      terms_.push_back(Term{ MatrixSettings::One<ElementType>(), &matrix, nullptr });
+   }
+
+   size_t RowCount() const { return rowCount_; }
+   size_t ColumnCount() const { return columnCount_; }
+   // Error means that sizes of some operands don't match (Description() contains details). Such expression can't be evaluated.
+   OperationResultCode Code() const { return code_; }
+   const std::string& Description() const { return description_; }
+
+   // -- Operators (they build new expressions)
+   friend MatrixExpression operator+(const MatrixExpression& left, const MatrixExpression& right) { return combine(left, right, MatrixSettings::One<ElementType>()); }
+   friend MatrixExpression operator-(const MatrixExpression& left, const MatrixExpression& right) { return combine(left, right, -MatrixSettings::One<ElementType>()); }
+   friend MatrixExpression operator*(const ElementType& number, const MatrixExpression& expression) { return expression.scale(number); }
+   friend MatrixExpression operator*(const MatrixExpression& expression, const ElementType& number) { return expression.scale(number); }
+   friend MatrixExpression operator*(const MatrixExpression& left, const MatrixExpression& right) { return product(left, right); }
+
+   // -- Evaluation
+   // Evaluates the expression into a new standard matrix
+   OperationResult Evaluate() const
+   {
+      return EvaluateTo(std::make_shared<StandardMatrix<ElementType>>(rowCount_, columnCount_));
+   }
+   // Evaluates the expression into the existing matrix (it has to be RowCount() x ColumnCount()).
+   // The destination may be an operand of the expression (e.g. C = alpha * A * B + beta * C).
+   OperationResult EvaluateTo(const std::shared_ptr<StandardMatrix<ElementType>>& destination) const
+   {
+      OperationResult result;
+      if (code_ == OperationResultCode::Error)
+      {
+         result.Code_ = code_;
+         result.Description_ = description_;
+         return result;
+      }
+      if (destination == nullptr || destination->RowCount() != rowCount_ || destination->ColumnCount() != columnCount_)
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Expression can't be evaluated: the destination matrix has a wrong size";
+         return result;
+      }
+      evaluateTo(*destination);
+      result.Matrix_ = destination;
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+private:
+   // Coefficient * Left (elementwise term, Right == nullptr) or Coefficient * Left * Right (product term)
+   struct Term
+   {
+      ElementType Coefficient_;
+      const Matrix<ElementType>* Left_;
+      const Matrix<ElementType>* Right_;
+   };
+
+   size_t rowCount_;
+   size_t columnCount_;
+   std::vector<Term> terms_;
+   std::vector<std::shared_ptr<const Matrix<ElementType>>> temporaries_;   // Evaluated operands which are referenced by terms_
+   OperationResultCode code_ = OperationResultCode::Ok;
+   std::string description_;
+
+   static MatrixExpression error(const MatrixExpression& expression, const std::string& description)
+   {
+      MatrixExpression result(expression);
+      result.code_ = OperationResultCode::Error;
+      result.description_ = description;
+      return result;
+   }
+
+   // left + sign * right
+   static MatrixExpression combine(const MatrixExpression& left, const MatrixExpression& right, const ElementType& sign)
+   {
+      if (left.code_ == OperationResultCode::Error || right.code_ == OperationResultCode::Error)
+      {
+         return (left.code_ == OperationResultCode::Error) ? left : right;
+      }
+      if (left.rowCount_ != right.rowCount_ || left.columnCount_ != right.columnCount_)
+      {
+         return error(left, "Matrices that are added together have a different number of rows or columns.");
+      }
+      MatrixExpression result(left);
+      result.temporaries_.insert(result.temporaries_.end(), right.temporaries_.begin(), right.temporaries_.end());
+      for (const Term& term : right.terms_)
+      {
+         // The same matrix which is added several times is read once
+         auto sameTerm = std::find_if(result.terms_.begin(), result.terms_.end(), [&term](const Term& existingTerm)
+         {
+            return existingTerm.Left_ == term.Left_ && existingTerm.Right_ == term.Right_;
+         });
+         if (sameTerm != result.terms_.end())
+         {
+            sameTerm->Coefficient_ += sign * term.Coefficient_;
+         }
+         else
+         {
+            result.terms_.push_back(Term{ sign * term.Coefficient_, term.Left_, term.Right_ });
+         }
+      }
+      return result;
+   }
+
+   MatrixExpression scale(const ElementType& number) const
+   {
+      MatrixExpression result(*this);
+      for (Term& term : result.terms_)
+      {
+         term.Coefficient_ *= number;
+      }
+      return result;
+   }
+
+   static MatrixExpression product(const MatrixExpression& left, const MatrixExpression& right)
+   {
+      if (left.code_ == OperationResultCode::Error || right.code_ == OperationResultCode::Error)
+      {
+         return (left.code_ == OperationResultCode::Error) ? left : right;
+      }
+      if (left.columnCount_ != right.rowCount_)
+      {
+         return error(left, "Matrices that are multiplyed together have a wrong number of column and rows: the left matrix has " + std::to_string(left.columnCount_) + " column(s), the right matrix has " + std::to_string(right.rowCount_) + " row(s)");
+      }
+      MatrixExpression result(left);
+      result.columnCount_ = right.columnCount_;
+      result.temporaries_.insert(result.temporaries_.end(), right.temporaries_.begin(), right.temporaries_.end());
+      const Term leftOperand = left.operand(result.temporaries_);
+      const Term rightOperand = right.operand(result.temporaries_);
+      result.terms_.assign(1, Term{ leftOperand.Coefficient_ * rightOperand.Coefficient_, leftOperand.Left_, rightOperand.Left_ });
+      return result;
+   }
+
+   // The expression as one scaled matrix: compound expressions are evaluated (the result is kept in temporaries)
+   Term operand(std::vector<std::shared_ptr<const Matrix<ElementType>>>& temporaries) const
+   {
+      if (terms_.size() == 1 && terms_[0].Right_ == nullptr)
+      {
+         return terms_[0];
+      }
+      auto evaluated = std::make_shared<StandardMatrix<ElementType>>(rowCount_, columnCount_);
+      evaluateTo(*evaluated);
+      temporaries.push_back(evaluated);
+      return Term{ MatrixSettings::One<ElementType>(), evaluated.get(), nullptr };
+   }
+
+   // Row-major storage of the matrix: its own storage if all rows are stored one after another, otherwise a copy
+   static const ElementType* denseData(const Matrix<ElementType>& matrix, std::vector<ElementType>& copy)
+   {
+      const size_t rowCount = matrix.RowCount();
+      const size_t columnCount = matrix.ColumnCount();
+      if (rowCount == 0 || columnCount == 0)
+      {
+         return nullptr;
+      }
+      const ElementType* data = matrix.RowData(0);
+      if (data != nullptr && matrix.RowData(rowCount - 1) == data + (rowCount - 1) * columnCount)
+      {
+         return data;
+      }
+      copy.resize(rowCount * columnCount);
+      matrix.CopyTo(copy.data(), columnCount);
+      return copy.data();
+   }
+
+   void evaluateTo(StandardMatrix<ElementType>& destination) const
+   {
+      // A product which reads the destination can't accumulate into it
+      for (const Term& term : terms_)
+      {
+         if (term.Right_ != nullptr && (term.Left_ == &destination || term.Right_ == &destination))
+         {
+            StandardMatrix<ElementType> evaluated(rowCount_, columnCount_);
+            evaluateTo(evaluated);
+            const StandardMatrix<ElementType>& source = evaluated;
+            std::copy(source.Data(), source.Data() + rowCount_ * columnCount_, destination.DataForOverwrite());
+            return;
+         }
+      }
+
+      // One pass for all elementwise terms. The destination (if it is a term) is scaled in place first.
+      std::vector<const Term*> elementwiseTerms;
+      const Term* destinationTerm = nullptr;
+      for (const Term& term : terms_)
+      {
+         if (term.Right_ == nullptr)
+         {
+            if (term.Left_ == &destination)
+            {
+               destinationTerm = &term;
+            }
+            else
+            {
+               elementwiseTerms.push_back(&term);
+            }
+         }
+      }
+      // Elements of the destination are read only if it is a term, otherwise they are all overwritten
+      ElementType* result = (destinationTerm != nullptr) ? destination.Data() : destination.DataForOverwrite();
+      const bool hasElementwiseTerms = (destinationTerm != nullptr) || !elementwiseTerms.empty();
+      if (hasElementwiseTerms)
+      {
+         std::vector<RowReader<ElementType>> readers;
+         for (const Term* term : elementwiseTerms)
+         {
+            readers.emplace_back(*term->Left_);
+         }
+         for (size_t row = 0; row < rowCount_; ++row)
+         {
+            ElementType* resultRow = &result[row * columnCount_];
+            size_t firstTerm = 0;
+            if (destinationTerm != nullptr)
+            {
+               Kernels::ScaleRow(resultRow, destinationTerm->Coefficient_, columnCount_);
+            }
+            else
+            {
+               const ElementType* source = readers[0].Row(row);
+               const ElementType coefficient = elementwiseTerms[0]->Coefficient_;
+               for (size_t column = 0; column < columnCount_; ++column)
+               {
+                  resultRow[column] = coefficient * source[column];
+               }
+               firstTerm = 1;
+            }
+            for (size_t i = firstTerm; i < elementwiseTerms.size(); ++i)
+            {
+               const ElementType* source = readers[i].Row(row);
+               const ElementType coefficient = elementwiseTerms[i]->Coefficient_;
+               for (size_t column = 0; column < columnCount_; ++column)
+               {
+                  resultRow[column] += coefficient * source[column];
+               }
+            }
+         }
+      }
+
+      // Every product is accumulated into the result by GEMM (the first one overwrites it if there are no elementwise terms)
+      bool resultIsInitialized = hasElementwiseTerms;
+      for (const Term& term : terms_)
+      {
+         if (term.Right_ == nullptr)
+         {
+            continue;
+         }
+         std::vector<ElementType> leftCopy;
+         std::vector<ElementType> rightCopy;
+         const size_t innerSize = term.Left_->ColumnCount();
+         Kernels::ParallelGemm<ElementType>(rowCount_, columnCount_, innerSize,
+            term.Coefficient_, denseData(*term.Left_, leftCopy), innerSize, denseData(*term.Right_, rightCopy), columnCount_,
+            resultIsInitialized ? MatrixSettings::One<ElementType>() : MatrixSettings::Zero<ElementType>(), result, columnCount_);
+         resultIsInitialized = true;
+      }
+      if (!resultIsInitialized)
+      {
+         std::fill(result, result + rowCount_ * columnCount_, MatrixSettings::Zero<ElementType>());
+      }
+   }
+};
+
+// Starts a lazy expression: SMT::Lazy(a) * b + c
+template <typename ElementType>
+MatrixExpression<ElementType> Lazy(const Matrix<ElementType>& matrix)
+{
+   return MatrixExpression<ElementType>(matrix);
+}
+
+} // namespace SMT
+
+#endif // __MATRIX_EXPRESSION_H__
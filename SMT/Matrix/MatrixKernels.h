@@ -0,0 +1,519 @@
+#ifndef __MATRIX_KERNELS_H__
+#define __MATRIX_KERNELS_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Low-level kernels that work with raw (row-major) matrix storage
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixSimd.h"
+#include "../Threading/ThreadPool.h"
+
+namespace SMT
+{
+namespace Kernels
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GEMM blocking parameters.
+//    MR x NR is the register tile which is computed by the micro-kernel.
+//    MC x KC is the block of the left matrix which is packed and kept in L2 cache.
+//    KC x NC is the panel of the right matrix which is packed and kept in L3 cache (KC x NR micro-panel stays in L1).
+//    TileRows x TileColumns is the part of the result which is computed by one task of the parallel GEMM.
+//    Single precision elements get a wider register tile and a deeper panel (the same number of bytes).
+template <typename ElementType>
+struct GemmBlocking
+{
+   static const size_t MR = 4;
+   static const size_t NR = (sizeof(ElementType) <= 4) ? 16 : 8;
+   static const size_t MC = 128;
+   static const size_t KC = (sizeof(ElementType) <= 4) ? 384 : 256;
+   static const size_t NC = 4096;
+   static const size_t TileRows = 128;
+   static const size_t TileColumns = 512;
+};
+template <typename ElementType> const size_t GemmBlocking<ElementType>::MR;
+template <typename ElementType> const size_t GemmBlocking<ElementType>::NR;
+template <typename ElementType> const size_t GemmBlocking<ElementType>::MC;
+template <typename ElementType> const size_t GemmBlocking<ElementType>::KC;
+template <typename ElementType> const size_t GemmBlocking<ElementType>::NC;
+template <typename ElementType> const size_t GemmBlocking<ElementType>::TileRows;
+template <typename ElementType> const size_t GemmBlocking<ElementType>::TileColumns;
+
+namespace Details
+{
+// Packs the block A[0..mc) x [0..kc) into MR-row micro-panels: panel after panel, every panel is stored column by column.
+// Missing rows of the last (ragged) panel are filled with zeros.
+template <typename ElementType>
+void PackLeftBlock(size_t mc, size_t kc, const ElementType* a, size_t lda, ElementType* packed)
+{
+   const size_t MR = GemmBlocking<ElementType>::MR;
+   for (size_t panelRow = 0; panelRow < mc; panelRow += MR)
+   {
+      const size_t rows = std::min(MR, mc - panelRow);
+      for (size_t p = 0; p < kc; ++p)
+      {
+         size_t i = 0;
+         for (; i < rows; ++i)
+         {
+            packed[i] = a[(panelRow + i) * lda + p];
+         }
+         for (; i < MR; ++i)
+         {
+            packed[i] = MatrixSettings::Zero<ElementType>();
+         }
+         packed += MR;
+      }
+   }
+}
+
+// Packs the panel B[0..kc) x [0..nc) into NR-column micro-panels: panel after panel, every panel is stored row by row.
+// Missing columns of the last (ragged) panel are filled with zeros.
+template <typename ElementType>
+void PackRightPanel(size_t kc, size_t nc, const ElementType* b, size_t ldb, ElementType* packed)
+{
+   const size_t NR = GemmBlocking<ElementType>::NR;
+   for (size_t panelColumn = 0; panelColumn < nc; panelColumn += NR)
+   {
+      const size_t columns = std::min(NR, nc - panelColumn);
+      for (size_t p = 0; p < kc; ++p)
+      {
+         const ElementType* row = &b[p * ldb + panelColumn];
+         size_t j = 0;
+         for (; j < columns; ++j)
+         {
+            packed[j] = row[j];
+         }
+         for (; j < NR; ++j)
+         {
+            packed[j] = MatrixSettings::Zero<ElementType>();
+         }
+         packed += NR;
+      }
+   }
+}
+
+// Micro-kernel: C[0..rows) x [0..columns) += alpha * (packed MR-row micro-panel) * (packed NR-column micro-panel)
+// The MR x NR accumulator is small enough to live in registers, so the compiler can vectorize the inner loop.
+template <typename ElementType>
+void MicroKernel(size_t kc, ElementType alpha, const ElementType* a, const ElementType* b, ElementType* c, size_t ldc, size_t rows, size_t columns)
+{
+   const size_t MR = GemmBlocking<ElementType>::MR;
+   const size_t NR = GemmBlocking<ElementType>::NR;
+   ElementType accumulator[MR][NR];
+   for (size_t i = 0; i < MR; ++i)
+   {
+      for (size_t j = 0; j < NR; ++j)
+      {
+         accumulator[i][j] = MatrixSettings::Zero<ElementType>();
+      }
+   }
+   for (size_t p = 0; p < kc; ++p)
+   {
+      for (size_t i = 0; i < MR; ++i)
+      {
+         const ElementType aValue = a[i];
+         for (size_t j = 0; j < NR; ++j)
+         {
+            accumulator[i][j] += aValue * b[j];
+         }
+      }
+      a += MR;
+      b += NR;
+   }
+   for (size_t i = 0; i < rows; ++i)
+   {
+      ElementType* cRow = &c[i * ldc];
+      for (size_t j = 0; j < columns; ++j)
+      {
+         cRow[j] += alpha * accumulator[i][j];
+      }
+   }
+}
+
+// C = beta * C
+template <typename ElementType>
+void ScaleBlock(size_t m, size_t n, ElementType beta, ElementType* c, size_t ldc)
+{
+   if (beta == MatrixSettings::One<ElementType>())
+   {
+      return;
+   }
+   for (size_t i = 0; i < m; ++i)
+   {
+      ElementType* cRow = &c[i * ldc];
+      if (beta == MatrixSettings::Zero<ElementType>())
+      {
+         std::fill(cRow, cRow + n, MatrixSettings::Zero<ElementType>());
+      }
+      else
+      {
+         for (size_t j = 0; j < n; ++j)
+         {
+            cRow[j] *= beta;
+         }
+      }
+   }
+}
+} // namespace Details
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// General matrix multiplication: C = alpha * A * B + beta * C
+//    A is m x k, B is k x n, C is m x n. All matrices are stored row by row; lda, ldb and ldc are distances between rows.
+//    If beta equals zero C is not read (so it may contain garbage).
+//    Both operands are packed into cache-sized blocks, so the kernel reads memory sequentially regardless of the strides.
+template <typename ElementType>
+void Gemm(size_t m, size_t n, size_t k, ElementType alpha, const ElementType* a, size_t lda, const ElementType* b, size_t ldb, ElementType beta, ElementType* c, size_t ldc)
+{
+   using Blocking = GemmBlocking<ElementType>;
+   if (m == 0 || n == 0)
+   {
+      return;
+   }
+   Details::ScaleBlock(m, n, beta, c, ldc);
+   if (k == 0 || alpha == MatrixSettings::Zero<ElementType>())
+   {
+      return;
+   }
+
+   const size_t kcMax = std::min(Blocking::KC, k);
+   const size_t mcMax = std::min(Blocking::MC, m);
+   const size_t ncMax = std::min(Blocking::NC, n);
+   std::vector<ElementType> packedA(((mcMax + Blocking::MR - 1) / Blocking::MR) * Blocking::MR * kcMax);
+   std::vector<ElementType> packedB(((ncMax + Blocking::NR - 1) / Blocking::NR) * Blocking::NR * kcMax);
+
+   for (size_t jc = 0; jc < n; jc += Blocking::NC)
+   {
+      const size_t nc = std::min(Blocking::NC, n - jc);
+      for (size_t pc = 0; pc < k; pc += Blocking::KC)
+      {
+         const size_t kc = std::min(Blocking::KC, k - pc);
+         Details::PackRightPanel(kc, nc, &b[pc * ldb + jc], ldb, packedB.data());
+         for (size_t ic = 0; ic < m; ic += Blocking::MC)
+         {
+            const size_t mc = std::min(Blocking::MC, m - ic);
+            Details::PackLeftBlock(mc, kc, &a[ic * lda + pc], lda, packedA.data());
+            for (size_t jr = 0; jr < nc; jr += Blocking::NR)
+            {
+               const size_t columns = std::min(Blocking::NR, nc - jr);
+               const ElementType* bPanel = &packedB[(jr / Blocking::NR) * Blocking::NR * kc];
+               for (size_t ir = 0; ir < mc; ir += Blocking::MR)
+               {
+                  const size_t rows = std::min(Blocking::MR, mc - ir);
+                  const ElementType* aPanel = &packedA[(ir / Blocking::MR) * Blocking::MR * kc];
+                  Details::MicroKernel(kc, alpha, aPanel, bPanel, &c[(ic + ir) * ldc + jc + jr], ldc, rows, columns);
+               }
+            }
+         }
+      }
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Multithreaded GEMM: C = alpha * A * B + beta * C
+//    The result is split into a fixed grid of TileRows x TileColumns tiles, every tile is computed by Gemm() in a task of
+//    the library thread pool. Tiles don't split the inner dimension and the k-blocking of every tile starts at zero, so
+//    every element of C is accumulated in exactly the same order as by the serial Gemm(): the result is bit-identical.
+//    Small products (see ParallelSettings::MultiplyThreshold()) are computed by the calling thread.
+template <typename ElementType>
+void ParallelGemm(size_t m, size_t n, size_t k, ElementType alpha, const ElementType* a, size_t lda, const ElementType* b, size_t ldb, ElementType beta, ElementType* c, size_t ldc)
+{
+   using Blocking = GemmBlocking<ElementType>;
+   const size_t tileRowCount = (m + Blocking::TileRows - 1) / Blocking::TileRows;
+   const size_t tileColumnCount = (n + Blocking::TileColumns - 1) / Blocking::TileColumns;
+   const size_t tileCount = tileRowCount * tileColumnCount;
+   if (tileCount <= 1 || static_cast<double>(m) * n * k < static_cast<double>(ParallelSettings::MultiplyThreshold()) || ParallelSettings::ThreadCount() == 1)
+   {
+      Gemm(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+      return;
+   }
+   ParallelSettings::Pool().ParallelFor(tileCount, [=](size_t tileIndex)
+   {
+      const size_t row = (tileIndex / tileColumnCount) * Blocking::TileRows;
+      const size_t column = (tileIndex % tileColumnCount) * Blocking::TileColumns;
+      const size_t rows = std::min(Blocking::TileRows, m - row);
+      const size_t columns = std::min(Blocking::TileColumns, n - column);
+      Gemm(rows, columns, k, alpha, &a[row * lda], lda, &b[column], ldb, beta, &c[row * ldc + column], ldc);
+   });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Strassen-Winograd multiplication: C = A * B
+//    A is m x k, B is k x n, C is m x n (row by row, like in Gemm()). The even part of the product is split into 2 x 2
+//    blocks which are multiplied by 7 products and 15 additions (Winograd's variant of Strassen's algorithm) instead of
+//    8 products, recursively while all dimensions are greater than crossoverSize; smaller products, the odd row, column
+//    and inner element are computed by ParallelGemm(). Every level saves 1/8 of the multiplications, so the product
+//    costs O(n^2.81) and is faster than GEMM for large matrices only (the crossover depends on the machine).
+//    Accuracy: unlike GEMM, whose error is bounded elementwise (|C - C'| <= k * u * |A| * |B|), the error is bounded
+//    normwise only: max|C - C'| <= ((n0^2 + 5 * n0) * 18^l - 5 * n) * u * max|A| * max|B| (approximately, see Higham,
+//    "Accuracy and Stability of Numerical Algorithms", 23.2), where l is the number of levels, n0 = n / 2^l is the size
+//    of the GEMM products and u is the unit roundoff. So small elements of C may lose their relative accuracy, and every
+//    level multiplies the bound by up to 18 (a larger crossover means fewer levels and smaller errors).
+//    Temporary blocks are taken from workspace (StrassenWinogradWorkspaceSize() elements), so a product allocates
+//    nothing when the workspace is reused.
+namespace Details
+{
+// dst = src1 + sign * src2 (elementwise, so dst may be src1 or src2)
+template <typename ElementType>
+void CombineBlocks(size_t rowCount, size_t columnCount, ElementType* dst, size_t ldd, const ElementType* src1, size_t ld1, const ElementType* src2, size_t ld2, bool subtract)
+{
+   for (size_t row = 0; row < rowCount; ++row)
+   {
+      ElementType* d = &dst[row * ldd];
+      const ElementType* s1 = &src1[row * ld1];
+      const ElementType* s2 = &src2[row * ld2];
+      if (subtract)
+      {
+         for (size_t column = 0; column < columnCount; ++column)
+         {
+            d[column] = s1[column] - s2[column];
+         }
+      }
+      else
+      {
+         for (size_t column = 0; column < columnCount; ++column)
+         {
+            d[column] = s1[column] + s2[column];
+         }
+      }
+   }
+}
+
+inline bool StrassenWinogradSplits(size_t m, size_t n, size_t k, size_t crossoverSize)
+{
+   return std::min(std::min(m, n), k) > std::max<size_t>(crossoverSize, 1);
+}
+} // namespace Details
+
+inline size_t StrassenWinogradWorkspaceSize(size_t m, size_t n, size_t k, size_t crossoverSize)
+{
+   size_t size = 0;
+   while (Details::StrassenWinogradSplits(m, n, k, crossoverSize))
+   {
+      m /= 2;
+      n /= 2;
+      k /= 2;
+      // S (m x k), T (k x n) and P (m x n) blocks of every level
+      size += m * k + k * n + m * n;
+   }
+   return size;
+}
+
+template <typename ElementType>
+void StrassenWinogradGemm(size_t m, size_t n, size_t k, const ElementType* a, size_t lda, const ElementType* b, size_t ldb, ElementType* c, size_t ldc,
+   size_t crossoverSize, ElementType* workspace)
+{
+   const ElementType one = MatrixSettings::One<ElementType>();
+   const ElementType zero = MatrixSettings::Zero<ElementType>();
+   if (!Details::StrassenWinogradSplits(m, n, k, crossoverSize))
+   {
+      ParallelGemm(m, n, k, one, a, lda, b, ldb, zero, c, ldc);
+      return;
+   }
+   const size_t m2 = m / 2;
+   const size_t n2 = n / 2;
+   const size_t k2 = k / 2;
+   const ElementType* a11 = a;
+   const ElementType* a12 = &a[k2];
+   const ElementType* a21 = &a[m2 * lda];
+   const ElementType* a22 = &a[m2 * lda + k2];
+   const ElementType* b11 = b;
+   const ElementType* b12 = &b[n2];
+   const ElementType* b21 = &b[k2 * ldb];
+   const ElementType* b22 = &b[k2 * ldb + n2];
+   ElementType* c11 = c;
+   ElementType* c12 = &c[n2];
+   ElementType* c21 = &c[m2 * ldc];
+   ElementType* c22 = &c[m2 * ldc + n2];
+   ElementType* s = workspace;
+   ElementType* t = s + m2 * k2;
+   ElementType* p = t + k2 * n2;
+   ElementType* next = p + m2 * n2;
+   auto multiply = [&](const ElementType* left, size_t ldl, const ElementType* right, size_t ldr, ElementType* product, size_t ldp)
+   {
+      StrassenWinogradGemm(m2, n2, k2, left, ldl, right, ldr, product, ldp, crossoverSize, next);
+   };
+
+   // The schedule keeps 3 temporary blocks only: products are accumulated in the blocks of C
+   Details::CombineBlocks(m2, k2, s, k2, a11, lda, a21, lda, true);        // S3 = A11 - A21
+   Details::CombineBlocks(k2, n2, t, n2, b22, ldb, b12, ldb, true);        // T3 = B22 - B12
+   multiply(s, k2, t, n2, c21, ldc);                                       // C21 = P7 = S3 * T3
+   Details::CombineBlocks(m2, k2, s, k2, a21, lda, a22, lda, false);       // S1 = A21 + A22
+   Details::CombineBlocks(k2, n2, t, n2, b12, ldb, b11, ldb, true);        // T1 = B12 - B11
+   multiply(s, k2, t, n2, c22, ldc);                                       // C22 = P5 = S1 * T1
+   Details::CombineBlocks(m2, k2, s, k2, s, k2, a11, lda, true);           // S2 = S1 - A11
+   Details::CombineBlocks(k2, n2, t, n2, b22, ldb, t, n2, true);           // T2 = B22 - T1
+   multiply(s, k2, t, n2, c12, ldc);                                       // C12 = P6 = S2 * T2
+   Details::CombineBlocks(m2, k2, s, k2, a12, lda, s, k2, true);           // S4 = A12 - S2
+   multiply(s, k2, b22, ldb, c11, ldc);                                    // C11 = P3 = S4 * B22
+   multiply(a11, lda, b11, ldb, p, n2);                                    // P = P1 = A11 * B11
+   Details::CombineBlocks(m2, n2, c12, ldc, p, n2, c12, ldc, false);       // C12 = U2 = P1 + P6
+   Details::CombineBlocks(m2, n2, c21, ldc, c12, ldc, c21, ldc, false);    // C21 = U3 = U2 + P7
+   Details::CombineBlocks(m2, n2, c12, ldc, c12, ldc, c22, ldc, false);    // C12 = U4 = U2 + P5
+   Details::CombineBlocks(m2, n2, c22, ldc, c21, ldc, c22, ldc, false);    // C22 = U7 = U3 + P5 (final)
+   Details::CombineBlocks(m2, n2, c12, ldc, c12, ldc, c11, ldc, false);    // C12 = U5 = U4 + P3 (final)
+   Details::CombineBlocks(k2, n2, t, n2, t, n2, b21, ldb, true);           // T4 = T2 - B21
+   multiply(a22, lda, t, n2, c11, ldc);                                    // C11 = P4 = A22 * T4
+   Details::CombineBlocks(m2, n2, c21, ldc, c21, ldc, c11, ldc, true);     // C21 = U6 = U3 - P4 (final)
+   multiply(a12, lda, b21, ldb, c11, ldc);                                 // C11 = P2 = A12 * B21
+   Details::CombineBlocks(m2, n2, c11, ldc, p, n2, c11, ldc, false);       // C11 = U1 = P1 + P2 (final)
+
+   // The odd inner element, row and column
+   if (2 * k2 < k)
+   {
+      ParallelGemm(2 * m2, 2 * n2, size_t(1), one, &a[k - 1], lda, &b[(k - 1) * ldb], ldb, one, c, ldc);
+   }
+   if (2 * m2 < m)
+   {
+      ParallelGemm(size_t(1), n, k, one, &a[(m - 1) * lda], lda, b, ldb, zero, &c[(m - 1) * ldc], ldc);
+   }
+   if (2 * n2 < n)
+   {
+      ParallelGemm(2 * m2, size_t(1), k, one, a, lda, &b[n - 1], ldb, zero, &c[n - 1], ldc);
+   }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Transposition.
+//    The matrix is split in halves along the longer dimension until a tile fits in L1 cache (cache-oblivious recursion),
+//    tiles are transposed by SIMD micro-kernels (see MatrixSimd.h). Splits are aligned to the micro-kernel size.
+template <typename ElementType>
+struct TransposeBlocking
+{
+   static const size_t Tile = 32;
+   static const size_t Alignment = 8;
+};
+template <typename ElementType> const size_t TransposeBlocking<ElementType>::Tile;
+template <typename ElementType> const size_t TransposeBlocking<ElementType>::Alignment;
+
+namespace Details
+{
+inline size_t TransposeSplit(size_t count, size_t alignment)
+{
+   const size_t half = (count / 2 + alignment - 1) / alignment * alignment;
+   return (half < count) ? half : count / 2;
+}
+
+// Exchanges A (rowCount x columnCount at a) and B (columnCount x rowCount at b) through transposition: A = B^T, B = A^T
+template <typename ElementType>
+void SwapTransposed(size_t rowCount, size_t columnCount, ElementType* a, ElementType* b, size_t stride)
+{
+   const size_t tile = TransposeBlocking<ElementType>::Tile;
+   if (rowCount <= tile && columnCount <= tile)
+   {
+      ElementType buffer[TransposeBlocking<ElementType>::Tile * TransposeBlocking<ElementType>::Tile];
+      TransposeTile(a, stride, buffer, rowCount, rowCount, columnCount);
+      TransposeTile(b, stride, a, stride, columnCount, rowCount);
+      for (size_t row = 0; row < columnCount; ++row)
+      {
+         std::copy(&buffer[row * rowCount], &buffer[(row + 1) * rowCount], &b[row * stride]);
+      }
+      return;
+   }
+   const size_t alignment = TransposeBlocking<ElementType>::Alignment;
+   if (rowCount >= columnCount)
+   {
+      const size_t split = TransposeSplit(rowCount, alignment);
+      SwapTransposed(split, columnCount, a, b, stride);
+      SwapTransposed(rowCount - split, columnCount, a + split * stride, b + split, stride);
+   }
+   else
+   {
+      const size_t split = TransposeSplit(columnCount, alignment);
+      SwapTransposed(rowCount, split, a, b, stride);
+      SwapTransposed(rowCount, columnCount - split, a + split, b + split * stride, stride);
+   }
+}
+} // namespace Details
+
+// destination (columnCount x rowCount) = transposed source (rowCount x columnCount)
+template <typename ElementType>
+void Transpose(size_t rowCount, size_t columnCount, const ElementType* source, size_t sourceStride, ElementType* destination, size_t destinationStride)
+{
+   const size_t tile = TransposeBlocking<ElementType>::Tile;
+   if (rowCount <= tile && columnCount <= tile)
+   {
+      TransposeTile(source, sourceStride, destination, destinationStride, rowCount, columnCount);
+      return;
+   }
+   const size_t alignment = TransposeBlocking<ElementType>::Alignment;
+   if (rowCount >= columnCount)
+   {
+      const size_t split = Details::TransposeSplit(rowCount, alignment);
+      Transpose(split, columnCount, source, sourceStride, destination, destinationStride);
+      Transpose(rowCount - split, columnCount, source + split * sourceStride, sourceStride, destination + split, destinationStride);
+   }
+   else
+   {
+      const size_t split = Details::TransposeSplit(columnCount, alignment);
+      Transpose(rowCount, split, source, sourceStride, destination, destinationStride);
+      Transpose(rowCount, columnCount - split, source + split, sourceStride, destination + split * destinationStride, destinationStride);
+   }
+}
+
+// In-place transposition of the square matrix: diagonal blocks are transposed recursively, off-diagonal blocks are
+// exchanged with the transposes of each other
+template <typename ElementType>
+void TransposeSquareInPlace(size_t size, ElementType* data, size_t stride)
+{
+   if (size <= TransposeBlocking<ElementType>::Tile)
+   {
+      for (size_t row = 0; row < size; ++row)
+      {
+         for (size_t column = row + 1; column < size; ++column)
+         {
+            std::swap(data[row * stride + column], data[column * stride + row]);
+         }
+      }
+      return;
+   }
+   const size_t split = Details::TransposeSplit(size, TransposeBlocking<ElementType>::Alignment);
+   TransposeSquareInPlace(split, data, stride);
+   TransposeSquareInPlace(size - split, data + split * stride + split, stride);
+   Details::SwapTransposed(split, size - split, data + split, data + split * stride, stride);
+}
+
+// In-place transposition of the dense row-major rowCount x columnCount matrix; the result is columnCount x rowCount.
+// Non-square matrices are transposed by following permutation cycles (one bit of extra memory per element):
+// the element at position p (except the last one) moves to position p * rowCount mod (rowCount * columnCount - 1).
+template <typename ElementType>
+void TransposeInPlace(size_t rowCount, size_t columnCount, ElementType* data)
+{
+   if (rowCount == columnCount)
+   {
+      TransposeSquareInPlace(rowCount, data, columnCount);
+      return;
+   }
+   const size_t count = rowCount * columnCount;
+   if (rowCount <= 1 || columnCount <= 1)
+   {
+      return;
+   }
+   const std::uint64_t modulus = count - 1;
+   std::vector<bool> visited(count, false);
+   for (size_t start = 1; start < modulus; ++start)
+   {
+      if (visited[start])
+      {
+         continue;
+      }
+      ElementType moved = data[start];
+      size_t position = start;
+      do
+      {
+         const size_t next = static_cast<size_t>(static_cast<std::uint64_t>(position) * rowCount % modulus);
+         std::swap(data[next], moved);
+         visited[position] = true;
+         position = next;
+      } while (position != start);
+   }
+}
+
+} // namespace Kernels
+} // namespace SMT
+
+#endif // __MATRIX_KERNELS_H__
\ No newline at end of file
@@ -0,0 +1,371 @@
+#ifndef __MATRIX_MEMORY_H__
+#define __MATRIX_MEMORY_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory of matrix elements (memory resources and buffers)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory resource.
+// Matrices allocate their elements through it (like std::pmr::memory_resource, which isn't available in C++14).
+// Deallocate() gets the same size and alignment which have been passed to Allocate().
+class MemoryResource
+{
+public:
+   // Alignment of matrix buffers: a cache line, which is enough for every SIMD instruction set (up to AVX-512)
+   static const size_t CacheLineAlignment = 64;
+
+   virtual ~MemoryResource() {}
+   // Returns nullptr if there is no memory
+   virtual void* Allocate(size_t bytes, size_t alignment) = 0;
+   virtual void Deallocate(void* pointer, size_t bytes, size_t alignment) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Aligned memory resource.
+// Memory is taken from the heap with an arbitrary (power of two) alignment: a larger block is allocated and the
+// pointer to it is kept right before the aligned address.
+class AlignedMemoryResource : public MemoryResource
+{
+public:
+   virtual void* Allocate(size_t bytes, size_t alignment) override
+   {
+      assert((alignment & (alignment - 1)) == 0);
+      alignment = std::max(alignment, sizeof(void*));
+      void* block = std::malloc(bytes + alignment + sizeof(void*));
+      if (block == nullptr)
+      {
+         return nullptr;
+      }
+      const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block) + sizeof(void*);
+      void* pointer = reinterpret_cast<void*>((address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1));
+      static_cast<void**>(pointer)[-1] = block;
+      return pointer;
+   }
+   virtual void Deallocate(void* pointer, size_t /*bytes*/, size_t /*alignment*/) override
+   {
+      if (pointer != nullptr)
+      {
+         std::free(static_cast<void**>(pointer)[-1]);
+      }
+   }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pool memory resource.
+// Freed buffers are kept and given out again instead of returning them to the upstream resource, so loops which
+// create temporary matrices of the same sizes don't call the heap (and don't touch new pages) on every iteration.
+// Sizes are rounded up to size classes (four classes between powers of two, so at most 25% of memory is wasted).
+// Buffers are allocated with the cache line alignment at least (larger alignments go to the upstream resource directly).
+// It is thread-safe. Free buffers are returned to the upstream resource by Release() and by the destructor, so the
+// pool has to outlive all matrices which have been created with it.
+class PoolMemoryResource : public MemoryResource
+{
+public:
+   static const size_t MinClassBytes = 256;
+
+   // maxCachedBytes limits free buffers which are kept (a freed buffer over the limit is returned to upstream)
+   explicit PoolMemoryResource(MemoryResource& upstream, size_t maxCachedBytes = static_cast<size_t>(-1))
+      : upstream_(upstream)
+      , maxCachedBytes_(maxCachedBytes)
+   {
+   }
+   PoolMemoryResource(const PoolMemoryResource&) = delete;
+   PoolMemoryResource& operator=(const PoolMemoryResource&) = delete;
+   virtual ~PoolMemoryResource() { Release(); }
+
+   // Size of the buffer which is allocated for the request of the given size
+   static size_t ClassBytes(size_t bytes)
+   {
+      if (bytes <= MinClassBytes)
+      {
+         return MinClassBytes;
+      }
+      size_t power = MinClassBytes;
+      while (power * 2 <= bytes)
+      {
+         power *= 2;
+      }
+      const size_t step = power / 4;
+      return (bytes + step - 1) / step * step;
+   }
+
+   virtual void* Allocate(size_t bytes, size_t alignment) override
+   {
+      if (alignment > CacheLineAlignment)
+      {
+         return upstream_.Allocate(bytes, alignment);
+      }
+      const size_t classBytes = ClassBytes(bytes);
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         auto& buffers = freeBuffers_[classBytes];
+         if (!buffers.empty())
+         {
+            void* pointer = buffers.back();
+            buffers.pop_back();
+            cachedBytes_ -= classBytes;
+            ++hitCount_;
+            return pointer;
+         }
+         ++missCount_;
+      }
+      return upstream_.Allocate(classBytes, CacheLineAlignment);
+   }
+   virtual void Deallocate(void* pointer, size_t bytes, size_t alignment) override
+   {
+      if (pointer == nullptr)
+      {
+         return;
+      }
+      if (alignment > CacheLineAlignment)
+      {
+         upstream_.Deallocate(pointer, bytes, alignment);
+         return;
+      }
+      const size_t classBytes = ClassBytes(bytes);
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         if (cachedBytes_ + classBytes <= maxCachedBytes_)
+         {
+            freeBuffers_[classBytes].push_back(pointer);
+            cachedBytes_ += classBytes;
+            return;
+         }
+      }
+      upstream_.Deallocate(pointer, classBytes, CacheLineAlignment);
+   }
+
+   // Returns all free buffers to the upstream resource
+   void Release()
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& buffers : freeBuffers_)
+      {
+         for (void* pointer : buffers.second)
+         {
+            upstream_.Deallocate(pointer, buffers.first, CacheLineAlignment);
+         }
+      }
+      freeBuffers_.clear();
+      cachedBytes_ = 0;
+   }
+
+   // Statistics: allocations which have reused a free buffer and allocations which have gone to upstream
+   size_t HitCount() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return hitCount_;
+   }
+   size_t MissCount() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return missCount_;
+   }
+   // Bytes of free buffers which are kept
+   size_t CachedBytes() const
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return cachedBytes_;
+   }
+
+private:
+   MemoryResource& upstream_;
+   const size_t maxCachedBytes_;
+   mutable std::mutex mutex_;
+   std::unordered_map<size_t, std::vector<void*>> freeBuffers_;   // Class size -> free buffers
+   size_t cachedBytes_ = 0;
+   size_t hitCount_ = 0;
+   size_t missCount_ = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory settings
+namespace MemorySettings
+{
+namespace Details
+{
+inline AlignedMemoryResource& AlignedResource()
+{
+   static AlignedMemoryResource resource;
+   return resource;
+}
+inline MemoryResource*& DefaultResourceRef()
+{
+   static MemoryResource* resource = &AlignedResource();
+   return resource;
+}
+} // namespace Details
+
+// The resource which is used by matrices which are created without a resource (including results of operations).
+// It is the aligned heap by default. A pool can be set for a solver loop, but it has to outlive the matrices.
+inline MemoryResource& DefaultResource() { return *Details::DefaultResourceRef(); }
+// nullptr restores the aligned heap
+inline void SetDefaultResource(MemoryResource* resource) { Details::DefaultResourceRef() = (resource != nullptr) ? resource : &Details::AlignedResource(); }
+} // namespace MemorySettings
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Matrix buffer.
+// A fixed-size array of elements in one allocation of a memory resource, aligned to the cache line.
+// The resource is remembered, so the buffer is freed to the same resource whatever the default resource is then.
+// Elements of a std::vector can be adopted without copying (they keep the alignment of the vector then), so data can
+// be passed into a matrix and taken back from it without copies.
+template <typename ElementType>
+class MatrixBuffer
+{
+public:
+   // An empty buffer (e.g. of a matrix which uses external data)
+   MatrixBuffer() noexcept
+      : data_(nullptr)
+      , size_(0)
+      , resource_(nullptr)
+   {
+   }
+   // Elements are default-initialized (so numbers aren't written twice if the caller fills the whole buffer anyway)
+   MatrixBuffer(size_t size, MemoryResource* resource)
+      : MatrixBuffer()
+   {
+      allocate(size, resource);
+      if (!std::is_trivially_default_constructible<ElementType>::value)
+      {
+         construct([](ElementType* element) { new (element) ElementType; });
+      }
+   }
+   MatrixBuffer(size_t size, const ElementType& value, MemoryResource* resource)
+      : MatrixBuffer()
+   {
+      allocate(size, resource);
+      construct([&value](ElementType* element) { new (element) ElementType(value); });
+   }
+   // Adopts elements of the vector (Resource() is nullptr then)
+   explicit MatrixBuffer(std::vector<ElementType>&& elements)
+      : MatrixBuffer()
+   {
+      vector_.swap(elements);
+      data_ = vector_.empty() ? nullptr : vector_.data();
+      size_ = vector_.size();
+   }
+   // The copy uses the same resource (the default one for adopted elements)
+   MatrixBuffer(const MatrixBuffer& buffer)
+      : MatrixBuffer()
+   {
+      if (buffer.data_ != nullptr)
+      {
+         allocate(buffer.size_, buffer.resource_);
+         const ElementType* source = buffer.data_;
+         construct([&source](ElementType* element) { new (element) ElementType(*source++); });
+      }
+   }
+   MatrixBuffer(MatrixBuffer&& buffer) noexcept
+      : MatrixBuffer()
+   {
+      swap(buffer);
+   }
+   MatrixBuffer& operator=(MatrixBuffer buffer) noexcept
+   {
+      swap(buffer);
+      return *this;
+   }
+   ~MatrixBuffer() { reset(); }
+
+   ElementType* Data() { return data_; }
+   const ElementType* Data() const { return data_; }
+   size_t Size() const { return size_; }
+   bool Empty() const { return data_ == nullptr; }
+   MemoryResource* Resource() const { return resource_; }
+
+   // Returns elements as a vector and leaves the buffer empty. Adopted elements are moved, others are copied.
+   std::vector<ElementType> ReleaseVector()
+   {
+      std::vector<ElementType> elements;
+      if (resource_ == nullptr)
+      {
+         elements.swap(vector_);
+         data_ = nullptr;
+         size_ = 0;
+         return elements;
+      }
+      elements.assign(data_, data_ + size_);
+      reset();
+      return elements;
+   }
+
+private:
+   ElementType* data_;
+   size_t size_;
+   MemoryResource* resource_;                   // nullptr if elements are adopted from vector_
+   std::vector<ElementType> vector_;
+
+   static size_t byteCount(size_t size) { return std::max<size_t>(1, size) * sizeof(ElementType); }
+
+   void allocate(size_t size, MemoryResource* resource)
+   {
+      resource_ = (resource != nullptr) ? resource : &MemorySettings::DefaultResource();
+      data_ = static_cast<ElementType*>(resource_->Allocate(byteCount(size), MemoryResource::CacheLineAlignment));
+      if (data_ == nullptr)
+      {
+         throw std::bad_alloc();
+      }
+      size_ = size;
+   }
+
+   template <typename ConstructFunc>
+   void construct(ConstructFunc constructElement)
+   {
+      for (size_t index = 0; index < size_; ++index)
+      {
+         constructElement(&data_[index]);
+      }
+   }
+
+   void reset()
+   {
+      if (data_ == nullptr)
+      {
+         return;
+      }
+      if (resource_ == nullptr)
+      {
+         std::vector<ElementType>().swap(vector_);
+         data_ = nullptr;
+         size_ = 0;
+         return;
+      }
+      if (!std::is_trivially_destructible<ElementType>::value)
+      {
+         for (size_t index = 0; index < size_; ++index)
+         {
+            data_[index].~ElementType();
+         }
+      }
+      resource_->Deallocate(data_, byteCount(size_), MemoryResource::CacheLineAlignment);
+      data_ = nullptr;
+      size_ = 0;
+   }
+
+   void swap(MatrixBuffer& buffer) noexcept
+   {
+      std::swap(data_, buffer.data_);
+      std::swap(size_, buffer.size_);
+      std::swap(resource_, buffer.resource_);
+      vector_.swap(buffer.vector_);
+   }
+};
+
+} // namespace SMT
+
+#endif // __MATRIX_MEMORY_H__
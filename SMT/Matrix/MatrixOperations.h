@@ -6,56 +6,22 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
+#include "MatrixChecks.h"
 #include "MatrixDefs.h"
+#include "MatrixPlanner.h"
 #include "StandardMatrix.h"
 
 namespace SMT
 {
-
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// -- Functions that check if we can do some actions
-// Standard checks
-template <typename ElementType>
-void CheckIfCanAddTogether(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2, 
-   /*out*/ typename OperationResultCode& code, /*out*/ std::string& description)
-{
-   if (matrix1.RowCount() != matrix2.RowCount())
-   {
-      code = OperationResultCode::Error;
-      description = "Matrices that are added together have a different number of rows.";
-      return;
-   }
-   if (matrix1.ColumnCount() != matrix2.ColumnCount())
-   {
-      code = OperationResultCode::Error;
-      description = "Matrices that are added together have a different number of columns.";
-      return;
-   }
-   code = OperationResultCode::Ok;
-   description.clear();
-}
-
-template <typename ElementType>
-void CheckIfCanMultiplyTogether(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, 
-   /*out*/ typename OperationResultCode& code, /*out*/ std::string& description)
-{
-   if (leftMatrix.ColumnCount() != rightMatrix.RowCount())
-   {
-      code = OperationResultCode::Error;
-      description = "Matrices that are multiplyed together have a wrong number of column and rows: the left matrix has " + std::to_string(leftMatrix.ColumnCount()) + " column(s), the right matrix has " + std::to_string(rightMatrix.RowCount()) + " row(s)";
-      return;
-   }
-   code = OperationResultCode::Ok;
-   description.clear();
-}	   
-
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // -- Operations
 template <typename ElementType>
 typename Matrix<ElementType>::OperationResult Copy(const Matrix<ElementType>& matrix)
 {
-   Matrix<ElementType>::OperationResult result = matrix.Copy();
+   typename Matrix<ElementType>::OperationResult result = matrix.Copy();
    if (result.Code_ == OperationResultCode::NotImplemented)
    {
       result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(matrix);
@@ -69,33 +35,40 @@ typename Matrix<ElementType>::OperationResult Copy(const Matrix<ElementType>& ma
    return result;
 }
 
+// The execution is chosen by the cost model (see MatrixPlanner.h): the cheapest plan is tried first, the next one is
+// tried if a matrix doesn't implement the operation for this pair of matrices.
 template <typename ElementType>
 typename Matrix<ElementType>::OperationResult Add(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
 {
-   const Complexity::Type matrix1Complexity = matrix1.AdditionComplexity(matrix2);
-   const Complexity::Type matrix2Complexity = matrix2.AdditionComplexity(matrix1);
-	const Complexity::Type bestComplexity = std::max<Complexity::Type>(matrix1Complexity, matrix2Complexity);
-	if (bestComplexity < Complexity::Max)
-	{	
-      const Matrix<ElementType>& mainMatrix = (matrix1Complexity <= matrix2Complexity) ? matrix1 : matrix2;
-      const Matrix<ElementType>& addedMatrix = (matrix1Complexity <= matrix2Complexity) ? matrix2 : matrix1;
-      Matrix<ElementType>::OperationResult result = mainMatrix.Add(addedMatrix);
+   typename Matrix<ElementType>::OperationResult result;
+   for (const Planner::Plan& plan : Planner::AdditionPlans(matrix1, matrix2))
+   {
+      if (plan.Strategy_ == Planner::Strategy::ConvertThenKernel)
+      {
+         StandardMatrix<ElementType> standardMatrixCopy(matrix1);
+         result = standardMatrixCopy.Add(matrix2);
+         if (result.Code_ == OperationResultCode::Ok)
+         {
+            result.Code_ = OperationResultCode::Warning;
+            result.Description_ = "Matrices (1st matrix type :" + matrix1.TypeName() + ", 2nd matrix type:" + matrix2.TypeName() + ") are added together by plan: " + plan.Description_ + ". Standard matrix (type:" + standardMatrixCopy.TypeName() + ") is used instead";
+         }
+         return result;
+      }
+      const Matrix<ElementType>& mainMatrix = (plan.Strategy_ == Planner::Strategy::NativeFirst) ? matrix1 : matrix2;
+      const Matrix<ElementType>& addedMatrix = (plan.Strategy_ == Planner::Strategy::NativeFirst) ? matrix2 : matrix1;
+      result = mainMatrix.Add(addedMatrix);
       if ((result.Code_ == OperationResultCode::Ok || result.Code_ == OperationResultCode::Warning) && (result.Matrix_ != nullptr))
       {
          if (result.Description_.empty())
          {
-            result.Description_ = "Matrices (1st matrix type :" + matrix1.TypeName() + ", 2nd matrix type:" + matrix2.TypeName() + ") are added together";
+            result.Description_ = "Matrices (1st matrix type :" + matrix1.TypeName() + ", 2nd matrix type:" + matrix2.TypeName() + ") are added together by plan: " + plan.Description_;
          }
          return result;
       }
-   }
-   StandardMatrix<double> standardMatrixCopy(matrix1);
-   Matrix<ElementType>::OperationResult result = standardMatrixCopy.Add(matrix2);
-   if (result.Code_ == OperationResultCode::Ok)
-   {
-      result.Code_ = OperationResultCode::Warning;
-      if (!result.Description_.empty())
-         result.Description_ = "Matrices (1st matrix type :" + matrix1.TypeName() + ", 2nd matrix type:" + matrix2.TypeName() + ") can't be added together.  Standard matrix (type:" + standardMatrixCopy.TypeName() + ") is used instead";
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
    }
    return result;
 }
@@ -103,7 +76,7 @@ typename Matrix<ElementType>::OperationResult Add(const Matrix<ElementType>& mat
 template <typename ElementType>
 typename Matrix<ElementType>::OperationResult MultiplyByNumber(const Matrix<ElementType>& matrix, const ElementType& number)
 {
-   Matrix<ElementType>::OperationResult result = matrix.MultiplyByNumber(number);
+   typename Matrix<ElementType>::OperationResult result = matrix.MultiplyByNumber(number);
    if (result.Code_ == OperationResultCode::NotImplemented)
    {
       const StandardMatrix<ElementType> standardMatrixCopy(matrix);
@@ -123,42 +96,243 @@ typename Matrix<ElementType>::OperationResult MultiplyByNumber(const Matrix<Elem
    return result;
 }
 
+// The execution is chosen by the cost model like in Add()
 template <typename ElementType>
 typename Matrix<ElementType>::OperationResult Multiply(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix)
 {
-   const Complexity::Type leftMatrixComplexity = leftMatrix.MultiplyComplexity(rightMatrix, false);
-   const Complexity::Type rightMatrixComplexity = rightMatrix.MultiplyComplexity(leftMatrix, true);
-   const Complexity::Type bestComplexity = std::max<Complexity::Type>(leftMatrixComplexity, rightMatrixComplexity);
-   if (bestComplexity < Complexity::Max)
+   typename Matrix<ElementType>::OperationResult result;
+   // Every element of the left matrix is used by every column of the right one (and vice versa), so operands which
+   // compute their elements may keep them before the plans are estimated
+   if (leftMatrix.ColumnCount() == rightMatrix.RowCount())
+   {
+      leftMatrix.PrepareForReuse(rightMatrix.ColumnCount());
+      rightMatrix.PrepareForReuse(leftMatrix.RowCount());
+   }
+   for (const Planner::Plan& plan : Planner::MultiplicationPlans(leftMatrix, rightMatrix))
    {
-      const Matrix<ElementType>& mainMatrix = (leftMatrixComplexity <= rightMatrixComplexity) ? leftMatrix : rightMatrix;
-      const Matrix<ElementType>& anotherMatrix = (leftMatrixComplexity <= rightMatrixComplexity) ? rightMatrix : leftMatrix;
-      const bool anotherMatrixIsOnTheLeft = (leftMatrixComplexity < rightMatrixComplexity);
-      Matrix<ElementType>::OperationResult result = mainMatrix.Multiply(anotherMatrix, anotherMatrixIsOnTheLeft);
+      if (plan.Strategy_ == Planner::Strategy::ConvertThenKernel)
+      {
+         StandardMatrix<ElementType> standardMatrixCopy(leftMatrix);
+         result = standardMatrixCopy.Multiply(rightMatrix, false);
+         if (result.Code_ == OperationResultCode::Ok)
+         {
+            result.Code_ = OperationResultCode::Warning;
+            result.Description_ = "Matrices (1st matrix type :" + leftMatrix.TypeName() + ", 2nd matrix type:" + rightMatrix.TypeName() + ") are multiplied by plan: " + plan.Description_ + ". Standard matrix (type:" + standardMatrixCopy.TypeName() + ") is used instead";
+         }
+         return result;
+      }
+      const bool leftMatrixIsMain = (plan.Strategy_ == Planner::Strategy::NativeFirst);
+      const Matrix<ElementType>& mainMatrix = leftMatrixIsMain ? leftMatrix : rightMatrix;
+      const Matrix<ElementType>& anotherMatrix = leftMatrixIsMain ? rightMatrix : leftMatrix;
+      result = mainMatrix.Multiply(anotherMatrix, !leftMatrixIsMain);
       if ((result.Code_ == OperationResultCode::Ok || result.Code_ == OperationResultCode::Warning) && (result.Matrix_ != nullptr))
       {
          if (result.Description_.empty())
          {
-            result.Description_ = "Matrices (1st matrix type :" + mainMatrix.TypeName() + ", 2nd matrix type:" + anotherMatrix.TypeName() + ") are multiplied";
+            result.Description_ = "Matrices (1st matrix type :" + leftMatrix.TypeName() + ", 2nd matrix type:" + rightMatrix.TypeName() + ") are multiplied by plan: " + plan.Description_;
          }
          return result;
       }
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+   }
+   return result;
+}
+
+// Options of Multiply()
+struct MultiplyOptions
+{
+   enum class Algorithm
+   {
+      Default,                                  // The plan of the cost model (the GEMM kernel for dense matrices)
+      StrassenWinograd,                         // Strassen-Winograd recursion over the GEMM kernel for large dense products
+   };
+   static const size_t DefaultCrossoverSize = 1024;
+
+   Algorithm Algorithm_ = Algorithm::Default;
+   size_t CrossoverSize_ = DefaultCrossoverSize; // Products are split while all dimensions are greater than it
+   MemoryResource* Workspace_ = nullptr;        // Temporary blocks (the default resource if nullptr)
+};
+
+// The product with options. Strassen-Winograd has a weaker (normwise) error bound than GEMM, so it is used only if it
+// is requested (see Kernels::StrassenWinogradGemm()), and only for dense operands (matrices which multiply by the
+// cubic kernel anyway) whose dimensions are greater than the crossover size. Other products are Multiply().
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult Multiply(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, const MultiplyOptions& options)
+{
+   const bool denseOperands = (leftMatrix.MultiplyComplexity(rightMatrix, false) >= Complexity::Cubic) && (rightMatrix.MultiplyComplexity(leftMatrix, true) >= Complexity::Cubic);
+   if ((options.Algorithm_ == MultiplyOptions::Algorithm::StrassenWinograd) && denseOperands && (leftMatrix.ColumnCount() == rightMatrix.RowCount()) &&
+      Kernels::Details::StrassenWinogradSplits(leftMatrix.RowCount(), rightMatrix.ColumnCount(), leftMatrix.ColumnCount(), options.CrossoverSize_))
+   {
+      typename Matrix<ElementType>::OperationResult result = StandardMatrix<ElementType>::MultiplyStrassenWinograd(leftMatrix, rightMatrix, options.CrossoverSize_, options.Workspace_);
+      if ((result.Code_ == OperationResultCode::Ok) && (result.Matrix_ != nullptr))
+      {
+         result.Description_ = "Matrices (1st matrix type :" + leftMatrix.TypeName() + ", 2nd matrix type:" + rightMatrix.TypeName() + ") are multiplied by the Strassen-Winograd algorithm";
+      }
+      return result;
+   }
+   return Multiply(leftMatrix, rightMatrix);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Product of a chain of matrices: matrices[0] * matrices[1] * ... * matrices[k - 1]
+//    The order of multiplications is chosen by dynamic programming: the cost of every sub-chain is the cheapest split
+//    into two sub-chains plus the estimated time of their product (see MatrixPlanner.h). Operands of the chain are
+//    charged for reading (so a function matrix costs more than a standard one of the same size).
+//    Two sub-chains of a split don't depend on each other, so they are computed concurrently by the library thread pool.
+namespace Details
+{
+template <typename ElementType>
+class MatrixChain
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+
+   explicit MatrixChain(const std::vector<const Matrix<ElementType>*>& matrices)
+      : matrices_(matrices)
+      , count_(matrices.size())
+      , seconds_(count_ * count_, 0.0)
+      , splits_(count_ * count_, 0)
+   {
+   }
+
+   // Fills the table of the cheapest splits: O(k^3) for k matrices
+   void Optimize()
+   {
+      std::vector<double> readSeconds(count_);
+      for (size_t i = 0; i < count_; ++i)
+      {
+         readSeconds[i] = Planner::ReadSeconds(*matrices_[i]);
+      }
+      for (size_t length = 2; length <= count_; ++length)
+      {
+         for (size_t first = 0; first + length <= count_; ++first)
+         {
+            const size_t last = first + length - 1;
+            const size_t rowCount = matrices_[first]->RowCount();
+            const size_t columnCount = matrices_[last]->ColumnCount();
+            double bestSeconds = 0.0;
+            for (size_t split = first; split < last; ++split)
+            {
+               const size_t innerCount = matrices_[split]->ColumnCount();
+               double seconds = seconds_[first * count_ + split] + seconds_[(split + 1) * count_ + last]
+                  + Planner::GemmSeconds<ElementType>(rowCount, columnCount, innerCount) + Planner::WriteSeconds<ElementType>(rowCount, columnCount);
+               seconds += (split == first) ? readSeconds[first] : 0.0;
+               seconds += (split + 1 == last) ? readSeconds[last] : 0.0;
+               if (split == first || seconds < bestSeconds)
+               {
+                  bestSeconds = seconds;
+                  splits_[first * count_ + last] = split;
+               }
+            }
+            seconds_[first * count_ + last] = bestSeconds;
+         }
+      }
    }
-   StandardMatrix<double> standardMatrixCopy(leftMatrix);
-   Matrix<ElementType>::OperationResult result = standardMatrixCopy.Multiply(rightMatrix, false);
-   if (result.Code_ == OperationResultCode::Ok)
+
+   // Estimated time of the whole chain
+   double Seconds() const { return seconds_[count_ - 1]; }
+
+   // The order of multiplications, e.g. "((0 1) 2)"
+   std::string Order(size_t first, size_t last) const
    {
-      result.Code_ = OperationResultCode::Warning;
-      if (result.Description_.empty())
-         result.Description_ = "Matrices (1st matrix type :" + leftMatrix.TypeName() + ", 2nd matrix type:" + rightMatrix.TypeName() + ") can't be multiplied together.  Standard matrix (type:" + standardMatrixCopy.TypeName() + ") is used instead";
+      if (first == last)
+      {
+         return std::to_string(first);
+      }
+      const size_t split = splits_[first * count_ + last];
+      return "(" + Order(first, split) + " " + Order(split + 1, last) + ")";
+   }
+
+   OperationResult Evaluate(size_t first, size_t last) const
+   {
+      if (first == last)
+      {
+         OperationResult result;
+         result.Code_ = OperationResultCode::Ok;
+         return result;                         // Matrix_ == nullptr: the operand itself is used
+      }
+      const size_t split = splits_[first * count_ + last];
+      OperationResult results[2];
+      const size_t bounds[2][2] = { { first, split }, { split + 1, last } };
+      auto evaluatePart = [this, &results, &bounds](size_t part) { results[part] = Evaluate(bounds[part][0], bounds[part][1]); };
+      if (split > first && split + 1 < last)
+      {
+         ParallelSettings::Pool().ParallelFor(2, evaluatePart);
+      }
+      else
+      {
+         evaluatePart(0);
+         evaluatePart(1);
+      }
+      for (const OperationResult& result : results)
+      {
+         if (result.Code_ == OperationResultCode::Error || result.Code_ == OperationResultCode::NotImplemented)
+         {
+            return result;
+         }
+      }
+      const Matrix<ElementType>& leftMatrix = (results[0].Matrix_ != nullptr) ? *results[0].Matrix_ : *matrices_[first];
+      const Matrix<ElementType>& rightMatrix = (results[1].Matrix_ != nullptr) ? *results[1].Matrix_ : *matrices_[last];
+      return Multiply(leftMatrix, rightMatrix);
+   }
+
+private:
+   const std::vector<const Matrix<ElementType>*>& matrices_;
+   const size_t count_;
+   std::vector<double> seconds_;                // seconds_[first * count_ + last]: the cheapest time of the sub-chain
+   std::vector<size_t> splits_;                 // splits_[first * count_ + last]: the last matrix of the left part
+};
+} // namespace Details
+
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult MultiplyChain(const std::vector<const Matrix<ElementType>*>& matrices)
+{
+   typename Matrix<ElementType>::OperationResult result;
+   if (matrices.empty() || std::find(matrices.begin(), matrices.end(), nullptr) != matrices.end())
+   {
+      result.Code_ = OperationResultCode::Error;
+      result.Description_ = "Chain of matrices can't be multiplied: it is empty or contains nullptr";
+      return result;
+   }
+   for (size_t i = 0; i + 1 < matrices.size(); ++i)
+   {
+      CheckIfCanMultiplyTogether(*matrices[i], *matrices[i + 1], result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         result.Description_ += " (matrices #" + std::to_string(i) + " and #" + std::to_string(i + 1) + " of the chain)";
+         return result;
+      }
+   }
+   if (matrices.size() == 1)
+   {
+      return Copy(*matrices[0]);
+   }
+
+   Details::MatrixChain<ElementType> chain(matrices);
+   chain.Optimize();
+   result = chain.Evaluate(0, matrices.size() - 1);
+   if ((result.Code_ == OperationResultCode::Ok || result.Code_ == OperationResultCode::Warning) && (result.Matrix_ != nullptr))
+   {
+      result.Description_ = "Chain of " + std::to_string(matrices.size()) + " matrices is multiplied in order " + chain.Order(0, matrices.size() - 1);
    }
    return result;
 }
 
+// MultiplyChain(a, b, c, ...)
+template <typename ElementType, typename... OtherMatrices>
+typename Matrix<ElementType>::OperationResult MultiplyChain(const Matrix<ElementType>& firstMatrix, const OtherMatrices&... otherMatrices)
+{
+   const std::vector<const Matrix<ElementType>*> matrices = { &firstMatrix, static_cast<const Matrix<ElementType>*>(&otherMatrices)... };
+   return MultiplyChain(matrices);
+}
+
 template <typename ElementType>
 typename Matrix<ElementType>::OperationResult Invert(const Matrix<ElementType>& matrix)
 {
-   Matrix<ElementType>::OperationResult result = matrix.Invert();
+   typename Matrix<ElementType>::OperationResult result = matrix.Invert();
    if (result.Code_ == OperationResultCode::NotImplemented)
    {
       const StandardMatrix<ElementType> standardMatrix(matrix);
@@ -175,7 +349,7 @@ typename Matrix<ElementType>::OperationResult Invert(const Matrix<ElementType>&
 template <typename ElementType>
 typename Matrix<ElementType>::OperationResult Transpose(const Matrix<ElementType>& matrix)
 {
-   Matrix<ElementType>::OperationResult result = matrix.Transpose();
+   typename Matrix<ElementType>::OperationResult result = matrix.Transpose();
    if (result.Code_ == OperationResultCode::NotImplemented)
    {
       const StandardMatrix<ElementType> standardMatrix(matrix);
@@ -192,7 +366,7 @@ typename Matrix<ElementType>::OperationResult Transpose(const Matrix<ElementType
 template <typename ElementType>
 typename Matrix<ElementType>::ScalarOperationResult Determinant(const Matrix<ElementType>& matrix)
 {
-   Matrix<ElementType>::ScalarOperationResult result = matrix.Determinant();
+   typename Matrix<ElementType>::ScalarOperationResult result = matrix.Determinant();
    if (result.Code_ == OperationResultCode::NotImplemented)
    {
       const StandardMatrix<ElementType> standardMatrix(matrix);
@@ -206,61 +380,128 @@ typename Matrix<ElementType>::ScalarOperationResult Determinant(const Matrix<Ele
    return result;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// -- Functions that check matrix settings
-// Function moves through all elements and checks
+// X of the linear system matrix * X = rightHandSide.
+// The execution is chosen by the cost model like in Add(): the native solver of the matrix (e.g. banded LU) or LU of a
+// standard copy.
 template <typename ElementType>
-bool Check(const Matrix<ElementType>& matrix, bool(*predicate)(size_t column, size_t row, ElementType element))
+typename Matrix<ElementType>::OperationResult Solve(const Matrix<ElementType>& matrix, const Matrix<ElementType>& rightHandSide)
 {
-   if (!func)
+   typename Matrix<ElementType>::OperationResult result;
+   for (const Planner::Plan& plan : Planner::SolvingPlans(matrix, rightHandSide))
    {
-      return false;
-   }
-   const size_t rowCount = matrix.RowCount();
-   const size_t columnCount = matrix.ColumnCount();
-   for (size_t row = 0; row < rowCount; ++row)
-   {
-      for (size_t column = 0; column < columnCount; ++column)
+      if (plan.Strategy_ == Planner::Strategy::ConvertThenKernel)
+      {
+         const StandardMatrix<ElementType> standardMatrix(matrix);
+         result = standardMatrix.Solve(rightHandSide);
+         if (result.Code_ == OperationResultCode::Ok && result.Matrix_ != nullptr)
+         {
+            result.Code_ = OperationResultCode::Warning;
+            result.Description_ = "Linear system (matrix type:" + matrix.TypeName() + ") is solved by plan: " + plan.Description_ + ". Standard matrix (type:" + standardMatrix.TypeName() + ") is used instead";
+         }
+         return result;
+      }
+      result = matrix.Solve(rightHandSide);
+      if ((result.Code_ == OperationResultCode::Ok || result.Code_ == OperationResultCode::Warning) && (result.Matrix_ != nullptr))
       {
-         if (!predicate(row, count, matrix.Element(row, count)))
+         if (result.Description_.empty())
          {
-            return false;
+            result.Description_ = "Linear system (matrix type:" + matrix.TypeName() + ") is solved by plan: " + plan.Description_;
          }
-     }
+         return result;
+      }
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
    }
-   return true;
+   return result;
 }
 
-// Standard checks
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// -- Operations into an existing matrix
+//    The result is written into resultMatrix, which has to have the size of the result, so iterative algorithms don't
+//    allocate a matrix on every step. resultMatrix has to implement Matrix::IInPlaceOperations (standard and block
+//    matrices do), operands may be any matrices (including resultMatrix itself).
+namespace Details
+{
 template <typename ElementType>
-bool CheckIfIdentityMatrix(const Matrix<ElementType>& matrix)
+typename Matrix<ElementType>::IInPlaceOperations* InPlaceOperations(Matrix<ElementType>& resultMatrix, const std::string& operationName,
+   /*out*/ typename Matrix<ElementType>::OperationResult& result)
 {
-   auto isIdentityMatrixElement = [](size_t column, size_t row, ElementType element)
+   typename Matrix<ElementType>::IInPlaceOperations* operations = resultMatrix.InPlaceOperations();
+   if (operations == nullptr)
    {
-      const ElementType requiredElement = (column == row) ? MatrixSettings::One<ElementType>() : MatrixSettings::Zero<ElementType>();
-      return MatrixSettings<ElementType>::CanAssumeItIsZero(requiredElement - element);
-   };
-   return Check(matrix, isIdentityMatrixElement);
+      result.Code_ = OperationResultCode::NotImplemented;
+      result.Description_ = "Matrix (type:" + resultMatrix.TypeName() + ") can't hold the result of " + operationName + ": it has no in-place operations";
+   }
+   return operations;
 }
+} // namespace Details
+
+// resultMatrix += matrix
 template <typename ElementType>
-bool CheckIfZeroMatrix()
+typename Matrix<ElementType>::OperationResult AddInPlace(Matrix<ElementType>& resultMatrix, const Matrix<ElementType>& matrix)
 {
-   auto isZeroMatrixElement = [](size_t /*column*/, size_t /*row*/, ElementType element)
-   {
-      return MatrixSettings::CanAssumeItIsZero<ElementType>(element);
-   };
-   return Check(matrix, isZeroMatrixElement);
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "AddInPlace", result);
+   return (operations != nullptr) ? operations->AddInPlace(matrix) : result;
 }
+
+// resultMatrix *= number
 template <typename ElementType>
-bool CheckIfDiagonalMatrix()
+typename Matrix<ElementType>::OperationResult ScaleInPlace(Matrix<ElementType>& resultMatrix, const ElementType& number)
 {
-   auto isDiaginalMatrixElement = [](size_t column, size_t row, ElementType element)
-   {
-      return column == row ? true : MatrixSettings::CanAssumeItIsZero<ElementType>(element);
-   };
-   return Check(matrix, isDiaginalMatrixElement);
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "ScaleInPlace", result);
+   return (operations != nullptr) ? operations->ScaleInPlace(number) : result;
+}
+
+// resultMatrix = matrix
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult CopyInto(Matrix<ElementType>& resultMatrix, const Matrix<ElementType>& matrix)
+{
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "CopyInto", result);
+   return (operations != nullptr) ? operations->CopyFrom(matrix) : result;
+}
+
+// resultMatrix = matrix1 + matrix2
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult AddInto(Matrix<ElementType>& resultMatrix, const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
+{
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "AddInto", result);
+   return (operations != nullptr) ? operations->AddInto(matrix1, matrix2) : result;
+}
+
+// resultMatrix = alpha * leftMatrix * rightMatrix + beta * resultMatrix
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult MultiplyInto(Matrix<ElementType>& resultMatrix, const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix,
+   const ElementType& alpha = MatrixSettings::One<ElementType>(), const ElementType& beta = MatrixSettings::Zero<ElementType>())
+{
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "MultiplyInto", result);
+   return (operations != nullptr) ? operations->MultiplyInto(leftMatrix, rightMatrix, alpha, beta) : result;
+}
+
+// resultMatrix = transposed matrix
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult TransposeInto(Matrix<ElementType>& resultMatrix, const Matrix<ElementType>& matrix)
+{
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "TransposeInto", result);
+   return (operations != nullptr) ? operations->TransposeInto(matrix) : result;
+}
+
+// resultMatrix = inverse of the matrix
+template <typename ElementType>
+typename Matrix<ElementType>::OperationResult InvertInto(Matrix<ElementType>& resultMatrix, const Matrix<ElementType>& matrix)
+{
+   typename Matrix<ElementType>::OperationResult result;
+   auto operations = Details::InPlaceOperations(resultMatrix, "InvertInto", result);
+   return (operations != nullptr) ? operations->InvertInto(matrix) : result;
 }
 
 } // namespace SMT
 
-#endif __MATRIX_OPERATIONS_H__
\ No newline at end of file
+#endif // __MATRIX_OPERATIONS_H__
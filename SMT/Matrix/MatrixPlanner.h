@@ -0,0 +1,355 @@
+#ifndef __MATRIX_PLANNER_H__
+#define __MATRIX_PLANNER_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cost-model-driven planner of matrix operations
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixKernels.h"
+#include "../Threading/ThreadPool.h"
+
+namespace SMT
+{
+namespace Planner
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Per-machine constants of the cost model.
+// The defaults are typical for a desktop CPU. CalibrateAndSave() measures them and saves them to the calibration file, so
+// the measurement is done once per machine.
+struct MachineConstants
+{
+   double SecondsPerFlop_ = 1.0e-10;            // One multiply or add of the GEMM kernel (double precision, one thread)
+   double SecondsPerByte_ = 2.0e-10;            // Streaming memory access (read or write)
+   double SecondsPerCall_ = 3.0e-9;             // One indirect call (virtual method, std::function)
+};
+
+namespace Details
+{
+inline double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The best time of several runs
+inline double MeasureSeconds(const std::function<void()>& func, int runCount = 3)
+{
+   double best = 0.0;
+   for (int run = 0; run < runCount; ++run)
+   {
+      const auto start = std::chrono::steady_clock::now();
+      func();
+      const double seconds = SecondsSince(start);
+      best = (run == 0) ? seconds : std::min(best, seconds);
+   }
+   return best;
+}
+
+inline std::string& CalibrationFileRef()
+{
+   static std::string file;
+   return file;
+}
+} // namespace Details
+
+// Measures the constants by small benchmarks (it takes about 0.1 second)
+inline MachineConstants Calibrate()
+{
+   MachineConstants constants;
+
+   const size_t size = 192;
+   std::vector<double> a(size * size, 1.0);
+   std::vector<double> b(size * size, 0.5);
+   std::vector<double> c(size * size, 0.0);
+   const double gemmSeconds = Details::MeasureSeconds([&]()
+   {
+      Kernels::Gemm<double>(size, size, size, 1.0, a.data(), size, b.data(), size, 0.0, c.data(), size);
+   });
+   constants.SecondsPerFlop_ = gemmSeconds / (2.0 * size * size * size);
+
+   const size_t elementCount = 4 * 1024 * 1024;
+   std::vector<double> source(elementCount, 1.0);
+   std::vector<double> destination(elementCount, 0.0);
+   const double copySeconds = Details::MeasureSeconds([&]()
+   {
+      std::copy(source.begin(), source.end(), destination.begin());
+   });
+   constants.SecondsPerByte_ = copySeconds / (2.0 * elementCount * sizeof(double));
+
+   const size_t callCount = 1024 * 1024;
+   volatile size_t offset = 1;
+   std::function<double(size_t, size_t)> func = [&offset](size_t row, size_t column) { return static_cast<double>(row + column + offset); };
+   double sum = 0.0;
+   const double callSeconds = Details::MeasureSeconds([&]()
+   {
+      for (size_t i = 0; i < callCount; ++i)
+      {
+         sum += func(i, i);
+      }
+   });
+   constants.SecondsPerCall_ = callSeconds / callCount;
+   c[0] += destination[0] + sum;                // The results are used, so the benchmarks aren't optimized away
+   return constants;
+}
+
+// Text file with "name value" lines
+inline bool Save(const MachineConstants& constants, const std::string& file)
+{
+   std::ofstream stream(file);
+   if (!stream)
+   {
+      return false;
+   }
+   stream.precision(17);
+   stream << "SecondsPerFlop " << constants.SecondsPerFlop_ << "\n";
+   stream << "SecondsPerByte " << constants.SecondsPerByte_ << "\n";
+   stream << "SecondsPerCall " << constants.SecondsPerCall_ << "\n";
+   return static_cast<bool>(stream);
+}
+inline bool Load(const std::string& file, MachineConstants& constants)
+{
+   std::ifstream stream(file);
+   if (!stream)
+   {
+      return false;
+   }
+   MachineConstants loaded;
+   size_t loadedCount = 0;
+   std::string name;
+   double value = 0.0;
+   while (stream >> name >> value)
+   {
+      if (!(value > 0.0))
+      {
+         return false;
+      }
+      if (name == "SecondsPerFlop") { loaded.SecondsPerFlop_ = value; ++loadedCount; }
+      else if (name == "SecondsPerByte") { loaded.SecondsPerByte_ = value; ++loadedCount; }
+      else if (name == "SecondsPerCall") { loaded.SecondsPerCall_ = value; ++loadedCount; }
+   }
+   if (loadedCount != 3)
+   {
+      return false;
+   }
+   constants = loaded;
+   return true;
+}
+
+// The calibration file: SetCalibrationFile() or the SMT_CALIBRATION_FILE environment variable (empty if none is set)
+inline std::string CalibrationFile()
+{
+   if (!Details::CalibrationFileRef().empty())
+   {
+      return Details::CalibrationFileRef();
+   }
+   const char* file = std::getenv("SMT_CALIBRATION_FILE");
+   return (file != nullptr) ? std::string(file) : std::string();
+}
+inline void SetCalibrationFile(const std::string& file) { Details::CalibrationFileRef() = file; }
+
+namespace Details
+{
+// Initialized once (thread-safe): the constants of the calibration file if there is one, otherwise the defaults.
+// Nothing is measured and nothing is written here, so plans are reproducible.
+inline MachineConstants& ConstantsRef()
+{
+   static MachineConstants constants;
+   static std::once_flag initFlag;
+   std::call_once(initFlag, []()
+   {
+      const std::string file = CalibrationFile();
+      if (!file.empty())
+      {
+         Load(file, constants);
+      }
+   });
+   return constants;
+}
+} // namespace Details
+
+// The constants which are used by the planner. The setters aren't thread-safe (like ParallelSettings): they have to be
+// called before matrices are used by several threads.
+inline const MachineConstants& Constants() { return Details::ConstantsRef(); }
+inline void SetConstants(const MachineConstants& constants) { Details::ConstantsRef() = constants; }
+// Measures the machine, uses the measured constants and saves them to the calibration file (if it is set), so the next
+// runs load them. It is never called implicitly.
+inline bool CalibrateAndSave()
+{
+   SetConstants(Calibrate());
+   const std::string file = CalibrationFile();
+   return file.empty() || Save(Constants(), file);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Execution plans
+enum class Strategy
+{
+   NativeFirst,                                 // The operation of the first (left) matrix: matrix1.Add(matrix2), left.Multiply(right, false)
+   NativeSecond,                                // The operation of the second (right) matrix: matrix2.Add(matrix1), right.Multiply(left, true)
+   ConvertThenKernel,                           // Both matrices are copied into standard ones, then the standard kernel is used
+};
+struct Plan
+{
+   Strategy Strategy_ = Strategy::ConvertThenKernel;
+   double Seconds_ = 0.0;                       // Estimated time
+   std::string Description_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cost estimates
+template <typename ElementType>
+double SecondsPerFlop()
+{
+   // Vector registers hold twice more single precision numbers
+   return Constants().SecondsPerFlop_ * std::min(1.0, static_cast<double>(sizeof(ElementType)) / sizeof(double));
+}
+
+// Time of reading a matrix: streaming of the stored elements (only nonzeros of a sparse matrix, see Matrix::StoredBytes())
+// plus the indirect calls which the matrix type pays per element by bulk access (see Matrix::CallsPerElement()). Only
+// static hints are used: no element is read here.
+template <typename ElementType>
+double ReadSeconds(const Matrix<ElementType>& matrix)
+{
+   const double elementCount = static_cast<double>(matrix.RowCount()) * matrix.ColumnCount();
+   return matrix.StoredBytes() * Constants().SecondsPerByte_ + elementCount * matrix.CallsPerElement() * Constants().SecondsPerCall_;
+}
+
+template <typename ElementType>
+double WriteSeconds(size_t rowCount, size_t columnCount)
+{
+   return static_cast<double>(rowCount) * columnCount * sizeof(ElementType) * Constants().SecondsPerByte_;
+}
+
+// Time of C = A * B (m x k by k x n) by the packed GEMM kernel, multithreaded above the threshold
+template <typename ElementType>
+double GemmSeconds(size_t m, size_t n, size_t k)
+{
+   const double multiplyAddCount = static_cast<double>(m) * n * k;
+   const double threadCount = (multiplyAddCount < static_cast<double>(ParallelSettings::MultiplyThreshold())) ? 1.0 : static_cast<double>(ParallelSettings::ThreadCount());
+   return 2.0 * multiplyAddCount * SecondsPerFlop<ElementType>() / threadCount;
+}
+
+// Time of an operation which is implemented by a matrix itself. Only the complexity class is known, so:
+//    constant/logarithmic - the result is composed lazily (e.g. function matrices), it costs a few calls;
+//    linear - the stored elements of the operands are visited once and the result has as many (e.g. sparse matrices);
+//    quadratic - the operands are read and the whole result is written once;
+//    cubic and higher - GEMM-like work (cubicSeconds) plus reading of the operands; worse classes are penalized.
+template <typename ElementType>
+double NativeSeconds(Complexity::Type complexity, double readSeconds, double writeSeconds, double cubicSeconds)
+{
+   if (complexity <= Complexity::Polylogarithmic)
+   {
+      return 4.0 * Constants().SecondsPerCall_;
+   }
+   if (complexity <= Complexity::Linear)
+   {
+      return 2.0 * readSeconds;
+   }
+   if (complexity <= Complexity::Quadratic)
+   {
+      return readSeconds + writeSeconds;
+   }
+   const double penalty = (complexity == Complexity::Cubic) ? 1.0 : 100.0;
+   return penalty * cubicSeconds + readSeconds + writeSeconds;
+}
+
+inline std::string StrategyName(Strategy strategy, Complexity::Type complexity)
+{
+   if (strategy == Strategy::ConvertThenKernel)
+   {
+      return "convert to standard matrices, then standard kernel";
+   }
+   return (complexity <= Complexity::Polylogarithmic) ? "lazy composition" : "native kernel";
+}
+
+inline void SortPlans(std::vector<Plan>& plans)
+{
+   std::stable_sort(plans.begin(), plans.end(), [](const Plan& plan1, const Plan& plan2) { return plan1.Seconds_ < plan2.Seconds_; });
+}
+
+// Candidate executions of matrix1 + matrix2 ordered by the estimated time (the cheapest one is the first)
+template <typename ElementType>
+std::vector<Plan> AdditionPlans(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
+{
+   std::vector<Plan> plans;
+   const double readSeconds = ReadSeconds(matrix1) + ReadSeconds(matrix2);
+   const double writeSeconds = WriteSeconds<ElementType>(matrix1.RowCount(), matrix1.ColumnCount());
+   const Complexity::Type complexity1 = matrix1.AdditionComplexity(matrix2);
+   const Complexity::Type complexity2 = matrix2.AdditionComplexity(matrix1);
+   if (complexity1 < Complexity::Max)
+   {
+      plans.push_back(Plan{ Strategy::NativeFirst, NativeSeconds<ElementType>(complexity1, readSeconds, writeSeconds, 0.0), StrategyName(Strategy::NativeFirst, complexity1) + " of " + matrix1.TypeName() });
+   }
+   if (complexity2 < Complexity::Max)
+   {
+      plans.push_back(Plan{ Strategy::NativeSecond, NativeSeconds<ElementType>(complexity2, readSeconds, writeSeconds, 0.0), StrategyName(Strategy::NativeSecond, complexity2) + " of " + matrix2.TypeName() });
+   }
+   // Two copies are written and read again by the addition
+   plans.push_back(Plan{ Strategy::ConvertThenKernel, readSeconds + 4.0 * writeSeconds, StrategyName(Strategy::ConvertThenKernel, Complexity::Undefined) });
+   SortPlans(plans);
+   return plans;
+}
+
+// Candidate executions of leftMatrix * rightMatrix ordered by the estimated time (the cheapest one is the first)
+template <typename ElementType>
+std::vector<Plan> MultiplicationPlans(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix)
+{
+   std::vector<Plan> plans;
+   const size_t m = leftMatrix.RowCount();
+   const size_t k = leftMatrix.ColumnCount();
+   const size_t n = rightMatrix.ColumnCount();
+   const double readSeconds = ReadSeconds(leftMatrix) + ReadSeconds(rightMatrix);
+   const double writeSeconds = WriteSeconds<ElementType>(m, n);
+   const double gemmSeconds = GemmSeconds<ElementType>(m, n, k);
+   const Complexity::Type leftComplexity = leftMatrix.MultiplyComplexity(rightMatrix, false);
+   const Complexity::Type rightComplexity = rightMatrix.MultiplyComplexity(leftMatrix, true);
+   if (leftComplexity < Complexity::Max)
+   {
+      plans.push_back(Plan{ Strategy::NativeFirst, NativeSeconds<ElementType>(leftComplexity, readSeconds, writeSeconds, gemmSeconds), StrategyName(Strategy::NativeFirst, leftComplexity) + " of " + leftMatrix.TypeName() });
+   }
+   if (rightComplexity < Complexity::Max)
+   {
+      plans.push_back(Plan{ Strategy::NativeSecond, NativeSeconds<ElementType>(rightComplexity, readSeconds, writeSeconds, gemmSeconds), StrategyName(Strategy::NativeSecond, rightComplexity) + " of " + rightMatrix.TypeName() });
+   }
+   const double convertSeconds = readSeconds + WriteSeconds<ElementType>(m, k) + WriteSeconds<ElementType>(k, n);
+   plans.push_back(Plan{ Strategy::ConvertThenKernel, convertSeconds + gemmSeconds + writeSeconds, StrategyName(Strategy::ConvertThenKernel, Complexity::Undefined) });
+   SortPlans(plans);
+   return plans;
+}
+
+// Candidate executions of the solution of matrix * X = rightHandSide ordered by the estimated time (the cheapest one is
+// the first). The conversion factorizes a standard copy by LU: 2/3 * N^3 flops, then 2 * N^2 flops per column.
+template <typename ElementType>
+std::vector<Plan> SolvingPlans(const Matrix<ElementType>& matrix, const Matrix<ElementType>& rightHandSide)
+{
+   std::vector<Plan> plans;
+   const double size = static_cast<double>(matrix.RowCount());
+   const size_t columnCount = rightHandSide.ColumnCount();
+   const double readSeconds = ReadSeconds(matrix) + ReadSeconds(rightHandSide);
+   const double writeSeconds = WriteSeconds<ElementType>(matrix.RowCount(), columnCount);
+   const double luSeconds = (2.0 / 3.0 * size * size * size + 2.0 * size * size * columnCount) * SecondsPerFlop<ElementType>();
+   const Complexity::Type complexity = matrix.SolvingComplexity(rightHandSide);
+   if (complexity < Complexity::Max)
+   {
+      plans.push_back(Plan{ Strategy::NativeFirst, NativeSeconds<ElementType>(complexity, readSeconds, writeSeconds, luSeconds), StrategyName(Strategy::NativeFirst, complexity) + " of " + matrix.TypeName() });
+   }
+   const double convertSeconds = readSeconds + WriteSeconds<ElementType>(matrix.RowCount(), matrix.ColumnCount());
+   plans.push_back(Plan{ Strategy::ConvertThenKernel, convertSeconds + luSeconds + writeSeconds, StrategyName(Strategy::ConvertThenKernel, Complexity::Undefined) });
+   SortPlans(plans);
+   return plans;
+}
+
+} // namespace Planner
+} // namespace SMT
+
+#endif // __MATRIX_PLANNER_H__
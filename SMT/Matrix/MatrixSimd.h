@@ -0,0 +1,551 @@
+#ifndef __MATRIX_SIMD_H__
+#define __MATRIX_SIMD_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD kernels for elementary row operations and transposition (with runtime dispatch)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstddef>
+
+#if !defined(SMT_DISABLE_SIMD) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+   #define SMT_SIMD_X86
+   #include <immintrin.h>
+   #if defined(_MSC_VER)
+      #include <intrin.h>
+      #define SMT_TARGET_AVX2
+      #define SMT_TARGET_AVX512
+      #if _MSC_VER >= 1910
+         #define SMT_SIMD_AVX512                // AVX-512 intrinsics are available since Visual Studio 2017
+      #endif
+   #else
+      #define SMT_TARGET_AVX2 __attribute__((target("avx2")))
+      #define SMT_TARGET_AVX512 __attribute__((target("avx512f")))
+      #define SMT_SIMD_AVX512
+   #endif
+#endif
+
+#include "MatrixDefs.h"
+
+namespace SMT
+{
+namespace Simd
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Instruction sets which can be used by the kernels (ordered by capabilities)
+enum class InstructionSet
+{
+   Generic,                                     // Plain C++ loops
+   SSE2,                                        // 128-bit vectors (baseline on x86-64)
+   AVX2,                                        // 256-bit vectors
+   AVX512,                                      // 512-bit vectors (AVX-512F)
+};
+
+// The best instruction set which is supported by CPU (and OS)
+inline InstructionSet DetectInstructionSet()
+{
+#if defined(SMT_SIMD_X86)
+   #if defined(_MSC_VER)
+      int info[4] = {};
+      __cpuid(info, 0);
+      const int maxLeaf = info[0];
+      __cpuidex(info, 1, 0);
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+      const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+      const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+      bool avx2 = false;
+      bool avx512 = false;
+      if (maxLeaf >= 7)
+      {
+         __cpuidex(info, 7, 0);
+         avx2 = (info[1] & (1 << 5)) != 0;
+         avx512 = (info[1] & (1 << 16)) != 0;
+      }
+      #if defined(SMT_SIMD_AVX512)
+         if (avx && avx512 && zmmEnabled)
+         {
+            return InstructionSet::AVX512;
+         }
+      #endif
+      if (avx && avx2 && ymmEnabled)
+      {
+         return InstructionSet::AVX2;
+      }
+   #else
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f"))
+      {
+         return InstructionSet::AVX512;
+      }
+      if (__builtin_cpu_supports("avx2"))
+      {
+         return InstructionSet::AVX2;
+      }
+   #endif
+   return InstructionSet::SSE2;
+#else
+   return InstructionSet::Generic;
+#endif
+}
+
+namespace Details
+{
+inline InstructionSet& ActiveInstructionSetRef()
+{
+   static InstructionSet instructionSet = DetectInstructionSet();
+   return instructionSet;
+}
+
+// destination[column][row] = source[row][column] for the part of a tile which isn't covered by micro-transposes:
+// rows [firstRow, rowCount) of all columns and columns [firstColumn, columnCount) of rows [0, firstRow)
+template <typename ElementType>
+void TransposeTileEdges(const ElementType* source, size_t sourceStride, ElementType* destination, size_t destinationStride,
+   size_t rowCount, size_t columnCount, size_t firstRow, size_t firstColumn)
+{
+   for (size_t row = 0; row < rowCount; ++row)
+   {
+      for (size_t column = (row < firstRow) ? firstColumn : 0; column < columnCount; ++column)
+      {
+         destination[column * destinationStride + row] = source[row * sourceStride + column];
+      }
+   }
+}
+} // namespace Details
+
+// The instruction set which is used by the kernels
+inline InstructionSet ActiveInstructionSet() { return Details::ActiveInstructionSetRef(); }
+// Restricts kernels to the given instruction set (e.g. for testing or benchmarking).
+// Returns false if CPU doesn't support the instruction set. It isn't thread-safe: call it before any matrix operation.
+inline bool SetInstructionSet(InstructionSet instructionSet)
+{
+   if (instructionSet > DetectInstructionSet())
+   {
+      return false;
+   }
+   Details::ActiveInstructionSetRef() = instructionSet;
+   return true;
+}
+
+#if defined(SMT_SIMD_X86)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels
+//    All kernels use separate multiplication and subtraction (no FMA), so every instruction set gives the same result.
+namespace Sse2
+{
+inline void ScaleRow(double* row, double number, size_t count)
+{
+   const __m128d factor = _mm_set1_pd(number);
+   size_t i = 0;
+   for (; i + 2 <= count; i += 2)
+   {
+      _mm_storeu_pd(&row[i], _mm_mul_pd(_mm_loadu_pd(&row[i]), factor));
+   }
+   for (; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+inline void ScaleRow(float* row, float number, size_t count)
+{
+   const __m128 factor = _mm_set1_ps(number);
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      _mm_storeu_ps(&row[i], _mm_mul_ps(_mm_loadu_ps(&row[i]), factor));
+   }
+   for (; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+inline void SubtractScaledRow(double* row1, const double* row2, double number, size_t count)
+{
+   const __m128d factor = _mm_set1_pd(number);
+   size_t i = 0;
+   for (; i + 2 <= count; i += 2)
+   {
+      _mm_storeu_pd(&row1[i], _mm_sub_pd(_mm_loadu_pd(&row1[i]), _mm_mul_pd(_mm_loadu_pd(&row2[i]), factor)));
+   }
+   for (; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+inline void SubtractScaledRow(float* row1, const float* row2, float number, size_t count)
+{
+   const __m128 factor = _mm_set1_ps(number);
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      _mm_storeu_ps(&row1[i], _mm_sub_ps(_mm_loadu_ps(&row1[i]), _mm_mul_ps(_mm_loadu_ps(&row2[i]), factor)));
+   }
+   for (; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+inline void SwapRows(double* row1, double* row2, size_t count)
+{
+   size_t i = 0;
+   for (; i + 2 <= count; i += 2)
+   {
+      const __m128d value1 = _mm_loadu_pd(&row1[i]);
+      _mm_storeu_pd(&row1[i], _mm_loadu_pd(&row2[i]));
+      _mm_storeu_pd(&row2[i], value1);
+   }
+   std::swap_ranges(&row1[i], &row1[count], &row2[i]);
+}
+inline void SwapRows(float* row1, float* row2, size_t count)
+{
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      const __m128 value1 = _mm_loadu_ps(&row1[i]);
+      _mm_storeu_ps(&row1[i], _mm_loadu_ps(&row2[i]));
+      _mm_storeu_ps(&row2[i], value1);
+   }
+   std::swap_ranges(&row1[i], &row1[count], &row2[i]);
+}
+// Tile transposition: destination (columnCount x rowCount) = transposed source (rowCount x columnCount).
+// Full 2x2 (double) or 4x4 (float) squares are transposed in registers, the edges element by element.
+inline void TransposeTile(const double* source, size_t sourceStride, double* destination, size_t destinationStride, size_t rowCount, size_t columnCount)
+{
+   const size_t fullRows = rowCount & ~size_t(1);
+   const size_t fullColumns = columnCount & ~size_t(1);
+   for (size_t row = 0; row < fullRows; row += 2)
+   {
+      for (size_t column = 0; column < fullColumns; column += 2)
+      {
+         const __m128d row0 = _mm_loadu_pd(&source[row * sourceStride + column]);
+         const __m128d row1 = _mm_loadu_pd(&source[(row + 1) * sourceStride + column]);
+         _mm_storeu_pd(&destination[column * destinationStride + row], _mm_unpacklo_pd(row0, row1));
+         _mm_storeu_pd(&destination[(column + 1) * destinationStride + row], _mm_unpackhi_pd(row0, row1));
+      }
+   }
+   Details::TransposeTileEdges(source, sourceStride, destination, destinationStride, rowCount, columnCount, fullRows, fullColumns);
+}
+inline void TransposeTile(const float* source, size_t sourceStride, float* destination, size_t destinationStride, size_t rowCount, size_t columnCount)
+{
+   const size_t fullRows = rowCount & ~size_t(3);
+   const size_t fullColumns = columnCount & ~size_t(3);
+   for (size_t row = 0; row < fullRows; row += 4)
+   {
+      for (size_t column = 0; column < fullColumns; column += 4)
+      {
+         __m128 row0 = _mm_loadu_ps(&source[row * sourceStride + column]);
+         __m128 row1 = _mm_loadu_ps(&source[(row + 1) * sourceStride + column]);
+         __m128 row2 = _mm_loadu_ps(&source[(row + 2) * sourceStride + column]);
+         __m128 row3 = _mm_loadu_ps(&source[(row + 3) * sourceStride + column]);
+         _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+         _mm_storeu_ps(&destination[column * destinationStride + row], row0);
+         _mm_storeu_ps(&destination[(column + 1) * destinationStride + row], row1);
+         _mm_storeu_ps(&destination[(column + 2) * destinationStride + row], row2);
+         _mm_storeu_ps(&destination[(column + 3) * destinationStride + row], row3);
+      }
+   }
+   Details::TransposeTileEdges(source, sourceStride, destination, destinationStride, rowCount, columnCount, fullRows, fullColumns);
+}
+} // namespace Sse2
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels
+namespace Avx2
+{
+SMT_TARGET_AVX2 inline void ScaleRow(double* row, double number, size_t count)
+{
+   const __m256d factor = _mm256_set1_pd(number);
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      _mm256_storeu_pd(&row[i], _mm256_mul_pd(_mm256_loadu_pd(&row[i]), factor));
+   }
+   for (; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+SMT_TARGET_AVX2 inline void ScaleRow(float* row, float number, size_t count)
+{
+   const __m256 factor = _mm256_set1_ps(number);
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      _mm256_storeu_ps(&row[i], _mm256_mul_ps(_mm256_loadu_ps(&row[i]), factor));
+   }
+   for (; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+SMT_TARGET_AVX2 inline void SubtractScaledRow(double* row1, const double* row2, double number, size_t count)
+{
+   const __m256d factor = _mm256_set1_pd(number);
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      _mm256_storeu_pd(&row1[i], _mm256_sub_pd(_mm256_loadu_pd(&row1[i]), _mm256_mul_pd(_mm256_loadu_pd(&row2[i]), factor)));
+   }
+   for (; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+SMT_TARGET_AVX2 inline void SubtractScaledRow(float* row1, const float* row2, float number, size_t count)
+{
+   const __m256 factor = _mm256_set1_ps(number);
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      _mm256_storeu_ps(&row1[i], _mm256_sub_ps(_mm256_loadu_ps(&row1[i]), _mm256_mul_ps(_mm256_loadu_ps(&row2[i]), factor)));
+   }
+   for (; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+SMT_TARGET_AVX2 inline void SwapRows(double* row1, double* row2, size_t count)
+{
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4)
+   {
+      const __m256d value1 = _mm256_loadu_pd(&row1[i]);
+      _mm256_storeu_pd(&row1[i], _mm256_loadu_pd(&row2[i]));
+      _mm256_storeu_pd(&row2[i], value1);
+   }
+   std::swap_ranges(&row1[i], &row1[count], &row2[i]);
+}
+SMT_TARGET_AVX2 inline void SwapRows(float* row1, float* row2, size_t count)
+{
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      const __m256 value1 = _mm256_loadu_ps(&row1[i]);
+      _mm256_storeu_ps(&row1[i], _mm256_loadu_ps(&row2[i]));
+      _mm256_storeu_ps(&row2[i], value1);
+   }
+   std::swap_ranges(&row1[i], &row1[count], &row2[i]);
+}
+// Tile transposition with 4x4 (double) and 8x8 (float) micro-transposes in registers
+SMT_TARGET_AVX2 inline void TransposeTile(const double* source, size_t sourceStride, double* destination, size_t destinationStride, size_t rowCount, size_t columnCount)
+{
+   const size_t fullRows = rowCount & ~size_t(3);
+   const size_t fullColumns = columnCount & ~size_t(3);
+   for (size_t row = 0; row < fullRows; row += 4)
+   {
+      for (size_t column = 0; column < fullColumns; column += 4)
+      {
+         const double* block = &source[row * sourceStride + column];
+         const __m256d row0 = _mm256_loadu_pd(block);
+         const __m256d row1 = _mm256_loadu_pd(block + sourceStride);
+         const __m256d row2 = _mm256_loadu_pd(block + 2 * sourceStride);
+         const __m256d row3 = _mm256_loadu_pd(block + 3 * sourceStride);
+         const __m256d low01 = _mm256_unpacklo_pd(row0, row1);      // 00 10 02 12
+         const __m256d high01 = _mm256_unpackhi_pd(row0, row1);     // 01 11 03 13
+         const __m256d low23 = _mm256_unpacklo_pd(row2, row3);      // 20 30 22 32
+         const __m256d high23 = _mm256_unpackhi_pd(row2, row3);     // 21 31 23 33
+         double* target = &destination[column * destinationStride + row];
+         _mm256_storeu_pd(target, _mm256_permute2f128_pd(low01, low23, 0x20));
+         _mm256_storeu_pd(target + destinationStride, _mm256_permute2f128_pd(high01, high23, 0x20));
+         _mm256_storeu_pd(target + 2 * destinationStride, _mm256_permute2f128_pd(low01, low23, 0x31));
+         _mm256_storeu_pd(target + 3 * destinationStride, _mm256_permute2f128_pd(high01, high23, 0x31));
+      }
+   }
+   Details::TransposeTileEdges(source, sourceStride, destination, destinationStride, rowCount, columnCount, fullRows, fullColumns);
+}
+SMT_TARGET_AVX2 inline void TransposeTile(const float* source, size_t sourceStride, float* destination, size_t destinationStride, size_t rowCount, size_t columnCount)
+{
+   const size_t fullRows = rowCount & ~size_t(7);
+   const size_t fullColumns = columnCount & ~size_t(7);
+   for (size_t row = 0; row < fullRows; row += 8)
+   {
+      for (size_t column = 0; column < fullColumns; column += 8)
+      {
+         const float* block = &source[row * sourceStride + column];
+         __m256 rows[8];
+         for (size_t i = 0; i < 8; ++i)
+         {
+            rows[i] = _mm256_loadu_ps(block + i * sourceStride);
+         }
+         // Pairs of rows are interleaved, then pairs of pairs, then 128-bit halves are exchanged
+         __m256 pairs[8];
+         for (size_t i = 0; i < 8; i += 2)
+         {
+            pairs[i] = _mm256_unpacklo_ps(rows[i], rows[i + 1]);
+            pairs[i + 1] = _mm256_unpackhi_ps(rows[i], rows[i + 1]);
+         }
+         __m256 quads[8];
+         for (size_t i = 0; i < 8; i += 4)
+         {
+            quads[i] = _mm256_shuffle_ps(pairs[i], pairs[i + 2], 0x44);
+            quads[i + 1] = _mm256_shuffle_ps(pairs[i], pairs[i + 2], 0xEE);
+            quads[i + 2] = _mm256_shuffle_ps(pairs[i + 1], pairs[i + 3], 0x44);
+            quads[i + 3] = _mm256_shuffle_ps(pairs[i + 1], pairs[i + 3], 0xEE);
+         }
+         float* target = &destination[column * destinationStride + row];
+         for (size_t i = 0; i < 4; ++i)
+         {
+            _mm256_storeu_ps(target + i * destinationStride, _mm256_permute2f128_ps(quads[i], quads[i + 4], 0x20));
+            _mm256_storeu_ps(target + (i + 4) * destinationStride, _mm256_permute2f128_ps(quads[i], quads[i + 4], 0x31));
+         }
+      }
+   }
+   Details::TransposeTileEdges(source, sourceStride, destination, destinationStride, rowCount, columnCount, fullRows, fullColumns);
+}
+} // namespace Avx2
+
+#if defined(SMT_SIMD_AVX512)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AVX-512 kernels
+namespace Avx512
+{
+SMT_TARGET_AVX512 inline void ScaleRow(double* row, double number, size_t count)
+{
+   const __m512d factor = _mm512_set1_pd(number);
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      _mm512_storeu_pd(&row[i], _mm512_mul_pd(_mm512_loadu_pd(&row[i]), factor));
+   }
+   for (; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+SMT_TARGET_AVX512 inline void ScaleRow(float* row, float number, size_t count)
+{
+   const __m512 factor = _mm512_set1_ps(number);
+   size_t i = 0;
+   for (; i + 16 <= count; i += 16)
+   {
+      _mm512_storeu_ps(&row[i], _mm512_mul_ps(_mm512_loadu_ps(&row[i]), factor));
+   }
+   for (; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+SMT_TARGET_AVX512 inline void SubtractScaledRow(double* row1, const double* row2, double number, size_t count)
+{
+   const __m512d factor = _mm512_set1_pd(number);
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      _mm512_storeu_pd(&row1[i], _mm512_sub_pd(_mm512_loadu_pd(&row1[i]), _mm512_mul_pd(_mm512_loadu_pd(&row2[i]), factor)));
+   }
+   for (; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+SMT_TARGET_AVX512 inline void SubtractScaledRow(float* row1, const float* row2, float number, size_t count)
+{
+   const __m512 factor = _mm512_set1_ps(number);
+   size_t i = 0;
+   for (; i + 16 <= count; i += 16)
+   {
+      _mm512_storeu_ps(&row1[i], _mm512_sub_ps(_mm512_loadu_ps(&row1[i]), _mm512_mul_ps(_mm512_loadu_ps(&row2[i]), factor)));
+   }
+   for (; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+SMT_TARGET_AVX512 inline void SwapRows(double* row1, double* row2, size_t count)
+{
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8)
+   {
+      const __m512d value1 = _mm512_loadu_pd(&row1[i]);
+      _mm512_storeu_pd(&row1[i], _mm512_loadu_pd(&row2[i]));
+      _mm512_storeu_pd(&row2[i], value1);
+   }
+   std::swap_ranges(&row1[i], &row1[count], &row2[i]);
+}
+SMT_TARGET_AVX512 inline void SwapRows(float* row1, float* row2, size_t count)
+{
+   size_t i = 0;
+   for (; i + 16 <= count; i += 16)
+   {
+      const __m512 value1 = _mm512_loadu_ps(&row1[i]);
+      _mm512_storeu_ps(&row1[i], _mm512_loadu_ps(&row2[i]));
+      _mm512_storeu_ps(&row2[i], value1);
+   }
+   std::swap_ranges(&row1[i], &row1[count], &row2[i]);
+}
+// 512-bit shuffles don't make the transposition faster: it is limited by memory, so the AVX2 kernels are used
+using Avx2::TransposeTile;
+} // namespace Avx512
+#endif // SMT_SIMD_AVX512
+#endif // SMT_SIMD_X86
+} // namespace Simd
+
+namespace Kernels
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Elementary row operations.
+// Generic versions are used for all element types except float and double.
+// row = row * number
+template <typename ElementType>
+void ScaleRow(ElementType* row, ElementType number, size_t count)
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      row[i] *= number;
+   }
+}
+// row1 = row1 - row2 * number
+template <typename ElementType>
+void SubtractScaledRow(ElementType* row1, const ElementType* row2, ElementType number, size_t count)
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      row1[i] -= row2[i] * number;
+   }
+}
+// row1 <-> row2
+template <typename ElementType>
+void SwapRows(ElementType* row1, ElementType* row2, size_t count)
+{
+   std::swap_ranges(row1, row1 + count, row2);
+}
+// destination (columnCount x rowCount) = transposed source (rowCount x columnCount); a tile should fit in L1 cache
+template <typename ElementType>
+void TransposeTile(const ElementType* source, size_t sourceStride, ElementType* destination, size_t destinationStride, size_t rowCount, size_t columnCount)
+{
+   Simd::Details::TransposeTileEdges(source, sourceStride, destination, destinationStride, rowCount, columnCount, 0, 0);
+}
+
+#if defined(SMT_SIMD_X86)
+// Calls the kernel from the namespace of the active instruction set
+#if defined(SMT_SIMD_AVX512)
+   #define SMT_SIMD_AVX512_CASE(call) case Simd::InstructionSet::AVX512: Simd::Avx512::call; return;
+#else
+   #define SMT_SIMD_AVX512_CASE(call)
+#endif
+#define SMT_SIMD_DISPATCH(call, genericCall)                                   \
+   switch (Simd::ActiveInstructionSet())                                       \
+   {                                                                           \
+   SMT_SIMD_AVX512_CASE(call)                                                  \
+   case Simd::InstructionSet::AVX2: Simd::Avx2::call; return;                  \
+   case Simd::InstructionSet::SSE2: Simd::Sse2::call; return;                  \
+   default: genericCall; return;                                               \
+   }
+
+inline void ScaleRow(double* row, double number, size_t count) { SMT_SIMD_DISPATCH(ScaleRow(row, number, count), ScaleRow<double>(row, number, count)) }
+inline void ScaleRow(float* row, float number, size_t count) { SMT_SIMD_DISPATCH(ScaleRow(row, number, count), ScaleRow<float>(row, number, count)) }
+inline void SubtractScaledRow(double* row1, const double* row2, double number, size_t count) { SMT_SIMD_DISPATCH(SubtractScaledRow(row1, row2, number, count), SubtractScaledRow<double>(row1, row2, number, count)) }
+inline void SubtractScaledRow(float* row1, const float* row2, float number, size_t count) { SMT_SIMD_DISPATCH(SubtractScaledRow(row1, row2, number, count), SubtractScaledRow<float>(row1, row2, number, count)) }
+inline void SwapRows(double* row1, double* row2, size_t count) { SMT_SIMD_DISPATCH(SwapRows(row1, row2, count), SwapRows<double>(row1, row2, count)) }
+inline void SwapRows(float* row1, float* row2, size_t count) { SMT_SIMD_DISPATCH(SwapRows(row1, row2, count), SwapRows<float>(row1, row2, count)) }
+inline void TransposeTile(const double* source, size_t sourceStride, double* destination, size_t destinationStride, size_t rowCount, size_t columnCount) { SMT_SIMD_DISPATCH(TransposeTile(source, sourceStride, destination, destinationStride, rowCount, columnCount), TransposeTile<double>(source, sourceStride, destination, destinationStride, rowCount, columnCount)) }
+inline void TransposeTile(const float* source, size_t sourceStride, float* destination, size_t destinationStride, size_t rowCount, size_t columnCount) { SMT_SIMD_DISPATCH(TransposeTile(source, sourceStride, destination, destinationStride, rowCount, columnCount), TransposeTile<float>(source, sourceStride, destination, destinationStride, rowCount, columnCount)) }
+
+#undef SMT_SIMD_DISPATCH
+#undef SMT_SIMD_AVX512_CASE
+#endif // SMT_SIMD_X86
+} // namespace Kernels
+} // namespace SMT
+
+#endif // __MATRIX_SIMD_H__
\ No newline at end of file
@@ -0,0 +1,580 @@
+#ifndef __SPARSE_MATRIX_H__
+#define __SPARSE_MATRIX_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sparse matrix
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixChecks.h"
+#include "MatrixSimd.h"
+#include "StandardMatrix.h"
+#include "../Threading/ThreadPool.h"
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sparse matrix.
+// It represents as compressed sparse rows (CSR): nonzero elements are stored row by row with their column indices
+// (ascending in every row), RowOffsets()[row] is the position of the first nonzero of the row.
+//    Only nonzeros are stored and visited, so the matrix of a mesh or a graph takes memory and time proportional to
+//    the number of nonzeros instead of RowCount() * ColumnCount().
+//    The matrix is immutable (it has no elementary and in-place operations), so copies share the storage.
+//    Operations with another sparse matrix give sparse results, operations with other matrices give standard ones.
+template <typename ElementType>
+class SparseMatrix : public Matrix<ElementType>
+{
+public:
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   // An element of the matrix: elements of the same position are added together
+   struct Triplet
+   {
+      size_t Row_;
+      size_t Column_;
+      ElementType Value_;
+   };
+
+   // Creates a zero matrix
+   SparseMatrix(size_t rowCount, size_t columnCount)
+      : SparseMatrix(rowCount, columnCount, std::vector<size_t>(rowCount + 1, 0), std::vector<size_t>(), std::vector<ElementType>())
+   {
+   }
+   // Positions of triplets have to be inside the matrix
+   SparseMatrix(size_t rowCount, size_t columnCount, std::vector<Triplet> triplets)
+      : rowCount_(rowCount)
+      , columnCount_(columnCount)
+   {
+      std::stable_sort(triplets.begin(), triplets.end(), [](const Triplet& triplet1, const Triplet& triplet2)
+      {
+         return (triplet1.Row_ != triplet2.Row_) ? (triplet1.Row_ < triplet2.Row_) : (triplet1.Column_ < triplet2.Column_);
+      });
+      auto storage = std::make_shared<Storage>();
+      storage->RowOffsets_.assign(rowCount_ + 1, 0);
+      for (size_t index = 0; index < triplets.size(); ++index)
+      {
+         const Triplet& triplet = triplets[index];
+         assert((triplet.Row_ < rowCount_) && (triplet.Column_ < columnCount_));
+         if ((index != 0) && (triplet.Row_ == triplets[index - 1].Row_) && (triplet.Column_ == triplets[index - 1].Column_))
+         {
+            storage->Values_.back() += triplet.Value_;
+            continue;
+         }
+         storage->ColumnIndices_.push_back(triplet.Column_);
+         storage->Values_.push_back(triplet.Value_);
+         ++storage->RowOffsets_[triplet.Row_ + 1];
+      }
+      std::partial_sum(storage->RowOffsets_.begin(), storage->RowOffsets_.end(), storage->RowOffsets_.begin());
+      storage_ = storage;
+   }
+   // Adopts CSR arrays without copying them: rowOffsets has rowCount + 1 positions (from 0 to the number of nonzeros),
+   // column indices are ascending in every row
+   SparseMatrix(size_t rowCount, size_t columnCount, std::vector<size_t>&& rowOffsets, std::vector<size_t>&& columnIndices, std::vector<ElementType>&& values)
+      : rowCount_(rowCount)
+      , columnCount_(columnCount)
+   {
+      auto storage = std::make_shared<Storage>();
+      storage->RowOffsets_.swap(rowOffsets);
+      storage->ColumnIndices_.swap(columnIndices);
+      storage->Values_.swap(values);
+      storage_ = storage;
+      assert(isValid());
+   }
+   // Nonzero elements of the matrix are kept (they are read row by row)
+   explicit SparseMatrix(const Matrix<ElementType>& sourceMatrix)
+      : rowCount_(sourceMatrix.RowCount())
+      , columnCount_(sourceMatrix.ColumnCount())
+   {
+      auto storage = std::make_shared<Storage>();
+      storage->RowOffsets_.assign(rowCount_ + 1, 0);
+      RowReader<ElementType> reader(sourceMatrix);
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         const ElementType* rowData = reader.Row(row);
+         for (size_t column = 0; column < columnCount_; ++column)
+         {
+            if (rowData[column] != MatrixSettings::Zero<ElementType>())
+            {
+               storage->ColumnIndices_.push_back(column);
+               storage->Values_.push_back(rowData[column]);
+            }
+         }
+         storage->RowOffsets_[row + 1] = storage->ColumnIndices_.size();
+      }
+      storage_ = storage;
+   }
+
+   // CSR arrays: RowCount() + 1 row offsets, NonZeroCount() column indices and values
+   size_t NonZeroCount() const { return storage_->Values_.size(); }
+   const size_t* RowOffsets() const { return storage_->RowOffsets_.data(); }
+   const size_t* ColumnIndices() const { return storage_->ColumnIndices_.data(); }
+   const ElementType* Values() const { return storage_->Values_.data(); }
+
+   // Sparse matrix-vector product: result = This * vector (vector has ColumnCount() elements, result has RowCount() ones).
+   // Rows are distributed between threads of the library pool in parts of the same number of nonzeros.
+   void MultiplyVector(const ElementType* vector, ElementType* result) const
+   {
+      const Storage& storage = *storage_;
+      forEachRowRange(storage.RowOffsets_.data(), rowCount_, static_cast<double>(NonZeroCount()), [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            ElementType sum = MatrixSettings::Zero<ElementType>();
+            for (size_t position = storage.RowOffsets_[row]; position < storage.RowOffsets_[row + 1]; ++position)
+            {
+               sum += storage.Values_[position] * vector[storage.ColumnIndices_[position]];
+            }
+            result[row] = sum;
+         }
+      });
+   }
+
+   // Matrix
+   virtual size_t RowCount() const override { return rowCount_; }
+   virtual size_t ColumnCount() const override { return columnCount_; }
+   // Binary search in the row
+   virtual ElementType Element(size_t row, size_t column) const override
+   {
+      const Storage& storage = *storage_;
+      const auto first = storage.ColumnIndices_.begin() + storage.RowOffsets_[row];
+      const auto last = storage.ColumnIndices_.begin() + storage.RowOffsets_[row + 1];
+      const auto found = std::lower_bound(first, last, column);
+      return ((found != last) && (*found == column)) ? storage.Values_[found - storage.ColumnIndices_.begin()] : MatrixSettings::Zero<ElementType>();
+   }
+   virtual std::string TypeName() const { return "SparseMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   virtual double StoredBytes() const override
+   {
+      return static_cast<double>(NonZeroCount()) * (sizeof(ElementType) + sizeof(size_t)) + static_cast<double>(rowCount_ + 1) * sizeof(size_t);
+   }
+   // The tile is filled with zeros, then nonzeros of the tile are scattered into it
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      const Storage& storage = *storage_;
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         std::fill(destination, destination + columnCount, MatrixSettings::Zero<ElementType>());
+         const auto first = storage.ColumnIndices_.begin() + storage.RowOffsets_[row + tileRow];
+         const auto last = storage.ColumnIndices_.begin() + storage.RowOffsets_[row + tileRow + 1];
+         for (auto position = std::lower_bound(first, last, column); (position != last) && (*position < column + columnCount); ++position)
+         {
+            destination[*position - column] = storage.Values_[position - storage.ColumnIndices_.begin()];
+         }
+      }
+   }
+   // The storage is shared by copies
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<SparseMatrix<ElementType>>(*this);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The sum of sparse matrices merges their rows, other matrices are copied into a standard one and nonzeros are added to it
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override
+   {
+      const SparseMatrix<ElementType>* sparseMatrix = dynamic_cast<const SparseMatrix<ElementType>*>(&otherMatrix);
+      return ((sparseMatrix != nullptr) && isSparse() && sparseMatrix->isSparse()) ? Complexity::Linear : Complexity::Quadratic;
+   }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override { return add(otherMatrix); }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Linear; }
+   virtual OperationResult MultiplyByNumber(const ElementType& number) const override { return multiplyByNumber(number); }
+   // The product of sparse matrices visits the nonzeros of the rows of the right matrix which are selected by the
+   // nonzeros of the left one (SpGEMM), the product with another matrix writes the whole (standard) result
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool /*anotherMatrixIsOnTheLeft*/) const override
+   {
+      const SparseMatrix<ElementType>* sparseMatrix = dynamic_cast<const SparseMatrix<ElementType>*>(&anotherMatrix);
+      if (!isSparse())
+      {
+         return Complexity::Cubic;
+      }
+      if (sparseMatrix != nullptr)
+      {
+         return sparseMatrix->isSparse() ? Complexity::Linear : Complexity::Quadratic;
+      }
+      return Complexity::Quadratic;
+   }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override { return multiply(anotherMatrix, anotherMatrixIsOnTheLeft); }
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Linear; }
+   virtual OperationResult Transpose() const override { return transpose(); }
+
+private:
+   struct Storage
+   {
+      std::vector<size_t> RowOffsets_;
+      std::vector<size_t> ColumnIndices_;
+      std::vector<ElementType> Values_;
+   };
+   size_t rowCount_;
+   size_t columnCount_;
+   std::shared_ptr<const Storage> storage_;     // Immutable, shared with copies
+
+   static const size_t NoRow = static_cast<size_t>(-1);
+
+   bool isValid() const
+   {
+      const Storage& storage = *storage_;
+      if ((storage.RowOffsets_.size() != rowCount_ + 1) || (storage.RowOffsets_.front() != 0) || (storage.RowOffsets_.back() != storage.Values_.size())
+         || (storage.ColumnIndices_.size() != storage.Values_.size()))
+      {
+         return false;
+      }
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         for (size_t position = storage.RowOffsets_[row]; position < storage.RowOffsets_[row + 1]; ++position)
+         {
+            if ((storage.ColumnIndices_[position] >= columnCount_) || ((position != storage.RowOffsets_[row]) && (storage.ColumnIndices_[position - 1] >= storage.ColumnIndices_[position])))
+            {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   // The matrix is sparse if a row has no more nonzeros than the square root of the number of columns (on average).
+   // Matrices of meshes and graphs have a bounded number of nonzeros per row, so operations which visit nonzeros only
+   // are linear. A denser matrix is reported like a standard one.
+   bool isSparse() const
+   {
+      const double nonZeroCount = static_cast<double>(NonZeroCount());
+      return nonZeroCount * nonZeroCount <= static_cast<double>(rowCount_) * rowCount_ * columnCount_;
+   }
+
+   // Calls func(firstRow, lastRow) for parts of the rows [0, rowCount). Operations with fewer multiply-add operations
+   // than ParallelSettings::MultiplyThreshold() are done by the calling thread. Otherwise there are several parts per
+   // thread of the library pool: if rowOffsets isn't nullptr the parts have the same number of nonzeros (rows of a
+   // sparse matrix differ a lot), otherwise the same number of rows.
+   template <typename RangeFunc>
+   static void forEachRowRange(const size_t* rowOffsets, size_t rowCount, double operationCount, const RangeFunc& func)
+   {
+      if ((rowCount < 2) || (operationCount < static_cast<double>(ParallelSettings::MultiplyThreshold())) || (ParallelSettings::ThreadCount() == 1))
+      {
+         func(0, rowCount);
+         return;
+      }
+      const size_t rangeCount = std::min(rowCount, 4 * ParallelSettings::ThreadCount());
+      std::vector<size_t> firstRows(rangeCount + 1, rowCount);
+      for (size_t range = 0; range < rangeCount; ++range)
+      {
+         if (rowOffsets == nullptr)
+         {
+            firstRows[range] = rowCount * range / rangeCount;
+            continue;
+         }
+         const size_t firstPosition = static_cast<size_t>(static_cast<double>(rowOffsets[rowCount]) * range / rangeCount);
+         firstRows[range] = static_cast<size_t>(std::upper_bound(rowOffsets, rowOffsets + rowCount + 1, firstPosition) - rowOffsets) - 1;
+      }
+      // Leading empty rows have the same offset as the first nonempty one, they belong to the first range
+      firstRows[0] = 0;
+      ParallelSettings::Pool().ParallelFor(rangeCount, [&](size_t range)
+      {
+         if (firstRows[range] < firstRows[range + 1])
+         {
+            func(firstRows[range], firstRows[range + 1]);
+         }
+      });
+   }
+
+   OperationResult multiplyByNumber(const ElementType& number) const
+   {
+      OperationResult result;
+      std::vector<size_t> rowOffsets(storage_->RowOffsets_);
+      std::vector<size_t> columnIndices(storage_->ColumnIndices_);
+      std::vector<ElementType> values(storage_->Values_);
+      Kernels::ScaleRow(values.data(), number, values.size());
+      result.Matrix_ = std::make_shared<SparseMatrix<ElementType>>(rowCount_, columnCount_, std::move(rowOffsets), std::move(columnIndices), std::move(values));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+   OperationResult add(const Matrix<ElementType>& otherMatrix) const
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const SparseMatrix<ElementType>* sparseMatrix = dynamic_cast<const SparseMatrix<ElementType>*>(&otherMatrix);
+      if (sparseMatrix != nullptr)
+      {
+         result.Matrix_ = addSparse(*sparseMatrix);
+         return result;
+      }
+      auto sum = std::make_shared<StandardMatrix<ElementType>>(otherMatrix);
+      ElementType* data = sum->Data();
+      const Storage& storage = *storage_;
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         for (size_t position = storage.RowOffsets_[row]; position < storage.RowOffsets_[row + 1]; ++position)
+         {
+            data[row * columnCount_ + storage.ColumnIndices_[position]] += storage.Values_[position];
+         }
+      }
+      result.Matrix_ = sum;
+      return result;
+   }
+
+   // Rows of both matrices are merged twice: the first pass counts nonzeros of every row of the sum, the second one
+   // writes them (so rows are written by different threads without synchronization)
+   typename Matrix<ElementType>::SharedPtr addSparse(const SparseMatrix<ElementType>& otherMatrix) const
+   {
+      const Storage& storage1 = *storage_;
+      const Storage& storage2 = *otherMatrix.storage_;
+      auto mergeRow = [&](size_t row, size_t* columnIndices, ElementType* values) -> size_t
+      {
+         size_t position1 = storage1.RowOffsets_[row];
+         size_t position2 = storage2.RowOffsets_[row];
+         const size_t last1 = storage1.RowOffsets_[row + 1];
+         const size_t last2 = storage2.RowOffsets_[row + 1];
+         size_t count = 0;
+         while ((position1 < last1) || (position2 < last2))
+         {
+            const size_t column1 = (position1 < last1) ? storage1.ColumnIndices_[position1] : columnCount_;
+            const size_t column2 = (position2 < last2) ? storage2.ColumnIndices_[position2] : columnCount_;
+            const size_t column = std::min(column1, column2);
+            if (columnIndices != nullptr)
+            {
+               columnIndices[count] = column;
+               values[count] = (column1 == column2) ? storage1.Values_[position1] + storage2.Values_[position2]
+                  : (column1 < column2) ? storage1.Values_[position1] : storage2.Values_[position2];
+            }
+            position1 += (column1 == column) ? 1 : 0;
+            position2 += (column2 == column) ? 1 : 0;
+            ++count;
+         }
+         return count;
+      };
+
+      const double operationCount = static_cast<double>(NonZeroCount() + otherMatrix.NonZeroCount());
+      std::vector<size_t> rowOffsets(rowCount_ + 1, 0);
+      forEachRowRange(nullptr, rowCount_, operationCount, [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            rowOffsets[row + 1] = mergeRow(row, nullptr, nullptr);
+         }
+      });
+      std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+      std::vector<size_t> columnIndices(rowOffsets.back());
+      std::vector<ElementType> values(rowOffsets.back());
+      forEachRowRange(rowOffsets.data(), rowCount_, operationCount, [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            mergeRow(row, &columnIndices[rowOffsets[row]], &values[rowOffsets[row]]);
+         }
+      });
+      return std::make_shared<SparseMatrix<ElementType>>(rowCount_, columnCount_, std::move(rowOffsets), std::move(columnIndices), std::move(values));
+   }
+
+   OperationResult multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const
+   {
+      OperationResult result;
+      const Matrix<ElementType>& leftMatrix = anotherMatrixIsOnTheLeft ? anotherMatrix : *this;
+      const Matrix<ElementType>& rightMatrix = anotherMatrixIsOnTheLeft ? *this : anotherMatrix;
+      CheckIfCanMultiplyTogether(leftMatrix, rightMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const SparseMatrix<ElementType>* sparseMatrix = dynamic_cast<const SparseMatrix<ElementType>*>(&anotherMatrix);
+      if (sparseMatrix != nullptr)
+      {
+         result.Matrix_ = anotherMatrixIsOnTheLeft ? sparseMatrix->multiplySparse(*this) : multiplySparse(*sparseMatrix);
+         return result;
+      }
+      // Other operands are read through raw row-major storage (they are copied into a standard matrix if they have no such storage)
+      anotherMatrix.PrepareForReuse(anotherMatrixIsOnTheLeft ? columnCount_ : rowCount_);
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&anotherMatrix);
+      std::unique_ptr<StandardMatrix<ElementType>> copy;
+      if (standardMatrix == nullptr)
+      {
+         copy.reset(new StandardMatrix<ElementType>(anotherMatrix));
+         standardMatrix = copy.get();
+      }
+      auto product = std::make_shared<StandardMatrix<ElementType>>(leftMatrix.RowCount(), rightMatrix.ColumnCount());
+      if (anotherMatrixIsOnTheLeft)
+      {
+         multiplyDenseBySparse(*standardMatrix, product->Data());
+      }
+      else
+      {
+         multiplySparseByDense(*standardMatrix, product->Data());
+      }
+      result.Matrix_ = product;
+      return result;
+   }
+
+   // Product = This * matrix: every row of the product accumulates the rows of the matrix which are selected by
+   // the nonzeros of the row of This (a column vector is multiplied by SpMV)
+   void multiplySparseByDense(const StandardMatrix<ElementType>& matrix, ElementType* product) const
+   {
+      const size_t columnCount = matrix.ColumnCount();
+      const ElementType* data = matrix.Data();
+      if (columnCount == 1)
+      {
+         MultiplyVector(data, product);
+         return;
+      }
+      const Storage& storage = *storage_;
+      forEachRowRange(storage.RowOffsets_.data(), rowCount_, static_cast<double>(NonZeroCount()) * columnCount, [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            for (size_t position = storage.RowOffsets_[row]; position < storage.RowOffsets_[row + 1]; ++position)
+            {
+               // Product row += value * matrix row (by the SIMD kernel with the negated factor)
+               Kernels::SubtractScaledRow(&product[row * columnCount], &data[storage.ColumnIndices_[position] * columnCount], -storage.Values_[position], columnCount);
+            }
+         }
+      });
+   }
+
+   // Product = matrix * This: every element of a row of the matrix scales the corresponding row of This, which is
+   // scattered into the row of the product
+   void multiplyDenseBySparse(const StandardMatrix<ElementType>& matrix, ElementType* product) const
+   {
+      const size_t rowCount = matrix.RowCount();
+      const ElementType* data = matrix.Data();
+      const Storage& storage = *storage_;
+      forEachRowRange(nullptr, rowCount, static_cast<double>(NonZeroCount()) * rowCount, [&](size_t firstRow, size_t lastRow)
+      {
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            const ElementType* rowData = &data[row * rowCount_];
+            ElementType* productRow = &product[row * columnCount_];
+            for (size_t inner = 0; inner < rowCount_; ++inner)
+            {
+               const ElementType element = rowData[inner];
+               if (element == MatrixSettings::Zero<ElementType>())
+               {
+                  continue;
+               }
+               for (size_t position = storage.RowOffsets_[inner]; position < storage.RowOffsets_[inner + 1]; ++position)
+               {
+                  productRow[storage.ColumnIndices_[position]] += element * storage.Values_[position];
+               }
+            }
+         }
+      });
+   }
+
+   // SpGEMM by Gustavson's algorithm: a row of the product is accumulated in a dense row of the thread from the rows of
+   // the right matrix which are selected by the nonzeros of the row of the left one. The first pass counts nonzeros of
+   // every row of the product, the second one computes them (columns of a row are sorted then).
+   typename Matrix<ElementType>::SharedPtr multiplySparse(const SparseMatrix<ElementType>& rightMatrix) const
+   {
+      const Storage& left = *storage_;
+      const Storage& right = *rightMatrix.storage_;
+      const size_t columnCount = rightMatrix.columnCount_;
+      // Every nonzero of the left matrix selects a row of the right one (of the average number of nonzeros)
+      const double operationCount = static_cast<double>(NonZeroCount()) * rightMatrix.NonZeroCount() / std::max<size_t>(1, rightMatrix.rowCount_);
+
+      std::vector<size_t> rowOffsets(rowCount_ + 1, 0);
+      forEachRowRange(left.RowOffsets_.data(), rowCount_, operationCount, [&](size_t firstRow, size_t lastRow)
+      {
+         std::vector<size_t> lastRows(columnCount, NoRow);   // The last row of the product which has a nonzero in the column
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            size_t count = 0;
+            for (size_t leftPosition = left.RowOffsets_[row]; leftPosition < left.RowOffsets_[row + 1]; ++leftPosition)
+            {
+               const size_t inner = left.ColumnIndices_[leftPosition];
+               for (size_t rightPosition = right.RowOffsets_[inner]; rightPosition < right.RowOffsets_[inner + 1]; ++rightPosition)
+               {
+                  const size_t column = right.ColumnIndices_[rightPosition];
+                  if (lastRows[column] != row)
+                  {
+                     lastRows[column] = row;
+                     ++count;
+                  }
+               }
+            }
+            rowOffsets[row + 1] = count;
+         }
+      });
+      std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+
+      std::vector<size_t> columnIndices(rowOffsets.back());
+      std::vector<ElementType> values(rowOffsets.back());
+      forEachRowRange(left.RowOffsets_.data(), rowCount_, operationCount, [&](size_t firstRow, size_t lastRow)
+      {
+         std::vector<size_t> lastRows(columnCount, NoRow);
+         std::vector<ElementType> accumulator(columnCount);
+         for (size_t row = firstRow; row < lastRow; ++row)
+         {
+            size_t* rowColumns = &columnIndices[rowOffsets[row]];
+            size_t count = 0;
+            for (size_t leftPosition = left.RowOffsets_[row]; leftPosition < left.RowOffsets_[row + 1]; ++leftPosition)
+            {
+               const size_t inner = left.ColumnIndices_[leftPosition];
+               const ElementType leftValue = left.Values_[leftPosition];
+               for (size_t rightPosition = right.RowOffsets_[inner]; rightPosition < right.RowOffsets_[inner + 1]; ++rightPosition)
+               {
+                  const size_t column = right.ColumnIndices_[rightPosition];
+                  if (lastRows[column] != row)
+                  {
+                     lastRows[column] = row;
+                     rowColumns[count++] = column;
+                     accumulator[column] = leftValue * right.Values_[rightPosition];
+                  }
+                  else
+                  {
+                     accumulator[column] += leftValue * right.Values_[rightPosition];
+                  }
+               }
+            }
+            std::sort(rowColumns, rowColumns + count);
+            ElementType* rowValues = &values[rowOffsets[row]];
+            for (size_t index = 0; index < count; ++index)
+            {
+               rowValues[index] = accumulator[rowColumns[index]];
+            }
+         }
+      });
+      return std::make_shared<SparseMatrix<ElementType>>(rowCount_, columnCount, std::move(rowOffsets), std::move(columnIndices), std::move(values));
+   }
+
+   // Counting sort of nonzeros by columns: rows are visited in ascending order, so rows of the result are sorted
+   OperationResult transpose() const
+   {
+      OperationResult result;
+      const Storage& storage = *storage_;
+      std::vector<size_t> rowOffsets(columnCount_ + 1, 0);
+      for (size_t column : storage.ColumnIndices_)
+      {
+         ++rowOffsets[column + 1];
+      }
+      std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+      std::vector<size_t> positions(rowOffsets.begin(), rowOffsets.end() - 1);
+      std::vector<size_t> columnIndices(NonZeroCount());
+      std::vector<ElementType> values(NonZeroCount());
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         for (size_t position = storage.RowOffsets_[row]; position < storage.RowOffsets_[row + 1]; ++position)
+         {
+            const size_t transposedPosition = positions[storage.ColumnIndices_[position]]++;
+            columnIndices[transposedPosition] = row;
+            values[transposedPosition] = storage.Values_[position];
+         }
+      }
+      result.Matrix_ = std::make_shared<SparseMatrix<ElementType>>(columnCount_, rowCount_, std::move(rowOffsets), std::move(columnIndices), std::move(values));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+};
+
+template <typename ElementType> const size_t SparseMatrix<ElementType>::NoRow;
+
+} // namespace SMT
+
+#endif // __SPARSE_MATRIX_H__
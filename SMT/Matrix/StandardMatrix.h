@@ -5,28 +5,46 @@
 // Standard matrix
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <atomic>
+
 #include "MatrixDefs.h"
-#include "MatrixOperations.h"
+#include "MatrixChecks.h"
 #include "MatrixAlgorithms.h"
+#include "MatrixKernels.h"
+#include "MatrixMemory.h"
+#include "MatrixSimd.h"
 
 namespace SMT
 {
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Standard matrix.
 // It represents as a vector.
-// Very simple but not optimized.
+// Very simple. Multiplication of two standard matrices uses the packed (and multithreaded) GEMM kernel (see MatrixKernels.h).
 template <typename ElementType>
 class StandardMatrix 
    : public Matrix<ElementType>
    , public Matrix<ElementType>::IElementaryOperations
+   , public Matrix<ElementType>::IInPlaceOperations
 {
 public:
    using InitFunc = std::function<ElementType (size_t /*column*/, size_t /*row*/)>; // A function which initializes all matrix elements
-   StandardMatrix(size_t rowCount, size_t columnCount, InitFunc initFunc)
-      : ownData_(new std::vector<ElementType>(rowCount * columnCount, MatrixSettings::Zero<ElementType>()))
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+   using IElementaryOperations = typename Matrix<ElementType>::IElementaryOperations;
+   using IInPlaceOperations = typename Matrix<ElementType>::IInPlaceOperations;
+   // Creates a zero matrix. Elements are allocated by the resource (nullptr means MemorySettings::DefaultResource()).
+   StandardMatrix(size_t rowCount, size_t columnCount, MemoryResource* resource = nullptr)
+      : ownData_(std::make_shared<MatrixBuffer<ElementType>>(rowCount * columnCount, MatrixSettings::Zero<ElementType>(), resource))
       , rowCount_(rowCount)
       , columnCount_(columnCount)
-      , data_(&((*ownData_)[0]))
+      , data_(ownData_->Data())
+   {
+   }
+   StandardMatrix(size_t rowCount, size_t columnCount, InitFunc initFunc, MemoryResource* resource = nullptr)
+      : ownData_(std::make_shared<MatrixBuffer<ElementType>>(rowCount * columnCount, MatrixSettings::Zero<ElementType>(), resource))
+      , rowCount_(rowCount)
+      , columnCount_(columnCount)
+      , data_(ownData_->Data())
    {
       assert(initFunc);
       if (initFunc)
@@ -45,22 +63,57 @@ public:
          init(rowCount_, columnCount_, initFunc);
       }
    }
-   explicit StandardMatrix(const Matrix<ElementType>& sourceMatrix)
-      : ownData_(new std::vector<ElementType>(sourceMatrix.RowCount() * sourceMatrix.ColumnCount()))
+   explicit StandardMatrix(const Matrix<ElementType>& sourceMatrix, MemoryResource* resource = nullptr)
+      : ownData_(std::make_shared<MatrixBuffer<ElementType>>(sourceMatrix.RowCount() * sourceMatrix.ColumnCount(), resource))
       , rowCount_(sourceMatrix.RowCount())
       , columnCount_(sourceMatrix.ColumnCount())
-      , data_(&((*ownData_)[0]))
+      , data_(ownData_->Data())
    {
-      auto initFunc = [&sourceMatrix](size_t row, size_t column)->ElementType { return sourceMatrix.Element(row, column); };
-      init(rowCount_, columnCount_, initFunc);
+      sourceMatrix.CopyTo(data_, columnCount_);
    }
+   // Adopts row-major elements without copying them (buffer.Size() has to equal rowCount * columnCount)
+   StandardMatrix(size_t rowCount, size_t columnCount, MatrixBuffer<ElementType>&& buffer)
+      : ownData_(std::make_shared<MatrixBuffer<ElementType>>(std::move(buffer)))
+      , rowCount_(rowCount)
+      , columnCount_(columnCount)
+      , data_(ownData_->Data())
+   {
+      assert(ownData_->Size() == rowCount_ * columnCount_);
+   }
+   StandardMatrix(size_t rowCount, size_t columnCount, std::vector<ElementType>&& elements)
+      : StandardMatrix(rowCount, columnCount, MatrixBuffer<ElementType>(std::move(elements)))
+   {
+   }
+   // The copy shares elements: own storage is copied on the first change of one of the matrices (copy-on-write),
+   // a matrix over external data shares the data
    explicit StandardMatrix(const StandardMatrix<ElementType>& sourceMatrix)
-      : ownData_(sourceMatrix.ownData_ == nullptr ? nullptr : new std::vector<ElementType>(sourceMatrix))
+      : ownData_(sourceMatrix.ownData_)
       , rowCount_(sourceMatrix.rowCount_)
       , columnCount_(sourceMatrix.columnCount_)
-      , data_(sourceMatrix.ownData_.empty() ? sourceMatrix.data_ : &ownData_[0])
+      , data_(sourceMatrix.data_)
    {
    }
+   // The storage is moved, the source matrix becomes empty (0 x 0)
+   StandardMatrix(StandardMatrix<ElementType>&& sourceMatrix) noexcept
+      : ownData_(std::move(sourceMatrix.ownData_))
+      , rowCount_(sourceMatrix.rowCount_)
+      , columnCount_(sourceMatrix.columnCount_)
+      , data_(sourceMatrix.data_)
+   {
+      sourceMatrix.clear();
+   }
+   StandardMatrix& operator=(StandardMatrix<ElementType>&& sourceMatrix) noexcept
+   {
+      if (&sourceMatrix != this)
+      {
+         ownData_ = std::move(sourceMatrix.ownData_);
+         rowCount_ = sourceMatrix.rowCount_;
+         columnCount_ = sourceMatrix.columnCount_;
+         data_ = sourceMatrix.data_;
+         sourceMatrix.clear();
+      }
+      return *this;
+   }
 
    static OperationResult Add(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
    {
@@ -70,10 +123,10 @@ public:
       {
          return result;
       }
-	  
-      auto initFunc = [&matrix1, &matrix2](size_t row, size_t column)->ElementType { return matrix1.Element(row, column) + matrix2.Element(row, column); };
-      result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(matrix1.RowCount(), matrix1.ColumnCount(), initFunc);
-      result.Code_ = OperationResultCode::Ok;
+
+      auto sum = std::make_shared<StandardMatrix<ElementType>>(matrix1);
+      result = sum->addInPlace(matrix2);
+      result.Matrix_ = sum;
       return result;
    }
    
@@ -85,18 +138,35 @@ public:
       {
          return result;
       }
-      const size_t numberOfItems = leftMatrix.ColumnCount();
-      auto initFunc = [&leftMatrix, &rightMatrix, numberOfItems](size_t row, size_t column)-> ElementType 
-      { 
-         ElementType result = MatrixSettings::Zero<ElementType>();
-         for (size_t i = 0; i < numberOfItems; ++i)
-         {
-            result += leftMatrix.Element(row, i) * rightMatrix.Element(i, column);
-         }
+      auto product = std::make_shared<StandardMatrix<ElementType>>(leftMatrix.RowCount(), rightMatrix.ColumnCount());
+      result = product->multiplyInto(leftMatrix, rightMatrix, MatrixSettings::One<ElementType>(), MatrixSettings::Zero<ElementType>());
+      result.Matrix_ = product;
+      return result;
+   }
+
+   // The product by the Strassen-Winograd algorithm (see Kernels::StrassenWinogradGemm() for its error bound): blocks are
+   // split while all dimensions are greater than crossoverSize. Temporary blocks are allocated from workspace (the
+   // default resource if it is nullptr), so a pool makes repeated products allocation-free.
+   static OperationResult MultiplyStrassenWinograd(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, size_t crossoverSize, MemoryResource* workspace = nullptr)
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(leftMatrix, rightMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
          return result;
-      };
-      result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(leftMatrix.RowCount(), rightMatrix.ColumnCount(), initFunc);
-      result.Code_ = OperationResultCode::Ok;
+      }
+      leftMatrix.PrepareForReuse(rightMatrix.ColumnCount());
+      rightMatrix.PrepareForReuse(leftMatrix.RowCount());
+      auto product = std::make_shared<StandardMatrix<ElementType>>(leftMatrix.RowCount(), rightMatrix.ColumnCount());
+      std::unique_ptr<StandardMatrix<ElementType>> leftCopy;
+      std::unique_ptr<StandardMatrix<ElementType>> rightCopy;
+      const StandardMatrix<ElementType>* leftStandardMatrix = product->gemmOperand(leftMatrix, leftCopy);
+      const StandardMatrix<ElementType>* rightStandardMatrix = product->gemmOperand(rightMatrix, rightCopy);
+      const size_t innerCount = leftMatrix.ColumnCount();
+      MatrixBuffer<ElementType> buffer(Kernels::StrassenWinogradWorkspaceSize(product->rowCount_, product->columnCount_, innerCount, crossoverSize), workspace);
+      Kernels::StrassenWinogradGemm<ElementType>(product->rowCount_, product->columnCount_, innerCount, leftStandardMatrix->data_, innerCount,
+         rightStandardMatrix->data_, product->columnCount_, product->data_, product->columnCount_, crossoverSize, buffer.Data());
+      result.Matrix_ = product;
       return result;
    }
 
@@ -105,7 +175,17 @@ public:
    virtual size_t ColumnCount() const override { return columnCount_; }
    virtual ElementType Element(size_t row, size_t column) const override { return data_[row * columnCount_ + column]; }
    virtual std::string TypeName() const { return "StandardMatrix"; }
-   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Quadratic; }
+   virtual const ElementType* RowData(size_t row) const override { return &data_[row * columnCount_]; }
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         const ElementType* source = &data_[(row + tileRow) * columnCount_ + column];
+         std::copy(source, source + columnCount, &buffer[tileRow * stride]);
+      }
+   }
+   // Own storage is shared by the copy (see the copy constructor), external data is copied
+   virtual Complexity::Type CopyingComplexity() const override { return (ownData_ != nullptr) ? Complexity::Constant : Complexity::Quadratic; }
    virtual OperationResult Copy() const override { return copy(); }
    virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& otherMatrix) const override{ return Complexity::Quadratic; }
    virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override{ return Add(*this, otherMatrix); }
@@ -114,23 +194,106 @@ public:
    virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override { return Complexity::Cubic; }
    virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override{ return anotherMatrixIsOnTheLeft ? Multiply(anotherMatrix, *this) : Multiply(*this, anotherMatrix); }
    virtual Complexity::Type InversionComplexity() const override { return Complexity::Cubic; }
-   virtual OperationResult Invert() const override { return Algorithms::GaussJordanElimination<ElementType>(*this, createIdentityMatrix); }
+   virtual OperationResult Invert() const override { return invert(); }
    virtual Complexity::Type TransposeComplexity() const override { return Complexity::Quadratic; }
    virtual OperationResult Transpose() const override { return transpose(); }
    virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Cubic; }
-   virtual ScalarOperationResult Determinant() const override { return Algorithms::CalcDeterminant_GaussJordanElimination<ElementType>(*this); }
+   virtual ScalarOperationResult Determinant() const override { return determinant(); }
+   virtual Complexity::Type SolvingComplexity(const Matrix<ElementType>& /*rightHandSide*/) const override { return Complexity::Cubic; }
+   virtual OperationResult Solve(const Matrix<ElementType>& rightHandSide) const override { return solve(rightHandSide); }
    virtual IElementaryOperations* ElementaryOperations() { return this; }
    // Matrix::IElementaryOperations
    virtual bool SwapRows(size_t rowIndex1, size_t rowIndex2) { return swap(rowIndex1, rowIndex2); }
    virtual bool MultiplyRowByNumber(size_t rowIndex, ElementType number) { return multiplyByNumber(rowIndex, number); }
    virtual bool MultiplyAndSubtract(size_t rowIndex1, size_t rowIndex2, ElementType number) { return multiplyAndSubtract(rowIndex1, rowIndex2, number); }
+   virtual IInPlaceOperations* InPlaceOperations() override { return this; }
+   // Matrix::IInPlaceOperations
+   virtual OperationResult AddInPlace(const Matrix<ElementType>& matrix) override { return addInPlace(matrix); }
+   virtual OperationResult ScaleInPlace(const ElementType& number) override { return scaleInPlace(number); }
+   virtual OperationResult CopyFrom(const Matrix<ElementType>& matrix) override { return copyFrom(matrix); }
+   virtual OperationResult AddInto(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2) override { return addInto(matrix1, matrix2); }
+   virtual OperationResult MultiplyInto(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, const ElementType& alpha, const ElementType& beta) override { return multiplyInto(leftMatrix, rightMatrix, alpha, beta); }
+   virtual OperationResult TransposeInto(const Matrix<ElementType>& matrix) override { return transposeInto(matrix); }
+   virtual OperationResult InvertInto(const Matrix<ElementType>& matrix) override { return invertInto(matrix); }
+
+   // Row-major storage of the matrix (RowCount() x ColumnCount() elements).
+   // Own storage is aligned to the cache line (unless it has been adopted from a vector).
+   // The non-constant access may change elements, so storage which is shared with copies is copied before.
+   ElementType* Data()
+   {
+      detach();
+      return data_;
+   }
+   const ElementType* Data() const { return data_; }
+   // The non-constant access for operations which overwrite every element without reading them: storage which is
+   // shared with copies is replaced by new storage (nothing is copied), so the elements are undefined.
+   ElementType* DataForOverwrite()
+   {
+      detach(false);
+      return data_;
+   }
+
+   // Hands the own storage over to the caller and leaves the matrix empty (0 x 0). The buffer is empty if the matrix
+   // uses external data. Elements which have been adopted from a vector are taken back by MatrixBuffer::ReleaseVector().
+   MatrixBuffer<ElementType> Release()
+   {
+      detach();
+      MatrixBuffer<ElementType> buffer;
+      if (ownData_ != nullptr)
+      {
+         buffer = std::move(*ownData_);
+      }
+      clear();
+      return buffer;
+   }
+
+   // Transposes the matrix without allocating another one (non-square matrices swap the row and column counts)
+   void TransposeInPlace()
+   {
+      detach();
+      Kernels::TransposeInPlace(rowCount_, columnCount_, data_);
+      std::swap(rowCount_, columnCount_);
+   }
+
+   // LU decomposition of the matrix (it can be reused for the determinant, the inverse and linear solves)
+   Algorithms::LUDecomposition<ElementType> FactorizeLU() const
+   {
+      if (rowCount_ != columnCount_)
+      {
+         return Algorithms::LUDecomposition<ElementType>(static_cast<const Matrix<ElementType>&>(*this));
+      }
+      return Algorithms::LUDecomposition<ElementType>(rowCount_, data_, columnCount_);
+   }
 
 private:
-   std::unique_ptr<std::vector<ElementType>> ownData_;
-   const size_t rowCount_;
-   const size_t columnCount_;
+   std::shared_ptr<MatrixBuffer<ElementType>> ownData_;  // Shared with copies until one of them is changed; nullptr if the matrix uses external data
+   size_t rowCount_;
+   size_t columnCount_;
    ElementType* data_;
 
+   // Copy-on-write: the matrix gets its own storage before it is changed. Elements are copied into it if keepElements
+   // is true (an operation which overwrites all elements doesn't need them).
+   void detach(bool keepElements = true)
+   {
+      if ((ownData_ == nullptr) || (ownData_.use_count() == 1))
+      {
+         // use_count() is a relaxed read: the fence orders the writes after the release of the storage by the copy
+         // which has been destroyed in another thread
+         std::atomic_thread_fence(std::memory_order_acquire);
+         return;
+      }
+      ownData_ = keepElements ? std::make_shared<MatrixBuffer<ElementType>>(*ownData_) : std::make_shared<MatrixBuffer<ElementType>>(ownData_->Size(), ownData_->Resource());
+      data_ = ownData_->Data();
+   }
+
+   void clear() noexcept
+   {
+      ownData_.reset();
+      rowCount_ = 0;
+      columnCount_ = 0;
+      data_ = nullptr;
+   }
+
    void init(size_t rowCount, size_t columnCount, InitFunc initFunc)
    {
       for (size_t rowIndex = 0; rowIndex < rowCount; ++rowIndex)
@@ -146,7 +309,14 @@ private:
    OperationResult copy() const
    {
       OperationResult result;
-      result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(static_cast<const Matrix<ElementType>&>(*this));
+      if (ownData_ != nullptr)
+      {
+         result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(*this);
+      }
+      else
+      {
+         result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(static_cast<const Matrix<ElementType>&>(*this));
+      }
       result.Code_ = OperationResultCode::Ok;
       return result;
    }
@@ -154,22 +324,236 @@ private:
    OperationResult multiplyByNumber(const ElementType& number) const
    { 
       OperationResult result;
-      const Matrix& matrix = *this;
-      auto initFunc = [&matrix, number](size_t row, size_t column)->ElementType { return matrix.Element(row, column) * number; };
-      result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(RowCount(), ColumnCount(), initFunc);
-      result.Code_ = OperationResultCode::Ok;
+      auto product = std::make_shared<StandardMatrix<ElementType>>(static_cast<const Matrix<ElementType>&>(*this));
+      result = product->scaleInPlace(number);
+      result.Matrix_ = product;
       return result;
    }
    
+   OperationResult addInPlace(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, matrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      detach();
+      RowReader<ElementType> reader(matrix);
+      for (size_t row = 0; row < rowCount_; ++row)
+      {
+         const ElementType* source = reader.Row(row);
+         ElementType* destination = &data_[row * columnCount_];
+         for (size_t column = 0; column < columnCount_; ++column)
+         {
+            destination[column] += source[column];
+         }
+      }
+      return result;
+   }
+
+   OperationResult scaleInPlace(const ElementType& number)
+   {
+      OperationResult result;
+      detach();
+      Kernels::ScaleRow(data_, number, rowCount_ * columnCount_);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+
+   OperationResult copyFrom(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      CheckIfCanHoldResult(*this, matrix.RowCount(), matrix.ColumnCount(), result.Code_, result.Description_);
+      if ((result.Code_ != OperationResultCode::Error) && (&matrix != this))
+      {
+         detach(false);
+         matrix.CopyTo(data_, columnCount_);
+      }
+      return result;
+   }
+
+   OperationResult addInto(const Matrix<ElementType>& matrix1, const Matrix<ElementType>& matrix2)
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(matrix1, matrix2, result.Code_, result.Description_);
+      if (result.Code_ != OperationResultCode::Error)
+      {
+         CheckIfCanHoldResult(*this, matrix1.RowCount(), matrix1.ColumnCount(), result.Code_, result.Description_);
+      }
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      // Addition is commutative, so the matrix itself is never overwritten before it is read
+      if (&matrix2 == this)
+      {
+         return addInPlace(matrix1);
+      }
+      copyFrom(matrix1);
+      return addInPlace(matrix2);
+   }
+
+   // Operands of the packed (multithreaded for large matrices) GEMM kernel have to have raw storage which differs from
+   // the storage of the result: other operands are copied into standard matrices (by bulk access)
+   const StandardMatrix<ElementType>* gemmOperand(const Matrix<ElementType>& matrix, std::unique_ptr<StandardMatrix<ElementType>>& copy) const
+   {
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&matrix);
+      if ((standardMatrix != nullptr) && (standardMatrix->data_ != data_))
+      {
+         return standardMatrix;
+      }
+      copy.reset(new StandardMatrix<ElementType>(matrix));
+      return copy.get();
+   }
+
+   OperationResult multiplyInto(const Matrix<ElementType>& leftMatrix, const Matrix<ElementType>& rightMatrix, const ElementType& alpha, const ElementType& beta)
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(leftMatrix, rightMatrix, result.Code_, result.Description_);
+      if (result.Code_ != OperationResultCode::Error)
+      {
+         CheckIfCanHoldResult(*this, leftMatrix.RowCount(), rightMatrix.ColumnCount(), result.Code_, result.Description_);
+      }
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      leftMatrix.PrepareForReuse(rightMatrix.ColumnCount());
+      rightMatrix.PrepareForReuse(leftMatrix.RowCount());
+      // Elements are needed if they are scaled by beta or if the matrix itself is an operand
+      detach((beta != MatrixSettings::Zero<ElementType>()) || (&leftMatrix == this) || (&rightMatrix == this));
+      std::unique_ptr<StandardMatrix<ElementType>> leftCopy;
+      std::unique_ptr<StandardMatrix<ElementType>> rightCopy;
+      const StandardMatrix<ElementType>* leftStandardMatrix = gemmOperand(leftMatrix, leftCopy);
+      const StandardMatrix<ElementType>* rightStandardMatrix = gemmOperand(rightMatrix, rightCopy);
+      Kernels::ParallelGemm<ElementType>(rowCount_, columnCount_, leftStandardMatrix->columnCount_,
+         alpha, leftStandardMatrix->data_, leftStandardMatrix->columnCount_, rightStandardMatrix->data_, rightStandardMatrix->columnCount_,
+         beta, data_, columnCount_);
+      return result;
+   }
+
    OperationResult transpose() const
    {
       OperationResult result;
-      auto initFunc = [this](size_t row, size_t column)->ElementType { return Element(column, row); };
-      result.Matrix_ = std::make_shared<StandardMatrix<ElementType>>(ColumnCount(), RowCount(), initFunc);
+      auto transposed = std::make_shared<StandardMatrix<ElementType>>(columnCount_, rowCount_);
+      result = transposed->transposeInto(*this);
+      result.Matrix_ = transposed;
+      return result;
+   }
+
+   OperationResult transposeInto(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      CheckIfCanHoldResult(*this, matrix.ColumnCount(), matrix.RowCount(), result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      detach(&matrix == this);
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&matrix);
+      if ((standardMatrix != nullptr) && (standardMatrix->data_ == data_))
+      {
+         // The matrix is transposed into itself, so it is square here
+         Kernels::TransposeSquareInPlace(rowCount_, data_, columnCount_);
+         return result;
+      }
+      if (standardMatrix != nullptr)
+      {
+         Kernels::Transpose(standardMatrix->rowCount_, standardMatrix->columnCount_, standardMatrix->data_, standardMatrix->columnCount_, data_, columnCount_);
+         return result;
+      }
+      // Other matrices are read tile by tile, every tile is transposed into its mirrored place
+      const size_t tileSize = Kernels::TransposeBlocking<ElementType>::Tile;
+      std::vector<ElementType> tile(tileSize * tileSize);
+      for (size_t row = 0; row < matrix.RowCount(); row += tileSize)
+      {
+         const size_t tileRowCount = std::min(tileSize, matrix.RowCount() - row);
+         for (size_t column = 0; column < matrix.ColumnCount(); column += tileSize)
+         {
+            const size_t tileColumnCount = std::min(tileSize, matrix.ColumnCount() - column);
+            matrix.CopyTile(row, column, tileRowCount, tileColumnCount, tile.data(), tileColumnCount);
+            Kernels::Transpose(tileRowCount, tileColumnCount, tile.data(), tileColumnCount, &data_[column * columnCount_ + row], columnCount_);
+         }
+      }
+      return result;
+   }
+
+   OperationResult invert() const
+   {
+      OperationResult result;
+      auto inverse = std::make_shared<StandardMatrix<ElementType>>(rowCount_, columnCount_);
+      result = inverse->invertInto(*this);
+      if (result.Code_ != OperationResultCode::Error)
+      {
+         result.Matrix_ = inverse;
+      }
+      return result;
+   }
+
+   OperationResult invertInto(const Matrix<ElementType>& matrix)
+   {
+      OperationResult result;
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&matrix);
+      // The decomposition keeps its own copy of elements, so the matrix may be inverted into itself
+      const auto decomposition = (standardMatrix != nullptr) ? standardMatrix->FactorizeLU() : Algorithms::LUDecomposition<ElementType>(matrix);
+      if (decomposition.Code() == OperationResultCode::Error)
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Matrix can't be inverted: the number of rows (=" + std::to_string(matrix.RowCount()) + ") doesn't equal the number of columns (=" + std::to_string(matrix.ColumnCount()) + ")";
+         return result;
+      }
+      CheckIfCanHoldResult(*this, matrix.RowCount(), matrix.ColumnCount(), result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      if (decomposition.IsSingular())
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Matrix can't be inverted: it is not invertible";
+         return result;
+      }
+      detach(false);
+      decomposition.Invert(data_, columnCount_);
+      return result;
+   }
+
+   ScalarOperationResult determinant() const
+   {
+      ScalarOperationResult result;
+      const auto decomposition = FactorizeLU();
+      if (decomposition.Code() == OperationResultCode::Error)
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Determinant can't be calculated: the number of rows (=" + std::to_string(rowCount_) + ") doesn't equal the number of columns (=" + std::to_string(columnCount_) + ")";
+         return result;
+      }
+      result.Value_.reset(new ElementType(decomposition.Determinant()));
       result.Code_ = OperationResultCode::Ok;
       return result;
    }
 
+   OperationResult solve(const Matrix<ElementType>& rightHandSide) const
+   {
+      OperationResult result;
+      CheckIfCanSolve(*this, rightHandSide, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const auto decomposition = FactorizeLU();
+      auto solution = std::make_shared<StandardMatrix<ElementType>>(rightHandSide);
+      if (!decomposition.Solve(solution->data_, solution->columnCount_, solution->columnCount_))
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Linear system can't be solved: the matrix is not invertible";
+         return result;
+      }
+      result.Matrix_ = solution;
+      return result;
+   }
+
    bool swap(size_t rowIndex1, size_t rowIndex2)
    {
       if (rowIndex1 >= rowCount_ || rowIndex2 >= rowCount_)
@@ -180,14 +564,8 @@ private:
       {
          return true;
       }
-      auto row1 = &data_[rowIndex1 * columnCount_];
-      auto row2 = &data_[rowIndex2 * columnCount_];
-      for (size_t column = 0; column < columnCount_; ++column)
-      {
-         const auto buffer = row1[column];
-         row1[column] = row2[column];
-         row2[column] = buffer;
-      }
+      detach();
+      Kernels::SwapRows(&data_[rowIndex1 * columnCount_], &data_[rowIndex2 * columnCount_], columnCount_);
       return true;
    }
 
@@ -197,11 +575,8 @@ private:
       {
          return false;
       }
-      auto row = &data_[rowIndex * columnCount_];
-      for (size_t column = 0; column < columnCount_; ++column)
-      {
-         row[column] *= number;
-      }
+      detach();
+      Kernels::ScaleRow(&data_[rowIndex * columnCount_], number, columnCount_);
       return true;
    }
 
@@ -211,23 +586,10 @@ private:
       {
          return false;
       }
-      auto row1 = &data_[rowIndex1 * columnCount_];
-      auto row2 = &data_[rowIndex2 * columnCount_];
-      for (size_t column = 0; column < columnCount_; ++column)
-      {
-         row1[column] -= row2[column] * number;
-      }
+      detach();
+      Kernels::SubtractScaledRow(&data_[rowIndex1 * columnCount_], &data_[rowIndex2 * columnCount_], number, columnCount_);
       return true;
    }
-
-   static Matrix<ElementType>::SharedPtr createIdentityMatrix(size_t size)
-   {
-      auto initFunc = [](size_t row, size_t column) -> ElementType
-      {
-         return (row == column) ? MatrixSettings::One<ElementType>() : MatrixSettings::Zero<ElementType>();
-      };
-      return std::make_shared<StandardMatrix<ElementType>>(size, size, initFunc);
-   }
 };
 
 } // namespace SMT
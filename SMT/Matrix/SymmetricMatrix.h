@@ -0,0 +1,307 @@
+#ifndef __SYMMETRIC_MATRIX_H__
+#define __SYMMETRIC_MATRIX_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Symmetric matrix
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixAlgorithms.h"
+#include "MatrixChecks.h"
+#include "MatrixKernels.h"
+#include "MatrixSimd.h"
+#include "StandardMatrix.h"
+#include "../Threading/ThreadPool.h"
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Symmetric matrix.
+// It represents as the packed lower triangle: rows of the triangle are stored one after another (row i keeps the
+// columns [0, i], N * (N + 1) / 2 elements), the element (row, column) above the diagonal is the element (column, row).
+//    So covariance and Gram matrices take half of the memory. RankKUpdate() computes A^T * A at half of the flops of
+//    the general product. The inverse, the determinant and linear solves use the Cholesky decomposition (~N^3 / 6)
+//    when the matrix is positive definite and LU with partial pivoting of a standard copy (~N^3 / 3) when it isn't.
+//    The matrix is immutable, so copies share the triangle.
+template <typename ElementType>
+class SymmetricMatrix : public Matrix<ElementType>
+{
+public:
+   using InitFunc = std::function<ElementType (size_t /*row*/, size_t /*column*/)>; // A function which initializes elements of the lower triangle
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+   static const size_t BlockSize = 64;
+
+   // Creates a zero matrix
+   explicit SymmetricMatrix(size_t size)
+      : SymmetricMatrix(size, std::vector<ElementType>(size * (size + 1) / 2, MatrixSettings::Zero<ElementType>()))
+   {
+   }
+   // initFunc is called for elements of the lower triangle only (column <= row)
+   SymmetricMatrix(size_t size, const InitFunc& initFunc)
+      : size_(size)
+   {
+      std::vector<ElementType> elements(size_ * (size_ + 1) / 2);
+      for (size_t row = 0; row < size_; ++row)
+      {
+         for (size_t column = 0; column <= row; ++column)
+         {
+            elements[rowOffset(row) + column] = initFunc(row, column);
+         }
+      }
+      elements_ = std::make_shared<const std::vector<ElementType>>(std::move(elements));
+   }
+   // Takes the lower triangle of the matrix (the upper one is ignored)
+   explicit SymmetricMatrix(const Matrix<ElementType>& sourceMatrix)
+      : size_(sourceMatrix.RowCount())
+   {
+      assert(sourceMatrix.RowCount() == sourceMatrix.ColumnCount());
+      std::vector<ElementType> elements(size_ * (size_ + 1) / 2);
+      for (size_t row = 0; row < size_; ++row)
+      {
+         sourceMatrix.CopyTile(row, 0, 1, row + 1, &elements[rowOffset(row)], size_);
+      }
+      elements_ = std::make_shared<const std::vector<ElementType>>(std::move(elements));
+   }
+   // Adopts the packed lower triangle (size * (size + 1) / 2 elements, see the class description)
+   SymmetricMatrix(size_t size, std::vector<ElementType>&& elements)
+      : size_(size)
+      , elements_(std::make_shared<const std::vector<ElementType>>(std::move(elements)))
+   {
+      assert(elements_->size() == size_ * (size_ + 1) / 2);
+   }
+
+   // Symmetric rank-k update (SYRK): alpha * A^T * A for any matrix A.
+   // Only blocks of the lower triangle are computed (by the GEMM kernel, in parallel for large products).
+   static std::shared_ptr<SymmetricMatrix<ElementType>> RankKUpdate(const Matrix<ElementType>& matrix, const ElementType& alpha = MatrixSettings::One<ElementType>())
+   {
+      return rankKUpdate(matrix, alpha);
+   }
+
+   // The packed lower triangle
+   const ElementType* Elements() const { return elements_->data(); }
+
+   // Matrix
+   virtual size_t RowCount() const override { return size_; }
+   virtual size_t ColumnCount() const override { return size_; }
+   virtual ElementType Element(size_t row, size_t column) const override
+   {
+      return (column <= row) ? (*elements_)[rowOffset(row) + column] : (*elements_)[rowOffset(column) + row];
+   }
+   virtual std::string TypeName() const { return "SymmetricMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   // The part of a tile row on and below the diagonal is contiguous, the part above it is gathered from the column
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         const size_t currentRow = row + tileRow;
+         ElementType* destination = &buffer[tileRow * stride];
+         const size_t last = std::min(column + columnCount, currentRow + 1);
+         if (column < last)
+         {
+            const ElementType* source = &(*elements_)[rowOffset(currentRow) + column];
+            std::copy(source, source + (last - column), destination);
+         }
+         for (size_t currentColumn = std::max(column, currentRow + 1); currentColumn < column + columnCount; ++currentColumn)
+         {
+            destination[currentColumn - column] = (*elements_)[rowOffset(currentColumn) + currentRow];
+         }
+      }
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<SymmetricMatrix<ElementType>>(*this);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The sum of symmetric matrices is symmetric, other sums are standard
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& /*otherMatrix*/) const override { return Complexity::Quadratic; }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const SymmetricMatrix<ElementType>* symmetricMatrix = dynamic_cast<const SymmetricMatrix<ElementType>*>(&otherMatrix);
+      if (symmetricMatrix == nullptr)
+      {
+         return StandardMatrix<ElementType>::Add(otherMatrix, *this);
+      }
+      std::vector<ElementType> elements(*elements_);
+      Kernels::SubtractScaledRow(elements.data(), symmetricMatrix->Elements(), -MatrixSettings::One<ElementType>(), elements.size());
+      result.Matrix_ = std::make_shared<SymmetricMatrix<ElementType>>(size_, std::move(elements));
+      return result;
+   }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Quadratic; }
+   virtual OperationResult MultiplyByNumber(const ElementType& number) const override
+   {
+      OperationResult result;
+      std::vector<ElementType> elements(*elements_);
+      Kernels::ScaleRow(elements.data(), number, elements.size());
+      result.Matrix_ = std::make_shared<SymmetricMatrix<ElementType>>(size_, std::move(elements));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // Products aren't symmetric in general: the GEMM kernel reads the matrix by tiles (see CopyTile())
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& /*anotherMatrix*/, bool /*anotherMatrixIsOnTheLeft*/) const override { return Complexity::Cubic; }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override
+   {
+      return anotherMatrixIsOnTheLeft ? StandardMatrix<ElementType>::Multiply(anotherMatrix, *this) : StandardMatrix<ElementType>::Multiply(*this, anotherMatrix);
+   }
+   // The inverse is symmetric
+   virtual Complexity::Type InversionComplexity() const override { return Complexity::Cubic; }
+   virtual OperationResult Invert() const override
+   {
+      OperationResult result;
+      StandardMatrix<ElementType> inverse(size_, size_, MatrixSettings::IdentityMatrixFunction<ElementType>());
+      if (!solve(inverse.Data(), size_))
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Matrix can't be inverted: it is not invertible";
+         return result;
+      }
+      result.Matrix_ = std::make_shared<SymmetricMatrix<ElementType>>(inverse);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Transpose() const override { return Copy(); }
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Cubic; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      const std::vector<ElementType> lowerTriangle = unpack();
+      const Algorithms::CholeskyDecomposition<ElementType> cholesky(size_, lowerTriangle.data(), size_);
+      if (cholesky.IsPositiveDefinite())
+      {
+         result.Value_.reset(new ElementType(cholesky.Determinant()));
+      }
+      else
+      {
+         result.Value_.reset(new ElementType(StandardMatrix<ElementType>(*this).FactorizeLU().Determinant()));
+      }
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   virtual Complexity::Type SolvingComplexity(const Matrix<ElementType>& /*rightHandSide*/) const override { return Complexity::Cubic; }
+   virtual OperationResult Solve(const Matrix<ElementType>& rightHandSide) const override
+   {
+      OperationResult result;
+      CheckIfCanSolve(*this, rightHandSide, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      auto solution = std::make_shared<StandardMatrix<ElementType>>(rightHandSide);
+      if (!solve(solution->Data(), rightHandSide.ColumnCount()))
+      {
+         result.Code_ = OperationResultCode::Error;
+         result.Description_ = "Linear system can't be solved: the matrix is not invertible";
+         return result;
+      }
+      result.Matrix_ = solution;
+      return result;
+   }
+
+private:
+   size_t size_;
+   std::shared_ptr<const std::vector<ElementType>> elements_;   // Immutable, shared with copies
+
+   static size_t rowOffset(size_t row) { return row * (row + 1) / 2; }
+
+   // The lower triangle in a row-major size x size buffer (for factorizations)
+   std::vector<ElementType> unpack() const
+   {
+      std::vector<ElementType> result(size_ * size_, MatrixSettings::Zero<ElementType>());
+      for (size_t row = 0; row < size_; ++row)
+      {
+         std::copy(&(*elements_)[rowOffset(row)], &(*elements_)[rowOffset(row)] + row + 1, &result[row * size_]);
+      }
+      return result;
+   }
+
+   // Replaces the row-major size x columnCount matrix B by the solution of This * X = B: Cholesky if the matrix is
+   // positive definite, otherwise pivoted LU (a factorization without pivoting is unstable for indefinite matrices)
+   bool solve(ElementType* b, size_t columnCount) const
+   {
+      const std::vector<ElementType> lowerTriangle = unpack();
+      const Algorithms::CholeskyDecomposition<ElementType> cholesky(size_, lowerTriangle.data(), size_);
+      if (cholesky.IsPositiveDefinite())
+      {
+         return cholesky.Solve(b, columnCount, columnCount);
+      }
+      return StandardMatrix<ElementType>(*this).FactorizeLU().Solve(b, columnCount, columnCount);
+   }
+
+   static std::shared_ptr<SymmetricMatrix<ElementType>> rankKUpdate(const Matrix<ElementType>& matrix, const ElementType& alpha)
+   {
+      const size_t rowCount = matrix.RowCount();
+      const size_t size = matrix.ColumnCount();
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&matrix);
+      std::unique_ptr<StandardMatrix<ElementType>> copy;
+      if (standardMatrix == nullptr)
+      {
+         copy.reset(new StandardMatrix<ElementType>(matrix));
+         standardMatrix = copy.get();
+      }
+      const ElementType* a = standardMatrix->Data();
+      std::vector<ElementType> transposed(size * rowCount);
+      Kernels::Transpose(rowCount, size, a, size, transposed.data(), rowCount);
+
+      // Block (I, J) of the lower triangle (J <= I) is A^T(block rows I) * A(block columns J)
+      const size_t blockCount = (size + BlockSize - 1) / BlockSize;
+      std::vector<std::pair<size_t, size_t>> blocks;
+      for (size_t blockRow = 0; blockRow < blockCount; ++blockRow)
+      {
+         for (size_t blockColumn = 0; blockColumn <= blockRow; ++blockColumn)
+         {
+            blocks.emplace_back(blockRow, blockColumn);
+         }
+      }
+      std::vector<ElementType> elements(size * (size + 1) / 2);
+      auto computeBlock = [&](size_t index)
+      {
+         const size_t firstRow = blocks[index].first * BlockSize;
+         const size_t firstColumn = blocks[index].second * BlockSize;
+         const size_t blockRowCount = std::min(BlockSize, size - firstRow);
+         const size_t blockColumnCount = std::min(BlockSize, size - firstColumn);
+         std::vector<ElementType> tile(blockRowCount * blockColumnCount);
+         Kernels::Gemm<ElementType>(blockRowCount, blockColumnCount, rowCount, alpha, &transposed[firstRow * rowCount], rowCount,
+            &a[firstColumn], size, MatrixSettings::Zero<ElementType>(), tile.data(), blockColumnCount);
+         for (size_t row = firstRow; row < firstRow + blockRowCount; ++row)
+         {
+            const size_t last = std::min(firstColumn + blockColumnCount, row + 1);
+            std::copy(&tile[(row - firstRow) * blockColumnCount], &tile[(row - firstRow) * blockColumnCount] + (last - firstColumn), &elements[rowOffset(row) + firstColumn]);
+         }
+      };
+      if ((blocks.size() < 2) || (0.5 * size * size * rowCount < static_cast<double>(ParallelSettings::MultiplyThreshold())) || (ParallelSettings::ThreadCount() == 1))
+      {
+         for (size_t index = 0; index < blocks.size(); ++index)
+         {
+            computeBlock(index);
+         }
+      }
+      else
+      {
+         ParallelSettings::Pool().ParallelFor(blocks.size(), computeBlock);
+      }
+      return std::make_shared<SymmetricMatrix<ElementType>>(size, std::move(elements));
+   }
+};
+
+template <typename ElementType> const size_t SymmetricMatrix<ElementType>::BlockSize;
+
+} // namespace SMT
+
+#endif // __SYMMETRIC_MATRIX_H__
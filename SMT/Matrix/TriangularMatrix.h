@@ -0,0 +1,367 @@
+#ifndef __TRIANGULAR_MATRIX_H__
+#define __TRIANGULAR_MATRIX_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Triangular matrix
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MatrixDefs.h"
+#include "MatrixChecks.h"
+#include "MatrixKernels.h"
+#include "MatrixSimd.h"
+#include "StandardMatrix.h"
+#include "../Threading/ThreadPool.h"
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Triangular matrix.
+// It represents as the packed triangle: rows of the triangle are stored one after another (N * (N + 1) / 2 elements),
+// elements outside the triangle are zeros.
+//    Products and solves are blocked: BlockSize rows (or columns) of the triangle are unpacked into a dense panel
+//    which covers the nonzero part only, and the panel is multiplied by the GEMM kernel. So a product costs half of
+//    the dense one, and a solve costs O(N^2) per right-hand side instead of the O(N^3) factorization.
+//    The matrix is immutable, so copies share the triangle.
+template <typename ElementType>
+class TriangularMatrix : public Matrix<ElementType>
+{
+public:
+   using InitFunc = std::function<ElementType (size_t /*row*/, size_t /*column*/)>; // A function which initializes elements of the triangle
+   using OperationResult = typename Matrix<ElementType>::OperationResult;
+   using ScalarOperationResult = typename Matrix<ElementType>::ScalarOperationResult;
+   enum class Part
+   {
+      Lower,                                    // Elements on and below the diagonal
+      Upper,                                    // Elements on and above the diagonal
+   };
+   static const size_t BlockSize = 64;
+
+   // Creates a zero matrix
+   TriangularMatrix(size_t size, Part part)
+      : TriangularMatrix(size, part, std::vector<ElementType>(size * (size + 1) / 2, MatrixSettings::Zero<ElementType>()))
+   {
+   }
+   // initFunc is called for elements of the triangle only
+   TriangularMatrix(size_t size, Part part, const InitFunc& initFunc)
+      : size_(size)
+      , part_(part)
+   {
+      std::vector<ElementType> elements(size * (size + 1) / 2);
+      for (size_t row = 0; row < size_; ++row)
+      {
+         ElementType* rowData = &elements[rowOffset(row)];
+         for (size_t column = firstColumn(row); column < lastColumn(row); ++column)
+         {
+            rowData[column - firstColumn(row)] = initFunc(row, column);
+         }
+      }
+      elements_ = std::make_shared<const std::vector<ElementType>>(std::move(elements));
+   }
+   // Takes the triangle of the matrix (the rest of it is ignored)
+   TriangularMatrix(const Matrix<ElementType>& sourceMatrix, Part part)
+      : size_(sourceMatrix.RowCount())
+      , part_(part)
+   {
+      assert(sourceMatrix.RowCount() == sourceMatrix.ColumnCount());
+      std::vector<ElementType> elements(size_ * (size_ + 1) / 2);
+      for (size_t row = 0; row < size_; ++row)
+      {
+         sourceMatrix.CopyTile(row, firstColumn(row), 1, lastColumn(row) - firstColumn(row), &elements[rowOffset(row)], size_);
+      }
+      elements_ = std::make_shared<const std::vector<ElementType>>(std::move(elements));
+   }
+   // Adopts the packed triangle (size * (size + 1) / 2 elements, see the class description)
+   TriangularMatrix(size_t size, Part part, std::vector<ElementType>&& elements)
+      : size_(size)
+      , part_(part)
+      , elements_(std::make_shared<const std::vector<ElementType>>(std::move(elements)))
+   {
+      assert(elements_->size() == size_ * (size_ + 1) / 2);
+   }
+
+   Part TrianglePart() const { return part_; }
+   // The packed triangle
+   const ElementType* Elements() const { return elements_->data(); }
+
+   // Matrix
+   virtual size_t RowCount() const override { return size_; }
+   virtual size_t ColumnCount() const override { return size_; }
+   virtual ElementType Element(size_t row, size_t column) const override
+   {
+      return ((column >= firstColumn(row)) && (column < lastColumn(row))) ? (*elements_)[rowOffset(row) + column - firstColumn(row)] : MatrixSettings::Zero<ElementType>();
+   }
+   virtual std::string TypeName() const { return "TriangularMatrix"; }
+   virtual double CallsPerElement() const override { return 0.0; }
+   // Rows of the triangle are contiguous, the rest of the tile is filled with zeros
+   virtual void CopyTile(size_t row, size_t column, size_t rowCount, size_t columnCount, ElementType* buffer, size_t stride) const override
+   {
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         ElementType* destination = &buffer[tileRow * stride];
+         std::fill(destination, destination + columnCount, MatrixSettings::Zero<ElementType>());
+         const size_t first = std::max(column, firstColumn(row + tileRow));
+         const size_t last = std::min(column + columnCount, lastColumn(row + tileRow));
+         if (first < last)
+         {
+            const ElementType* source = &(*elements_)[rowOffset(row + tileRow) + first - firstColumn(row + tileRow)];
+            std::copy(source, source + (last - first), &destination[first - column]);
+         }
+      }
+   }
+   virtual Complexity::Type CopyingComplexity() const override { return Complexity::Constant; }
+   virtual OperationResult Copy() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<TriangularMatrix<ElementType>>(*this);
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The sum of triangles of the same part is triangular, other sums are standard
+   virtual Complexity::Type AdditionComplexity(const Matrix<ElementType>& /*otherMatrix*/) const override { return Complexity::Quadratic; }
+   virtual OperationResult Add(const Matrix<ElementType>& otherMatrix) const override
+   {
+      OperationResult result;
+      CheckIfCanAddTogether<ElementType>(*this, otherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      const TriangularMatrix<ElementType>* triangularMatrix = samePart(otherMatrix);
+      if (triangularMatrix == nullptr)
+      {
+         return StandardMatrix<ElementType>::Add(otherMatrix, *this);
+      }
+      std::vector<ElementType> elements(*elements_);
+      Kernels::SubtractScaledRow(elements.data(), triangularMatrix->Elements(), -MatrixSettings::One<ElementType>(), elements.size());
+      result.Matrix_ = std::make_shared<TriangularMatrix<ElementType>>(size_, part_, std::move(elements));
+      return result;
+   }
+   virtual Complexity::Type MultiplyByNumberComplexity() const override { return Complexity::Quadratic; }
+   virtual OperationResult MultiplyByNumber(const ElementType& number) const override
+   {
+      OperationResult result;
+      std::vector<ElementType> elements(*elements_);
+      Kernels::ScaleRow(elements.data(), number, elements.size());
+      result.Matrix_ = std::make_shared<TriangularMatrix<ElementType>>(size_, part_, std::move(elements));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The product of triangles of the same part is triangular, other products are standard
+   virtual Complexity::Type MultiplyComplexity(const Matrix<ElementType>& /*anotherMatrix*/, bool /*anotherMatrixIsOnTheLeft*/) const override { return Complexity::Cubic; }
+   virtual OperationResult Multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const override { return multiply(anotherMatrix, anotherMatrixIsOnTheLeft); }
+   // The inverse is triangular: it is the solution for the identity matrix
+   virtual Complexity::Type InversionComplexity() const override { return Complexity::Cubic; }
+   virtual OperationResult Invert() const override
+   {
+      OperationResult result = Solve(StandardMatrix<ElementType>(size_, size_, MatrixSettings::IdentityMatrixFunction<ElementType>()));
+      if (result.Matrix_ != nullptr)
+      {
+         result.Matrix_ = std::make_shared<TriangularMatrix<ElementType>>(*result.Matrix_, part_);
+      }
+      else if (result.Code_ == OperationResultCode::Error)
+      {
+         result.Description_ = "Matrix can't be inverted: it is not invertible";
+      }
+      return result;
+   }
+   // The transposed triangle is the triangle of the other part
+   virtual Complexity::Type TransposeComplexity() const override { return Complexity::Quadratic; }
+   virtual OperationResult Transpose() const override
+   {
+      OperationResult result;
+      result.Matrix_ = std::make_shared<TriangularMatrix<ElementType>>(size_, (part_ == Part::Lower) ? Part::Upper : Part::Lower,
+         [this](size_t row, size_t column) { return Element(column, row); });
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // The product of diagonal elements
+   virtual Complexity::Type DeterminantEvaluationComplexity() const override { return Complexity::Linear; }
+   virtual ScalarOperationResult Determinant() const override
+   {
+      ScalarOperationResult result;
+      ElementType determinant = MatrixSettings::One<ElementType>();
+      for (size_t index = 0; index < size_; ++index)
+      {
+         determinant *= diagonal(index);
+      }
+      result.Value_.reset(new ElementType(determinant));
+      result.Code_ = OperationResultCode::Ok;
+      return result;
+   }
+   // Blocked substitution (TRSM): O(N^2) per right-hand side
+   virtual Complexity::Type SolvingComplexity(const Matrix<ElementType>& rightHandSide) const override { return (rightHandSide.ColumnCount() == 1) ? Complexity::Quadratic : Complexity::Cubic; }
+   virtual OperationResult Solve(const Matrix<ElementType>& rightHandSide) const override { return solve(rightHandSide); }
+
+private:
+   size_t size_;
+   Part part_;
+   std::shared_ptr<const std::vector<ElementType>> elements_;   // Immutable, shared with copies
+
+   // Columns [firstColumn(row), lastColumn(row)) of the row belong to the triangle
+   size_t firstColumn(size_t row) const { return (part_ == Part::Lower) ? 0 : row; }
+   size_t lastColumn(size_t row) const { return (part_ == Part::Lower) ? row + 1 : size_; }
+   // Position of the first element of the row in the packed triangle
+   size_t rowOffset(size_t row) const { return (part_ == Part::Lower) ? row * (row + 1) / 2 : row * size_ - row * (row - 1) / 2; }
+   const ElementType& diagonal(size_t index) const { return (*elements_)[rowOffset(index) + index - firstColumn(index)]; }
+
+   const TriangularMatrix<ElementType>* samePart(const Matrix<ElementType>& matrix) const
+   {
+      const TriangularMatrix<ElementType>* triangularMatrix = dynamic_cast<const TriangularMatrix<ElementType>*>(&matrix);
+      return ((triangularMatrix != nullptr) && (triangularMatrix->part_ == part_)) ? triangularMatrix : nullptr;
+   }
+
+   // Calls func(block) for blocks of BlockSize rows (or columns) of the triangle; blocks are independent, so large
+   // products are distributed between threads of the library pool
+   template <typename BlockFunc>
+   void forEachBlock(double operationCount, const BlockFunc& func) const
+   {
+      const size_t blockCount = (size_ + BlockSize - 1) / BlockSize;
+      if ((blockCount < 2) || (operationCount < static_cast<double>(ParallelSettings::MultiplyThreshold())))
+      {
+         for (size_t block = 0; block < blockCount; ++block)
+         {
+            func(block);
+         }
+         return;
+      }
+      ParallelSettings::Pool().ParallelFor(blockCount, func);
+   }
+
+   OperationResult multiply(const Matrix<ElementType>& anotherMatrix, bool anotherMatrixIsOnTheLeft) const
+   {
+      OperationResult result;
+      CheckIfCanMultiplyTogether(anotherMatrixIsOnTheLeft ? anotherMatrix : *this, anotherMatrixIsOnTheLeft ? *this : anotherMatrix, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      anotherMatrix.PrepareForReuse(size_);
+      const StandardMatrix<ElementType>* standardMatrix = dynamic_cast<const StandardMatrix<ElementType>*>(&anotherMatrix);
+      std::unique_ptr<StandardMatrix<ElementType>> copy;
+      if (standardMatrix == nullptr)
+      {
+         copy.reset(new StandardMatrix<ElementType>(anotherMatrix));
+         standardMatrix = copy.get();
+      }
+      auto product = std::make_shared<StandardMatrix<ElementType>>(anotherMatrixIsOnTheLeft ? anotherMatrix.RowCount() : size_, anotherMatrixIsOnTheLeft ? size_ : anotherMatrix.ColumnCount());
+      if (anotherMatrixIsOnTheLeft)
+      {
+         multiplyFromLeft(*standardMatrix, product->Data());
+      }
+      else
+      {
+         multiplyFromRight(*standardMatrix, product->Data());
+      }
+      result.Matrix_ = product;
+      if (samePart(anotherMatrix) != nullptr)
+      {
+         result.Matrix_ = std::make_shared<TriangularMatrix<ElementType>>(*product, part_);
+      }
+      return result;
+   }
+
+   // Product = This * matrix: a block of rows of the product is the panel of the block rows of the triangle (its
+   // nonzero columns only) multiplied by the corresponding rows of the matrix
+   void multiplyFromRight(const StandardMatrix<ElementType>& matrix, ElementType* product) const
+   {
+      const size_t columnCount = matrix.ColumnCount();
+      const ElementType* data = matrix.Data();
+      forEachBlock(0.5 * size_ * size_ * columnCount, [&](size_t block)
+      {
+         const size_t firstRow = block * BlockSize;
+         const size_t rowCount = std::min(BlockSize, size_ - firstRow);
+         const size_t first = firstColumn(firstRow);
+         const size_t last = lastColumn(firstRow + rowCount - 1);
+         std::vector<ElementType> panel(rowCount * (last - first));
+         CopyTile(firstRow, first, rowCount, last - first, panel.data(), last - first);
+         Kernels::Gemm<ElementType>(rowCount, columnCount, last - first, MatrixSettings::One<ElementType>(), panel.data(), last - first,
+            &data[first * columnCount], columnCount, MatrixSettings::Zero<ElementType>(), &product[firstRow * columnCount], columnCount);
+      });
+   }
+
+   // Product = matrix * This: a block of columns of the product is the matrix (its columns which meet the nonzero rows
+   // of the block columns of the triangle) multiplied by the panel of the block columns
+   void multiplyFromLeft(const StandardMatrix<ElementType>& matrix, ElementType* product) const
+   {
+      const size_t rowCount = matrix.RowCount();
+      const ElementType* data = matrix.Data();
+      forEachBlock(0.5 * size_ * size_ * rowCount, [&](size_t block)
+      {
+         const size_t firstPanelColumn = block * BlockSize;
+         const size_t columnCount = std::min(BlockSize, size_ - firstPanelColumn);
+         const size_t first = (part_ == Part::Lower) ? firstPanelColumn : 0;
+         const size_t last = (part_ == Part::Lower) ? size_ : firstPanelColumn + columnCount;
+         std::vector<ElementType> panel((last - first) * columnCount);
+         CopyTile(first, firstPanelColumn, last - first, columnCount, panel.data(), columnCount);
+         Kernels::Gemm<ElementType>(rowCount, columnCount, last - first, MatrixSettings::One<ElementType>(), &data[first], size_,
+            panel.data(), columnCount, MatrixSettings::Zero<ElementType>(), &product[firstPanelColumn], size_);
+      });
+   }
+
+   // Blocked substitution: rows of the solution are found block by block (forward for the lower triangle, backward for
+   // the upper one). Every block is updated by the solved blocks (by the GEMM kernel), then it is solved inside the
+   // diagonal block of the triangle.
+   OperationResult solve(const Matrix<ElementType>& rightHandSide) const
+   {
+      OperationResult result;
+      CheckIfCanSolve(*this, rightHandSide, result.Code_, result.Description_);
+      if (result.Code_ == OperationResultCode::Error)
+      {
+         return result;
+      }
+      for (size_t index = 0; index < size_; ++index)
+      {
+         if (MatrixSettings::CanAssumeItIsZero<ElementType>(diagonal(index)))
+         {
+            result.Code_ = OperationResultCode::Error;
+            result.Description_ = "Linear system can't be solved: the matrix is not invertible";
+            return result;
+         }
+      }
+      auto solution = std::make_shared<StandardMatrix<ElementType>>(rightHandSide);
+      ElementType* x = solution->Data();
+      const size_t columnCount = rightHandSide.ColumnCount();
+      const size_t blockCount = (size_ + BlockSize - 1) / BlockSize;
+      std::vector<ElementType> panel;
+      for (size_t step = 0; step < blockCount; ++step)
+      {
+         const size_t block = (part_ == Part::Lower) ? step : blockCount - 1 - step;
+         const size_t firstRow = block * BlockSize;
+         const size_t rowCount = std::min(BlockSize, size_ - firstRow);
+         // Solved rows: [0, firstRow) for the lower triangle, [firstRow + rowCount, size) for the upper one
+         const size_t first = (part_ == Part::Lower) ? 0 : firstRow + rowCount;
+         const size_t last = (part_ == Part::Lower) ? firstRow : size_;
+         if (first < last)
+         {
+            panel.resize(rowCount * (last - first));
+            CopyTile(firstRow, first, rowCount, last - first, panel.data(), last - first);
+            Kernels::ParallelGemm<ElementType>(rowCount, columnCount, last - first, -MatrixSettings::One<ElementType>(), panel.data(), last - first,
+               &x[first * columnCount], columnCount, MatrixSettings::One<ElementType>(), &x[firstRow * columnCount], columnCount);
+         }
+         for (size_t step2 = 0; step2 < rowCount; ++step2)
+         {
+            const size_t row = (part_ == Part::Lower) ? firstRow + step2 : firstRow + rowCount - 1 - step2;
+            const size_t firstSolved = (part_ == Part::Lower) ? firstRow : row + 1;
+            const size_t lastSolved = (part_ == Part::Lower) ? row : firstRow + rowCount;
+            for (size_t column = firstSolved; column < lastSolved; ++column)
+            {
+               Kernels::SubtractScaledRow(&x[row * columnCount], &x[column * columnCount], Element(row, column), columnCount);
+            }
+            Kernels::ScaleRow(&x[row * columnCount], MatrixSettings::One<ElementType>() / diagonal(row), columnCount);
+         }
+      }
+      result.Matrix_ = solution;
+      return result;
+   }
+};
+
+template <typename ElementType> const size_t TriangularMatrix<ElementType>::BlockSize;
+
+} // namespace SMT
+
+#endif // __TRIANGULAR_MATRIX_H__
@@ -6,6 +6,7 @@
 #include <iomanip>
 #include <iostream>
 
+#include "Matrix/MatrixOperations.h"
 #include "Matrix/StandardMatrix.h"
 
 //static double init(size_t column, size_t row)
@@ -63,7 +64,7 @@ void print(const SMT::Matrix<ElementType>& matrix)
    }
 }
 
-int _tmain(int argc, _TCHAR* argv[])
+int main()
 {
    SMT::StandardMatrix<double> matr1(2, 3, init1);
    print(matr1);
@@ -76,5 +77,5 @@ int _tmain(int argc, _TCHAR* argv[])
       print(*result.Matrix_);
    }
 
-	return 0;
+   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,301 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Work-stealing thread pool
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SMT
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread pool.
+// Every worker has its own task queue. A worker takes tasks from the back of its queue and, when the queue is empty,
+// steals from the front of the queues of other workers. The thread which calls ParallelFor() takes part in the work too,
+// so nested ParallelFor() calls (from a task) don't deadlock.
+class ThreadPool
+{
+public:
+   using Task = std::function<void()>;
+   using IndexFunc = std::function<void(size_t /*index*/)>;
+
+   // threadCount is the total number of threads including the calling one. 0 means "the number of hardware threads".
+   explicit ThreadPool(size_t threadCount = 0)
+      : stop_(false)
+      , pendingTaskCount_(0)
+      , nextQueue_(0)
+   {
+      if (threadCount == 0)
+      {
+         threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+      }
+      const size_t workerCount = threadCount - 1;
+      for (size_t i = 0; i < workerCount; ++i)
+      {
+         queues_.emplace_back(new Queue);
+      }
+      for (size_t i = 0; i < workerCount; ++i)
+      {
+         workers_.emplace_back([this, i]() { workerLoop(i); });
+      }
+   }
+   ~ThreadPool()
+   {
+      {
+         std::lock_guard<std::mutex> lock(sleepMutex_);
+         stop_ = true;
+      }
+      wakeUp_.notify_all();
+      for (auto& worker : workers_)
+      {
+         worker.join();
+      }
+   }
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   // The total number of threads which execute tasks (including the calling one)
+   size_t ThreadCount() const { return workers_.size() + 1; }
+
+   // Calls func(index) for every index in [0, count) and waits until all calls are done.
+   // Indices are distributed between threads in an unspecified order. The first exception (if any) is rethrown.
+   void ParallelFor(size_t count, const IndexFunc& func)
+   {
+      if (count == 0)
+      {
+         return;
+      }
+      if (workers_.empty() || count == 1)
+      {
+         for (size_t index = 0; index < count; ++index)
+         {
+            func(index);
+         }
+         return;
+      }
+
+      Batch batch(count);
+      for (size_t index = 0; index < count; ++index)
+      {
+         push([&batch, &func, index]()
+         {
+            try
+            {
+               func(index);
+            }
+            catch (...)
+            {
+               std::lock_guard<std::mutex> lock(batch.mutex_);
+               if (!batch.exception_)
+               {
+                  batch.exception_ = std::current_exception();
+               }
+            }
+            std::lock_guard<std::mutex> lock(batch.mutex_);
+            if (--batch.remaining_ == 0)
+            {
+               batch.done_.notify_all();
+            }
+         });
+      }
+
+      // The calling thread helps until its batch is finished
+      for (;;)
+      {
+         {
+            std::lock_guard<std::mutex> lock(batch.mutex_);
+            if (batch.remaining_ == 0)
+            {
+               break;
+            }
+         }
+         Task task;
+         if (steal(queues_.size(), task))
+         {
+            task();
+            continue;
+         }
+         std::unique_lock<std::mutex> lock(batch.mutex_);
+         batch.done_.wait(lock, [&batch]() { return batch.remaining_ == 0; });
+         break;
+      }
+      if (batch.exception_)
+      {
+         std::rethrow_exception(batch.exception_);
+      }
+   }
+
+private:
+   struct Queue
+   {
+      std::mutex mutex_;
+      std::deque<Task> tasks_;
+   };
+   struct Batch
+   {
+      explicit Batch(size_t count) : remaining_(count) {}
+      std::mutex mutex_;
+      std::condition_variable done_;
+      size_t remaining_;
+      std::exception_ptr exception_;
+   };
+
+   std::vector<std::unique_ptr<Queue>> queues_;
+   std::vector<std::thread> workers_;
+   std::mutex sleepMutex_;
+   std::condition_variable wakeUp_;
+   bool stop_;
+   std::atomic<size_t> pendingTaskCount_;
+   std::atomic<size_t> nextQueue_;
+
+   void push(Task task)
+   {
+      // The counter is incremented before the task is published: a worker which takes the task decrements it
+      {
+         std::lock_guard<std::mutex> lock(sleepMutex_);
+         ++pendingTaskCount_;
+      }
+      Queue& queue = *queues_[nextQueue_++ % queues_.size()];
+      {
+         std::lock_guard<std::mutex> lock(queue.mutex_);
+         queue.tasks_.push_back(std::move(task));
+      }
+      wakeUp_.notify_one();
+   }
+
+   bool popOwn(size_t queueIndex, Task& task)
+   {
+      Queue& queue = *queues_[queueIndex];
+      std::lock_guard<std::mutex> lock(queue.mutex_);
+      if (queue.tasks_.empty())
+      {
+         return false;
+      }
+      task = std::move(queue.tasks_.back());
+      queue.tasks_.pop_back();
+      --pendingTaskCount_;
+      return true;
+   }
+
+   // Takes the oldest task from any queue except ownQueueIndex (pass queues_.size() to allow all of them)
+   bool steal(size_t ownQueueIndex, Task& task)
+   {
+      const size_t queueCount = queues_.size();
+      const size_t start = (ownQueueIndex < queueCount) ? ownQueueIndex + 1 : 0;
+      for (size_t i = 0; i < queueCount; ++i)
+      {
+         const size_t queueIndex = (start + i) % queueCount;
+         if (queueIndex == ownQueueIndex)
+         {
+            continue;
+         }
+         Queue& queue = *queues_[queueIndex];
+         std::lock_guard<std::mutex> lock(queue.mutex_);
+         if (!queue.tasks_.empty())
+         {
+            task = std::move(queue.tasks_.front());
+            queue.tasks_.pop_front();
+            --pendingTaskCount_;
+            return true;
+         }
+      }
+      return false;
+   }
+
+   void workerLoop(size_t queueIndex)
+   {
+      for (;;)
+      {
+         Task task;
+         if (popOwn(queueIndex, task) || steal(queueIndex, task))
+         {
+            task();
+            continue;
+         }
+         std::unique_lock<std::mutex> lock(sleepMutex_);
+         wakeUp_.wait(lock, [this]() { return stop_ || pendingTaskCount_ > 0; });
+         if (stop_ && pendingTaskCount_ == 0)
+         {
+            return;
+         }
+      }
+   }
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel execution settings of the library.
+// The setters aren't thread-safe: call them before (not during) matrix operations.
+namespace ParallelSettings
+{
+namespace Details
+{
+inline std::unique_ptr<ThreadPool>& PoolRef()
+{
+   static std::unique_ptr<ThreadPool> pool;
+   return pool;
+}
+inline std::mutex& PoolMutex()
+{
+   static std::mutex mutex;
+   return mutex;
+}
+inline size_t& ThreadCountRef()
+{
+   static size_t threadCount = 0;
+   return threadCount;
+}
+inline size_t& MultiplyThresholdRef()
+{
+   static size_t threshold = 128 * 128 * 128;
+   return threshold;
+}
+inline size_t& FillThresholdRef()
+{
+   static size_t threshold = 256 * 256;
+   return threshold;
+}
+} // namespace Details
+
+// The library-owned pool. It is created on first use (concurrent first calls create one pool).
+inline ThreadPool& Pool()
+{
+   std::lock_guard<std::mutex> lock(Details::PoolMutex());
+   auto& pool = Details::PoolRef();
+   if (pool == nullptr)
+   {
+      pool.reset(new ThreadPool(Details::ThreadCountRef()));
+   }
+   return *pool;
+}
+// The number of threads which are used by matrix operations (0 means "the number of hardware threads", 1 disables multithreading)
+inline size_t ThreadCount() { return Pool().ThreadCount(); }
+inline void SetThreadCount(size_t threadCount)
+{
+   std::unique_ptr<ThreadPool> oldPool;        // Its workers are joined after the lock is released
+   {
+      std::lock_guard<std::mutex> lock(Details::PoolMutex());
+      Details::ThreadCountRef() = threadCount;
+      oldPool = std::move(Details::PoolRef());
+   }
+}
+// Products with fewer multiply-add operations (rows * columns * inner size) are computed by the calling thread only
+inline size_t MultiplyThreshold() { return Details::MultiplyThresholdRef(); }
+inline void SetMultiplyThreshold(size_t threshold) { Details::MultiplyThresholdRef() = threshold; }
+// Computed matrices (e.g. function matrices) with fewer elements in a tile are filled by the calling thread only
+inline size_t FillThreshold() { return Details::FillThresholdRef(); }
+inline void SetFillThreshold(size_t threshold) { Details::FillThresholdRef() = threshold; }
+} // namespace ParallelSettings
+
+} // namespace SMT
+
+#endif // __THREAD_POOL_H__
\ No newline at end of file
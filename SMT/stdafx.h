@@ -3,5 +3,7 @@
 #include "targetver.h"
 
 #include <stdio.h>
+#if defined(_WIN32)
 #include <tchar.h>
+#endif
 
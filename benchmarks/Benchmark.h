@@ -0,0 +1,293 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Minimal benchmark harness (in the spirit of Google Benchmark)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// One benchmark case: an operation on a matrix type, an element type and a size.
+// Setup_ prepares the operands (it isn't measured) and returns the measured body.
+struct Case
+{
+   using Body = std::function<void()>;
+
+   std::string Operation_;                      // "Multiply"
+   std::string MatrixType_;                     // "BlockMatrix"
+   std::string ElementType_;                    // "double"
+   size_t Size_ = 0;                            // Operands are Size_ x Size_
+   std::uint32_t BlockSize_ = 0;                // Only for block matrices (0 means the automatic block size)
+   double Flops_ = 0.0;                         // Floating point (or integer) operations of one call of the body (0 - no rate is reported)
+   double Bytes_ = 0.0;                         // Bytes which one call of the body reads and writes at least (0 - no rate is reported, e.g. for lazy operations)
+   std::function<Body()> Setup_;
+
+   // "Multiply/BlockMatrix:64/double/1024"
+   std::string Name() const
+   {
+      std::string matrixType = MatrixType_;
+      if (BlockSize_ != 0)
+      {
+         matrixType += ":" + std::to_string(BlockSize_);
+      }
+      return Operation_ + "/" + matrixType + "/" + ElementType_ + "/" + std::to_string(Size_);
+   }
+};
+
+struct Result
+{
+   std::string Name_;
+   const Case* Case_ = nullptr;
+   size_t Iterations_ = 0;                      // Iterations of one repetition
+   size_t Repetitions_ = 0;
+   double MinSeconds_ = 0.0;                    // The best time of one iteration among repetitions
+   double MeanSeconds_ = 0.0;                   // The mean time of one iteration
+   double GFlopsPerSecond_ = 0.0;               // Computed from the best time (0 if the case has no flops)
+   double GBytesPerSecond_ = 0.0;               // 0 if the case has no bytes
+};
+
+struct Options
+{
+   double MinSeconds_ = 0.5;                    // The minimum measured time of one case (all repetitions together)
+   size_t Repetitions_ = 3;
+   std::vector<std::string> Filters_;           // A case runs if its name contains any of them (all cases if empty)
+};
+
+namespace Details
+{
+inline volatile char& Sink()
+{
+   static volatile char sink = 0;
+   return sink;
+}
+
+inline double MeasureSeconds(const Case::Body& body, size_t iterations)
+{
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t iteration = 0; iteration < iterations; ++iteration)
+   {
+      body();
+   }
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A rate column: "-" if there is no rate
+inline std::string FormatRate(double rate)
+{
+   if (rate == 0.0)
+   {
+      return "-";
+   }
+   std::ostringstream text;
+   text << std::fixed << std::setprecision(3) << rate;
+   return text.str();
+}
+
+inline std::string EscapeJson(const std::string& text)
+{
+   std::string result;
+   for (char symbol : text)
+   {
+      if (symbol == '"' || symbol == '\\')
+      {
+         result += '\\';
+      }
+      result += symbol;
+   }
+   return result;
+}
+} // namespace Details
+
+// Stops the run if a measured operation has failed: it has returned at once, so its time would be meaningless
+inline void Check(bool succeeded, const std::string& description)
+{
+   if (!succeeded)
+   {
+      std::cerr << "Benchmark operation failed: " << description << std::endl;
+      std::exit(EXIT_FAILURE);
+   }
+}
+
+// Keeps a value alive so the compiler can't throw away the computation of it (a byte of it is read through volatile)
+template <typename ValueType>
+void DoNotOptimize(const ValueType& value)
+{
+   Details::Sink() = *reinterpret_cast<const volatile char*>(&value);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Runner.
+// The number of iterations of a case is increased until one repetition takes MinSeconds_ / Repetitions_, then all
+// repetitions are measured with this number of iterations. The body is called once before measuring (warm-up).
+class Runner
+{
+public:
+   void Add(const Case& benchmarkCase) { cases_.push_back(benchmarkCase); }
+   size_t CaseCount() const { return cases_.size(); }
+
+   bool Matches(const Case& benchmarkCase, const Options& options) const
+   {
+      if (options.Filters_.empty())
+      {
+         return true;
+      }
+      const std::string name = benchmarkCase.Name();
+      return std::any_of(options.Filters_.begin(), options.Filters_.end(), [&name](const std::string& filter) { return name.find(filter) != std::string::npos; });
+   }
+
+   std::vector<std::string> Names(const Options& options) const
+   {
+      std::vector<std::string> names;
+      for (const Case& benchmarkCase : cases_)
+      {
+         if (Matches(benchmarkCase, options))
+         {
+            names.push_back(benchmarkCase.Name());
+         }
+      }
+      return names;
+   }
+
+   // Runs all matching cases. onResult is called after every case (e.g. to print it).
+   std::vector<Result> Run(const Options& options, const std::function<void(const Result&)>& onResult = std::function<void(const Result&)>()) const
+   {
+      std::vector<Result> results;
+      for (const Case& benchmarkCase : cases_)
+      {
+         if (!Matches(benchmarkCase, options))
+         {
+            continue;
+         }
+         results.push_back(run(benchmarkCase, options));
+         if (onResult)
+         {
+            onResult(results.back());
+         }
+      }
+      return results;
+   }
+
+   static void PrintHeader(std::ostream& stream)
+   {
+      stream << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(14) << "Time, ms" << std::setw(12) << "Iterations"
+         << std::setw(12) << "GFLOP/s" << std::setw(12) << "GB/s" << std::endl;
+      stream << std::string(98, '-') << std::endl;
+   }
+
+   static void Print(std::ostream& stream, const Result& result)
+   {
+      stream << std::left << std::setw(48) << result.Name_ << std::right << std::fixed
+         << std::setw(14) << std::setprecision(4) << result.MinSeconds_ * 1000.0
+         << std::setw(12) << result.Iterations_
+         << std::setw(12) << Details::FormatRate(result.GFlopsPerSecond_)
+         << std::setw(12) << Details::FormatRate(result.GBytesPerSecond_) << std::endl;
+   }
+
+   // The same layout as Google Benchmark's JSON output ("context" and "benchmarks") plus the case parameters. Rates
+   // which aren't reported (see Case) are omitted.
+   static void WriteJson(std::ostream& stream, const std::vector<Result>& results, const std::string& buildType)
+   {
+      char date[64] = {};
+      const std::time_t now = std::time(nullptr);
+      std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+      stream << "{\n";
+      stream << "  \"context\": {\n";
+      stream << "    \"date\": \"" << date << "\",\n";
+      stream << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+      stream << "    \"library_build_type\": \"" << Details::EscapeJson(buildType) << "\"\n";
+      stream << "  },\n";
+      stream << "  \"benchmarks\": [";
+      for (size_t i = 0; i < results.size(); ++i)
+      {
+         const Result& result = results[i];
+         const Case& benchmarkCase = *result.Case_;
+         std::ostringstream item;
+         item << std::setprecision(std::numeric_limits<double>::max_digits10);
+         item << "\n    {\n";
+         item << "      \"name\": \"" << Details::EscapeJson(result.Name_) << "\",\n";
+         item << "      \"operation\": \"" << Details::EscapeJson(benchmarkCase.Operation_) << "\",\n";
+         item << "      \"matrix_type\": \"" << Details::EscapeJson(benchmarkCase.MatrixType_) << "\",\n";
+         item << "      \"element_type\": \"" << Details::EscapeJson(benchmarkCase.ElementType_) << "\",\n";
+         item << "      \"size\": " << benchmarkCase.Size_ << ",\n";
+         item << "      \"block_size\": " << benchmarkCase.BlockSize_ << ",\n";
+         item << "      \"iterations\": " << result.Iterations_ << ",\n";
+         item << "      \"repetitions\": " << result.Repetitions_ << ",\n";
+         item << "      \"real_time\": " << result.MinSeconds_ * 1.0e9 << ",\n";
+         item << "      \"mean_time\": " << result.MeanSeconds_ * 1.0e9 << ",\n";
+         item << "      \"time_unit\": \"ns\"";
+         if (result.GFlopsPerSecond_ != 0.0)
+         {
+            item << ",\n      \"gflops_per_second\": " << result.GFlopsPerSecond_;
+         }
+         if (result.GBytesPerSecond_ != 0.0)
+         {
+            item << ",\n      \"gbytes_per_second\": " << result.GBytesPerSecond_;
+         }
+         item << "\n";
+         item << "    }" << ((i + 1 < results.size()) ? "," : "");
+         stream << item.str();
+      }
+      stream << "\n  ]\n}\n";
+   }
+
+private:
+   std::vector<Case> cases_;
+
+   static Result run(const Case& benchmarkCase, const Options& options)
+   {
+      Result result;
+      result.Name_ = benchmarkCase.Name();
+      result.Case_ = &benchmarkCase;
+      result.Repetitions_ = std::max<size_t>(1, options.Repetitions_);
+
+      const Case::Body body = benchmarkCase.Setup_();
+      body();
+
+      // Every next attempt is scaled by the measured time (at most by 10 times, like Google Benchmark does)
+      const double repetitionSeconds = options.MinSeconds_ / result.Repetitions_;
+      size_t iterations = 1;
+      double seconds = Details::MeasureSeconds(body, iterations);
+      while (seconds < repetitionSeconds)
+      {
+         const double factor = (seconds > 0.0) ? std::min(10.0, 1.4 * repetitionSeconds / seconds) : 10.0;
+         iterations = std::max(iterations + 1, static_cast<size_t>(iterations * factor));
+         seconds = Details::MeasureSeconds(body, iterations);
+      }
+
+      result.Iterations_ = iterations;
+      result.MinSeconds_ = seconds / iterations;
+      double totalSeconds = seconds;
+      for (size_t repetition = 1; repetition < result.Repetitions_; ++repetition)
+      {
+         seconds = Details::MeasureSeconds(body, iterations);
+         result.MinSeconds_ = std::min(result.MinSeconds_, seconds / iterations);
+         totalSeconds += seconds;
+      }
+      result.MeanSeconds_ = totalSeconds / (iterations * result.Repetitions_);
+      result.GFlopsPerSecond_ = benchmarkCase.Flops_ / result.MinSeconds_ * 1.0e-9;
+      result.GBytesPerSecond_ = benchmarkCase.Bytes_ / result.MinSeconds_ * 1.0e-9;
+      return result;
+   }
+};
+
+} // namespace Bench
+
+#endif // __BENCHMARK_H__
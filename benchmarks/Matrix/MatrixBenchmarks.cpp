@@ -0,0 +1,191 @@
+#include "../stdafx.h"
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "../../SMT/Matrix/BlockMatrix.h"
+#include "../../SMT/Matrix/FunctionMatrix.h"
+#include "../../SMT/Matrix/MatrixOperations.h"
+#include "../../SMT/Matrix/StandardMatrix.h"
+#include "MatrixBenchmarks.h"
+
+namespace Bench
+{
+namespace
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Operands
+enum class MatrixKind
+{
+   Standard,
+   Block,
+   Function
+};
+
+template <typename ElementType>
+std::function<ElementType(size_t, size_t)> operandFunction(size_t size, size_t seed)
+{
+   // Small values with a dominant diagonal: the matrix is well conditioned, integer products don't overflow
+   return [size, seed](size_t row, size_t column)->ElementType
+   {
+      const ElementType value = static_cast<ElementType>(static_cast<int>((row * 7 + column * 3 + seed) % 11) - 5);
+      return (row == column) ? value + static_cast<ElementType>(size) : value;
+   };
+}
+
+template <typename ElementType>
+std::shared_ptr<SMT::Matrix<ElementType>> createOperand(MatrixKind kind, size_t size, std::uint32_t blockSize, size_t seed)
+{
+   const auto func = operandFunction<ElementType>(size, seed);
+   switch (kind)
+   {
+   case MatrixKind::Standard:
+      return std::make_shared<SMT::StandardMatrix<ElementType>>(size, size, func);
+   case MatrixKind::Block:
+      return std::make_shared<SMT::BlockMatrix<ElementType>>(size, size, blockSize, func);
+   case MatrixKind::Function:
+   default:
+      return std::make_shared<SMT::FunctionMatrix<ElementType>>(size, size, func);
+   }
+}
+
+// The result of an operation is checked and kept
+template <typename ResultType>
+void keepResult(const ResultType& result)
+{
+   Check((result.Code_ == SMT::OperationResultCode::Ok) || (result.Code_ == SMT::OperationResultCode::Warning), result.Description_);
+   DoNotOptimize(result);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cases
+template <typename ElementType>
+class CaseBuilder
+{
+public:
+   using Matrix = SMT::Matrix<ElementType>;
+   using ComplexityFunc = std::function<SMT::Complexity::Type(const Matrix&, const Matrix&)>;
+
+   CaseBuilder(Runner& runner, const std::string& elementTypeName, MatrixKind kind, const std::string& matrixTypeName, std::uint32_t blockSize, size_t size)
+      : runner_(runner)
+      , elementTypeName_(elementTypeName)
+      , kind_(kind)
+      , matrixTypeName_(matrixTypeName)
+      , blockSize_(blockSize)
+      , size_(size)
+      , probeFirst_(createOperand<ElementType>(kind, 2, blockSize, 0))
+      , probeSecond_(createOperand<ElementType>(kind, 2, blockSize, 5))
+   {
+   }
+
+   // operation(first, second) is measured; flops and bytes are given in elements of one operand (size x size).
+   // complexity(first, second) is the complexity of the operation (it is asked on small operands of the same types):
+   // constant operations (copy-on-write copies, lazy results) touch no elements, so they have no flops and no bytes.
+   void Add(const std::string& operationName, double flops, double elementTransfers,
+      const std::function<void(const Matrix&, const Matrix&)>& operation, const ComplexityFunc& complexity = ComplexityFunc())
+   {
+      const bool touchesElements = !complexity || (complexity(*probeFirst_, *probeSecond_) != SMT::Complexity::Constant);
+      Case benchmarkCase;
+      benchmarkCase.Operation_ = operationName;
+      benchmarkCase.MatrixType_ = matrixTypeName_;
+      benchmarkCase.ElementType_ = elementTypeName_;
+      benchmarkCase.Size_ = size_;
+      benchmarkCase.BlockSize_ = blockSize_;
+      benchmarkCase.Flops_ = touchesElements ? flops : 0.0;
+      benchmarkCase.Bytes_ = touchesElements ? elementTransfers * sizeof(ElementType) : 0.0;
+      const MatrixKind kind = kind_;
+      const std::uint32_t blockSize = blockSize_;
+      const size_t size = size_;
+      benchmarkCase.Setup_ = [kind, blockSize, size, operation]()->Case::Body
+      {
+         const std::shared_ptr<SMT::Matrix<ElementType>> first = createOperand<ElementType>(kind, size, blockSize, 0);
+         const std::shared_ptr<SMT::Matrix<ElementType>> second = createOperand<ElementType>(kind, size, blockSize, 5);
+         return [first, second, operation]() { operation(*first, *second); };
+      };
+      runner_.Add(benchmarkCase);
+   }
+
+private:
+   Runner& runner_;
+   const std::string elementTypeName_;
+   const MatrixKind kind_;
+   const std::string matrixTypeName_;
+   const std::uint32_t blockSize_;
+   const size_t size_;
+   const std::shared_ptr<Matrix> probeFirst_;
+   const std::shared_ptr<Matrix> probeSecond_;
+};
+
+template <typename ElementType>
+void registerElementType(Runner& runner, const MatrixBenchmarkSettings& settings, const std::string& elementTypeName)
+{
+   using Matrix = SMT::Matrix<ElementType>;
+   struct MatrixType
+   {
+      MatrixKind Kind_;
+      std::string Name_;
+      std::uint32_t BlockSize_;
+   };
+   for (size_t size : settings.Sizes_)
+   {
+      std::vector<MatrixType> matrixTypes;
+      matrixTypes.push_back(MatrixType{ MatrixKind::Standard, "StandardMatrix", 0 });
+      for (std::uint32_t blockSize : settings.BlockSizes_)
+      {
+         // A block which is bigger than the matrix measures the same as a smaller one
+         if (blockSize <= size)
+         {
+            matrixTypes.push_back(MatrixType{ MatrixKind::Block, (blockSize == 0) ? "BlockMatrix:auto" : "BlockMatrix", blockSize });
+         }
+      }
+      matrixTypes.push_back(MatrixType{ MatrixKind::Function, "FunctionMatrix", 0 });
+
+      const double n = static_cast<double>(size);
+      for (const MatrixType& matrixType : matrixTypes)
+      {
+         CaseBuilder<ElementType> builder(runner, elementTypeName, matrixType.Kind_, matrixType.Name_, matrixType.BlockSize_, size);
+         builder.Add("Copy", 0.0, 2.0 * n * n, [](const Matrix& first, const Matrix&) { keepResult(SMT::Copy(first)); },
+            [](const Matrix& first, const Matrix&) { return first.CopyingComplexity(); });
+         builder.Add("Add", n * n, 3.0 * n * n, [](const Matrix& first, const Matrix& second) { keepResult(SMT::Add(first, second)); },
+            [](const Matrix& first, const Matrix& second) { return first.AdditionComplexity(second); });
+         builder.Add("MultiplyByNumber", n * n, 2.0 * n * n, [](const Matrix& first, const Matrix&) { keepResult(SMT::MultiplyByNumber(first, static_cast<ElementType>(3))); },
+            [](const Matrix& first, const Matrix&) { return first.MultiplyByNumberComplexity(); });
+         builder.Add("Transpose", 0.0, 2.0 * n * n, [](const Matrix& first, const Matrix&) { keepResult(SMT::Transpose(first)); },
+            [](const Matrix& first, const Matrix&) { return first.TransposeComplexity(); });
+         if (size > settings.MaxCubicSize_)
+         {
+            continue;
+         }
+         builder.Add("Multiply", 2.0 * n * n * n, 3.0 * n * n, [](const Matrix& first, const Matrix& second) { keepResult(SMT::Multiply(first, second)); });
+         if (std::is_floating_point<ElementType>::value)
+         {
+            // LU decomposition (2/3 n^3) plus solving for n right-hand sides (4/3 n^3)
+            builder.Add("Invert", 2.0 * n * n * n, 2.0 * n * n, [](const Matrix& first, const Matrix&) { keepResult(SMT::Invert(first)); });
+            builder.Add("Determinant", 2.0 / 3.0 * n * n * n, n * n, [](const Matrix& first, const Matrix&) { keepResult(SMT::Determinant(first)); });
+         }
+      }
+   }
+}
+} // namespace
+
+void RegisterMatrixBenchmarks(Runner& runner, const MatrixBenchmarkSettings& settings)
+{
+   for (const std::string& elementType : settings.ElementTypes_)
+   {
+      if (elementType == "float")
+      {
+         registerElementType<float>(runner, settings, elementType);
+      }
+      else if (elementType == "double")
+      {
+         registerElementType<double>(runner, settings, elementType);
+      }
+      else if (elementType == "int64")
+      {
+         registerElementType<std::int64_t>(runner, settings, elementType);
+      }
+   }
+}
+
+} // namespace Bench
@@ -0,0 +1,30 @@
+#ifndef __MATRIX_BENCHMARKS_H__
+#define __MATRIX_BENCHMARKS_H__
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmarks of matrices
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../Benchmark.h"
+
+namespace Bench
+{
+struct MatrixBenchmarkSettings
+{
+   std::vector<size_t> Sizes_ = { 16, 64, 256, 1024, 2048, 4096, 8192 };
+   std::vector<std::uint32_t> BlockSizes_ = { 0, 16, 64, 256 };   // 0 is the automatic block size
+   std::vector<std::string> ElementTypes_ = { "float", "double", "int64" };
+   size_t MaxCubicSize_ = 2048;                 // Multiply, Invert and Determinant are skipped for bigger sizes
+};
+
+// Adds a case for every operation, matrix type (standard, block of every block size, function), element type and size.
+// Invert and Determinant are added for floating point types only.
+void RegisterMatrixBenchmarks(Runner& runner, const MatrixBenchmarkSettings& settings);
+
+} // namespace Bench
+
+#endif // __MATRIX_BENCHMARKS_H__
@@ -0,0 +1,162 @@
+// benchmarks.cpp : Defines the entry point for the benchmark application.
+//
+// Usage: benchmarks [--filter=<substring>[,<substring>...]] [--sizes=16,64,...] [--block-sizes=0,16,...]
+//                   [--types=float,double,int64] [--max-cubic-size=<size>] [--min-time=<seconds>]
+//                   [--repetitions=<count>] [--json=<file>] [--calibrate] [--list]
+// Results are printed as a table and written as JSON (benchmarks.json by default) to compare them between runs.
+// Operations which touch no elements (copy-on-write copies, lazy results) have no GFLOP/s and GB/s ("-"). A failed
+// operation stops the run with exit code 1.
+// --calibrate measures the constants of the cost model of operations first and saves them to the calibration file
+// (SMT_CALIBRATION_FILE).
+
+#include "stdafx.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../SMT/Matrix/MatrixPlanner.h"
+#include "Benchmark.h"
+#include "Matrix/MatrixBenchmarks.h"
+
+static std::vector<std::string> split(const std::string& text)
+{
+   std::vector<std::string> result;
+   std::istringstream stream(text);
+   std::string item;
+   while (std::getline(stream, item, ','))
+   {
+      if (!item.empty())
+      {
+         result.push_back(item);
+      }
+   }
+   return result;
+}
+
+template <typename NumberType>
+static std::vector<NumberType> splitNumbers(const std::string& text)
+{
+   std::vector<NumberType> result;
+   for (const std::string& item : split(text))
+   {
+      result.push_back(static_cast<NumberType>(std::strtoull(item.c_str(), nullptr, 10)));
+   }
+   return result;
+}
+
+// Returns true and the value if argument is "--name=value"
+static bool option(const std::string& argument, const std::string& name, std::string& value)
+{
+   const std::string prefix = "--" + name + "=";
+   if (argument.compare(0, prefix.size(), prefix) != 0)
+   {
+      return false;
+   }
+   value = argument.substr(prefix.size());
+   return true;
+}
+
+int main(int argc, char* argv[])
+{
+   Bench::Options options;
+   Bench::MatrixBenchmarkSettings settings;
+   std::string jsonFileName = "benchmarks.json";
+   bool listOnly = false;
+   bool calibrate = false;
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string argument = argv[i];
+      std::string value;
+      if (option(argument, "filter", value))
+      {
+         options.Filters_ = split(value);
+      }
+      else if (option(argument, "sizes", value))
+      {
+         settings.Sizes_ = splitNumbers<size_t>(value);
+      }
+      else if (option(argument, "block-sizes", value))
+      {
+         settings.BlockSizes_ = splitNumbers<std::uint32_t>(value);
+      }
+      else if (option(argument, "types", value))
+      {
+         settings.ElementTypes_ = split(value);
+      }
+      else if (option(argument, "max-cubic-size", value))
+      {
+         settings.MaxCubicSize_ = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+      }
+      else if (option(argument, "min-time", value))
+      {
+         options.MinSeconds_ = std::atof(value.c_str());
+      }
+      else if (option(argument, "repetitions", value))
+      {
+         options.Repetitions_ = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+      }
+      else if (option(argument, "json", value))
+      {
+         jsonFileName = value;
+      }
+      else if (argument == "--calibrate")
+      {
+         calibrate = true;
+      }
+      else if (argument == "--list")
+      {
+         listOnly = true;
+      }
+      else
+      {
+         std::cerr << "Unknown argument: " << argument << std::endl;
+         return 1;
+      }
+   }
+
+   Bench::Runner runner;
+   Bench::RegisterMatrixBenchmarks(runner, settings);
+   if (listOnly)
+   {
+      for (const std::string& name : runner.Names(options))
+      {
+         std::cout << name << std::endl;
+      }
+      return 0;
+   }
+
+   // The cost model of operations is calibrated (or loaded) before anything is measured
+   if (calibrate)
+   {
+      if (!SMT::Planner::CalibrateAndSave())
+      {
+         std::cerr << "Can't write " << SMT::Planner::CalibrationFile() << std::endl;
+      }
+   }
+   else
+   {
+      SMT::Planner::Constants();
+   }
+
+   Bench::Runner::PrintHeader(std::cout);
+   const std::vector<Bench::Result> results = runner.Run(options, [](const Bench::Result& result) { Bench::Runner::Print(std::cout, result); });
+
+#ifdef NDEBUG
+   const std::string buildType = "release";
+#else
+   const std::string buildType = "debug";
+#endif
+   std::ofstream jsonFile(jsonFileName);
+   if (!jsonFile)
+   {
+      std::cerr << "Can't write " << jsonFileName << std::endl;
+      return 1;
+   }
+   Bench::Runner::WriteJson(jsonFile, results, buildType);
+   std::cout << std::endl << results.size() << " benchmark(s), results are written to " << jsonFileName << std::endl;
+   return 0;
+}
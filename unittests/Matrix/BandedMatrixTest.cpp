@@ -0,0 +1,127 @@
+#include "../stdafx.h"
+
+#include "MatrixTest.h"
+#include "../../SMT/Matrix/BandedMatrix.h"
+#include "../../SMT/Matrix/MatrixOperations.h"
+
+class BandedMatrixTest : public MatrixTest
+{
+protected:
+   static double BandElement(size_t row, size_t column)
+   {
+      return (row == column) ? 2.0 + static_cast<double>(row % 3) : static_cast<double>((row * 7 + column * 3) % 5) - 2.0;
+   }
+   static std::function<double(size_t, size_t)> BandFunc(size_t lowerBandwidth, size_t upperBandwidth)
+   {
+      return [=](size_t row, size_t column) { return ((column + lowerBandwidth >= row) && (column <= row + upperBandwidth)) ? BandElement(row, column) : 0.0; };
+   }
+};
+
+TEST_F(BandedMatrixTest, Elements)
+{
+   const size_t size = 10;
+   const SMT::BandedMatrix<double> bandedMatrix(size, 2, 1, BandElement);
+   EXPECT_EQ(bandedMatrix.LowerBandwidth(), 2);
+   EXPECT_EQ(bandedMatrix.UpperBandwidth(), 1);
+   CheckForEachElement<double>(bandedMatrix, BandFunc(2, 1), true, SMT::MatrixSettings::One<double>());
+
+   // The band of a standard matrix
+   const SMT::BandedMatrix<double> copy(SMT::StandardMatrix<double>(size, size, BandElement), 2, 1);
+   CheckForEachElement<double>(copy, BandFunc(2, 1), true, SMT::MatrixSettings::One<double>());
+
+   // Copies share the band
+   auto copyResult = bandedMatrix.Copy();
+   EXPECT_EQ(copyResult.Matrix_->TypeName(), "BandedMatrix");
+   EXPECT_EQ(static_cast<const SMT::BandedMatrix<double>&>(*copyResult.Matrix_).Band(), bandedMatrix.Band());
+
+   auto transposeResult = SMT::Transpose<double>(bandedMatrix);
+   ASSERT_TRUE(transposeResult.Matrix_ != nullptr);
+   EXPECT_EQ(transposeResult.Matrix_->TypeName(), "BandedMatrix");
+   EXPECT_EQ(static_cast<const SMT::BandedMatrix<double>&>(*transposeResult.Matrix_).LowerBandwidth(), 1);
+   CheckForEachElement<double>(*transposeResult.Matrix_, [](size_t row, size_t column) { return BandFunc(2, 1)(column, row); }, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(BandedMatrixTest, AdditionAndMultiplication)
+{
+   const size_t size = 40;
+   const SMT::BandedMatrix<double> bandedMatrix(size, 2, 1, BandElement);
+   const SMT::BandedMatrix<double> otherMatrix(size, 0, 3, BandElement);
+   const SMT::StandardMatrix<double> standardMatrix(bandedMatrix);
+   const SMT::StandardMatrix<double> otherStandardMatrix(otherMatrix);
+   const SMT::StandardMatrix<double> rightMatrix(size, 7, DenseElement);
+   const SMT::StandardMatrix<double> leftMatrix(9, size, DenseElement);
+
+   EXPECT_EQ(bandedMatrix.AdditionComplexity(otherMatrix), SMT::Complexity::Linear);
+   auto sum = SMT::Add<double>(bandedMatrix, otherMatrix);
+   CheckResult(sum, "BandedMatrix", *SMT::Add<double>(standardMatrix, otherStandardMatrix).Matrix_, 1.0);
+   EXPECT_EQ(static_cast<const SMT::BandedMatrix<double>&>(*sum.Matrix_).UpperBandwidth(), 3);
+   const SMT::StandardMatrix<double> denseMatrix(size, size, DenseElement);
+   CheckResult(SMT::Add<double>(denseMatrix, bandedMatrix), "StandardMatrix", *SMT::Add<double>(denseMatrix, standardMatrix).Matrix_, 1.0);
+   CheckResult(SMT::MultiplyByNumber<double>(bandedMatrix, 0.5), "BandedMatrix", *SMT::MultiplyByNumber<double>(standardMatrix, 0.5).Matrix_, 1.0);
+
+   // The product of banded matrices is banded with the summed bandwidths
+   EXPECT_EQ(bandedMatrix.MultiplyComplexity(otherMatrix, false), SMT::Complexity::Linear);
+   auto product = SMT::Multiply<double>(bandedMatrix, otherMatrix);
+   CheckResult(product, "BandedMatrix", *SMT::Multiply<double>(standardMatrix, otherStandardMatrix).Matrix_, 1e2);
+   EXPECT_EQ(static_cast<const SMT::BandedMatrix<double>&>(*product.Matrix_).LowerBandwidth(), 2);
+   EXPECT_EQ(static_cast<const SMT::BandedMatrix<double>&>(*product.Matrix_).UpperBandwidth(), 4);
+   CheckResult(SMT::Multiply<double>(otherMatrix, bandedMatrix), "BandedMatrix", *SMT::Multiply<double>(otherStandardMatrix, standardMatrix).Matrix_, 1e2);
+
+   CheckResult(SMT::Multiply<double>(bandedMatrix, rightMatrix), "StandardMatrix", *SMT::Multiply<double>(standardMatrix, rightMatrix).Matrix_, 1e2);
+   CheckResult(SMT::Multiply<double>(leftMatrix, bandedMatrix), "StandardMatrix", *SMT::Multiply<double>(leftMatrix, standardMatrix).Matrix_, 1e2);
+
+   // Parallel products are the same as serial ones
+   const size_t threshold = SMT::ParallelSettings::MultiplyThreshold();
+   SMT::ParallelSettings::SetMultiplyThreshold(1);
+   CheckResult(SMT::Multiply<double>(bandedMatrix, otherMatrix), "BandedMatrix", *SMT::Multiply<double>(standardMatrix, otherStandardMatrix).Matrix_, 1e2);
+   CheckResult(SMT::Multiply<double>(leftMatrix, bandedMatrix), "StandardMatrix", *SMT::Multiply<double>(leftMatrix, standardMatrix).Matrix_, 1e2);
+   SMT::ParallelSettings::SetMultiplyThreshold(threshold);
+
+   EXPECT_EQ(bandedMatrix.Multiply(leftMatrix, false).Code_, SMT::OperationResultCode::Error);
+
+   // Small factors of the dense matrix aren't dropped
+   const SMT::BandedMatrix<double> tridiagonalMatrix(3, 1, 1, [](size_t, size_t) { return 1.0; });
+   const SMT::StandardMatrix<double> smallMatrix(2, 3, [](size_t, size_t) { return 1e-17; });
+   auto smallProduct = SMT::Multiply<double>(smallMatrix, tridiagonalMatrix);
+   ASSERT_TRUE(smallProduct.Matrix_ != nullptr);
+   EXPECT_DOUBLE_EQ(smallProduct.Matrix_->Element(0, 0), 2e-17);
+   EXPECT_DOUBLE_EQ(smallProduct.Matrix_->Element(1, 1), 3e-17);
+}
+
+TEST_F(BandedMatrixTest, SolvingAndDeterminant)
+{
+   const size_t size = 60;
+   const SMT::BandedMatrix<double> bandedMatrix(size, 3, 2, BandElement);
+   const SMT::StandardMatrix<double> standardMatrix(bandedMatrix);
+   const SMT::StandardMatrix<double> rightHandSide(size, 4, DenseElement);
+
+   // The banded LU decomposition agrees with the dense one
+   EXPECT_EQ(bandedMatrix.DeterminantEvaluationComplexity(), SMT::Complexity::Linear);
+   auto determinant = SMT::Determinant<double>(bandedMatrix);
+   auto expectedDeterminant = SMT::Determinant<double>(standardMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   ASSERT_TRUE(expectedDeterminant.Value_ != nullptr);
+   EXPECT_NEAR(*determinant.Value_ / *expectedDeterminant.Value_, 1.0, 1e-9);
+
+   // The planner prefers the banded solver to LU of a standard copy
+   EXPECT_EQ(bandedMatrix.SolvingComplexity(SMT::StandardMatrix<double>(size, 1)), SMT::Complexity::Linear);
+   EXPECT_EQ(SMT::Planner::SolvingPlans<double>(bandedMatrix, rightHandSide).front().Strategy_, SMT::Planner::Strategy::NativeFirst);
+   auto solution = SMT::Solve<double>(bandedMatrix, rightHandSide);
+   EXPECT_EQ(solution.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(solution.Matrix_ != nullptr);
+   EXPECT_EQ(solution.Matrix_->TypeName(), "StandardMatrix");
+   CheckResult(SMT::Multiply<double>(bandedMatrix, *solution.Matrix_), "StandardMatrix", rightHandSide, 1e6);
+   CheckResult(SMT::Solve<double>(standardMatrix, rightHandSide), "StandardMatrix", *solution.Matrix_, 1e6);
+
+   auto inverse = SMT::Invert<double>(bandedMatrix);
+   ASSERT_TRUE(inverse.Matrix_ != nullptr);
+   CheckResult(SMT::Multiply<double>(bandedMatrix, *inverse.Matrix_), "StandardMatrix", SMT::StandardMatrix<double>(size, size, SMT::MatrixSettings::IdentityMatrixFunction<double>()), 1e6);
+
+   // The determinant of the 5 x 5 tridiagonal matrix of ones is zero
+   const SMT::BandedMatrix<double> singularMatrix(5, 1, 1, [](size_t, size_t) { return 1.0; });
+   determinant = SMT::Determinant<double>(singularMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, 0.0);
+   EXPECT_EQ(SMT::Solve<double>(singularMatrix, SMT::StandardMatrix<double>(5, 1)).Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ(SMT::Invert<double>(singularMatrix).Code_, SMT::OperationResultCode::Error);
+}
@@ -0,0 +1,163 @@
+#include "../stdafx.h"
+
+#include "MatrixTest.h"
+#include "../../SMT/Matrix/DiagonalMatrix.h"
+
+class DiagonalMatrixTest : public MatrixTest
+{
+protected:
+   static double DiagonalElement(size_t index)
+   {
+      return static_cast<double>(index) + 1.0;
+   }
+
+   static std::shared_ptr<SMT::DiagonalMatrix<double>> CreateDiagonalMatrix(size_t size)
+   {
+      std::vector<double> diagonal(size);
+      for (size_t index = 0; index < size; ++index)
+      {
+         diagonal[index] = DiagonalElement(index);
+      }
+      auto result = std::make_shared<SMT::DiagonalMatrix<double>>(std::move(diagonal));
+
+      EXPECT_EQ(size, result->RowCount());
+      EXPECT_EQ(size, result->ColumnCount());
+
+      return result;
+   }
+};
+
+TEST_F(DiagonalMatrixTest, Elements)
+{
+   const size_t size = 9;
+   auto diagonalMatrix = CreateDiagonalMatrix(size);
+   auto diagonalFunc = [](size_t row, size_t column) { return (row == column) ? DiagonalElement(row) : 0.0; };
+   CheckForEachElement<double>(*diagonalMatrix, diagonalFunc, true, SMT::MatrixSettings::One<double>());
+   EXPECT_EQ(diagonalMatrix->Element(4, 4), 5.0);
+   EXPECT_EQ(diagonalMatrix->Element(4, 5), 0.0);
+
+   // The tile crosses the diagonal partially
+   std::vector<double> tile(3 * 4, -1.0);
+   diagonalMatrix->CopyTile(2, 3, 3, 4, tile.data(), 4);
+   for (size_t row = 0; row < 3; ++row)
+   {
+      for (size_t column = 0; column < 4; ++column)
+      {
+         EXPECT_EQ(tile[row * 4 + column], diagonalFunc(2 + row, 3 + column));
+      }
+   }
+
+   const SMT::ScalarMatrix<double> scalarMatrix(size, 3.0);
+   CheckForEachElement<double>(scalarMatrix, [](size_t row, size_t column) { return (row == column) ? 3.0 : 0.0; }, true, SMT::MatrixSettings::One<double>());
+   const SMT::IdentityMatrix<double> identityMatrix(size);
+   EXPECT_TRUE(SMT::CheckIfIdentityMatrix(identityMatrix));
+   const SMT::ZeroMatrix<double> zeroMatrix(size, size + 2);
+   EXPECT_TRUE(SMT::CheckIfZeroMatrix(zeroMatrix));
+   EXPECT_TRUE(SMT::CheckIfDiagonalMatrix(*diagonalMatrix));
+
+   // Copies keep the type and share the diagonal
+   auto copyResult = diagonalMatrix->Copy();
+   CheckResult(copyResult, "DiagonalMatrix", diagonalFunc);
+   EXPECT_EQ(static_cast<const SMT::DiagonalMatrix<double>&>(*copyResult.Matrix_).Diagonal(), diagonalMatrix->Diagonal());
+   CheckResult(identityMatrix.Copy(), "IdentityMatrix", SMT::MatrixSettings::IdentityMatrixFunction<double>());
+   CheckResult(zeroMatrix.Transpose(), "ZeroMatrix", [](size_t, size_t) { return 0.0; });
+   EXPECT_EQ(zeroMatrix.Transpose().Matrix_->RowCount(), size + 2);
+}
+
+TEST_F(DiagonalMatrixTest, Addition)
+{
+   const size_t size = 8;
+   auto diagonalMatrix = CreateDiagonalMatrix(size);
+   const SMT::ScalarMatrix<double> scalarMatrix(size, 3.0);
+   const SMT::IdentityMatrix<double> identityMatrix(size);
+   const SMT::ZeroMatrix<double> zeroMatrix(size, size);
+   const SMT::StandardMatrix<double> standardMatrix(size, size, DenseElement);
+   auto diagonalFunc = [](size_t row, size_t column) { return (row == column) ? DiagonalElement(row) : 0.0; };
+
+   CheckResult(SMT::Add<double>(*diagonalMatrix, *diagonalMatrix), "DiagonalMatrix", [&](size_t row, size_t column) { return 2.0 * diagonalFunc(row, column); });
+   CheckResult(SMT::Add<double>(*diagonalMatrix, scalarMatrix), "DiagonalMatrix", [&](size_t row, size_t column) { return diagonalFunc(row, column) + ((row == column) ? 3.0 : 0.0); });
+   CheckResult(SMT::Add<double>(scalarMatrix, identityMatrix), "ScalarMatrix", [](size_t row, size_t column) { return (row == column) ? 4.0 : 0.0; });
+   CheckResult(SMT::Add<double>(standardMatrix, *diagonalMatrix), "StandardMatrix", [&](size_t row, size_t column) { return DenseElement(row, column) + diagonalFunc(row, column); });
+   CheckResult(SMT::Add<double>(identityMatrix, standardMatrix), "StandardMatrix", [](size_t row, size_t column) { return DenseElement(row, column) + ((row == column) ? 1.0 : 0.0); });
+
+   // A sum with the zero matrix is a copy of another matrix
+   EXPECT_EQ(zeroMatrix.AdditionComplexity(*diagonalMatrix), SMT::Complexity::Constant);
+   EXPECT_EQ(zeroMatrix.AdditionComplexity(standardMatrix), SMT::Complexity::Constant);
+   CheckResult(SMT::Add<double>(zeroMatrix, *diagonalMatrix), "DiagonalMatrix", diagonalFunc);
+   CheckResult(SMT::Add<double>(standardMatrix, zeroMatrix), "StandardMatrix", DenseElement);
+
+   CheckResult(SMT::MultiplyByNumber<double>(*diagonalMatrix, 2.0), "DiagonalMatrix", [&](size_t row, size_t column) { return 2.0 * diagonalFunc(row, column); });
+   CheckResult(SMT::MultiplyByNumber<double>(identityMatrix, 2.0), "ScalarMatrix", [](size_t row, size_t column) { return (row == column) ? 2.0 : 0.0; });
+
+   EXPECT_EQ(diagonalMatrix->Add(SMT::ZeroMatrix<double>(size, size + 1)).Code_, SMT::OperationResultCode::Error);
+}
+
+TEST_F(DiagonalMatrixTest, Multiplication)
+{
+   const size_t size = 7;
+   auto diagonalMatrix = CreateDiagonalMatrix(size);
+   const SMT::ScalarMatrix<double> scalarMatrix(size, 3.0);
+   const SMT::IdentityMatrix<double> identityMatrix(size);
+   const SMT::StandardMatrix<double> standardMatrix(size, size + 3, DenseElement);
+   const SMT::StandardMatrix<double> leftStandardMatrix(size + 2, size, DenseElement);
+
+   // Rows or columns of another matrix are scaled
+   EXPECT_EQ(diagonalMatrix->MultiplyComplexity(standardMatrix, false), SMT::Complexity::Quadratic);
+   CheckResult(SMT::Multiply<double>(*diagonalMatrix, standardMatrix), "StandardMatrix", [](size_t row, size_t column) { return DiagonalElement(row) * DenseElement(row, column); });
+   CheckResult(SMT::Multiply<double>(leftStandardMatrix, *diagonalMatrix), "StandardMatrix", [](size_t row, size_t column) { return DenseElement(row, column) * DiagonalElement(column); });
+   CheckResult(SMT::Multiply<double>(*diagonalMatrix, *diagonalMatrix), "DiagonalMatrix", [](size_t row, size_t column) { return (row == column) ? DiagonalElement(row) * DiagonalElement(row) : 0.0; });
+
+   // Scalar matrices multiply another matrix by the number, the identity one copies it
+   CheckResult(SMT::Multiply<double>(scalarMatrix, standardMatrix), "StandardMatrix", [](size_t row, size_t column) { return 3.0 * DenseElement(row, column); });
+   CheckResult(SMT::Multiply<double>(*diagonalMatrix, scalarMatrix), "DiagonalMatrix", [](size_t row, size_t column) { return (row == column) ? 3.0 * DiagonalElement(row) : 0.0; });
+   EXPECT_EQ(identityMatrix.MultiplyComplexity(standardMatrix, false), SMT::Complexity::Constant);
+   CheckResult(SMT::Multiply<double>(identityMatrix, standardMatrix), "StandardMatrix", DenseElement);
+   CheckResult(SMT::Multiply<double>(leftStandardMatrix, identityMatrix), "StandardMatrix", DenseElement);
+
+   // A product with the zero matrix is a zero matrix of the size of the product
+   const SMT::ZeroMatrix<double> zeroMatrix(size + 2, size);
+   auto result = SMT::Multiply<double>(zeroMatrix, standardMatrix);
+   CheckResult(result, "ZeroMatrix", [](size_t, size_t) { return 0.0; });
+   EXPECT_EQ(result.Matrix_->RowCount(), size + 2);
+   EXPECT_EQ(result.Matrix_->ColumnCount(), size + 3);
+
+   EXPECT_EQ(diagonalMatrix->Multiply(leftStandardMatrix, false).Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ(zeroMatrix.Multiply(zeroMatrix, false).Code_, SMT::OperationResultCode::Error);
+}
+
+TEST_F(DiagonalMatrixTest, InversionAndDeterminant)
+{
+   const size_t size = 6;
+   auto diagonalMatrix = CreateDiagonalMatrix(size);
+   const SMT::ScalarMatrix<double> scalarMatrix(size, 2.0);
+   const SMT::IdentityMatrix<double> identityMatrix(size);
+   const SMT::ZeroMatrix<double> zeroMatrix(size, size);
+
+   EXPECT_EQ(diagonalMatrix->InversionComplexity(), SMT::Complexity::Linear);
+   CheckResult(SMT::Invert<double>(*diagonalMatrix), "DiagonalMatrix", [](size_t row, size_t column) { return (row == column) ? 1.0 / DiagonalElement(row) : 0.0; });
+   CheckResult(SMT::Invert<double>(scalarMatrix), "ScalarMatrix", [](size_t row, size_t column) { return (row == column) ? 0.5 : 0.0; });
+   CheckResult(SMT::Invert<double>(identityMatrix), "IdentityMatrix", SMT::MatrixSettings::IdentityMatrixFunction<double>());
+   EXPECT_EQ(SMT::Invert<double>(zeroMatrix).Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ(SMT::Invert<double>(SMT::DiagonalMatrix<double>({ 1.0, 0.0, 2.0 })).Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ(SMT::Invert<double>(SMT::ScalarMatrix<double>(3, 0.0)).Code_, SMT::OperationResultCode::Error);
+
+   CheckResult(SMT::Transpose<double>(*diagonalMatrix), "DiagonalMatrix", [](size_t row, size_t column) { return (row == column) ? DiagonalElement(row) : 0.0; });
+
+   auto determinant = SMT::Determinant<double>(*diagonalMatrix);
+   EXPECT_EQ(determinant.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, 720.0);
+   determinant = SMT::Determinant<double>(scalarMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, 64.0);
+   determinant = SMT::Determinant<double>(SMT::ScalarMatrix<double>(11, -2.0));
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, -2048.0);
+   determinant = SMT::Determinant<double>(identityMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, 1.0);
+   determinant = SMT::Determinant<double>(zeroMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, 0.0);
+   EXPECT_EQ(SMT::Determinant<double>(SMT::ZeroMatrix<double>(2, 3)).Code_, SMT::OperationResultCode::Error);
+}
@@ -2,6 +2,10 @@
 
 #include "MatrixTest.h"
 
+#include <atomic>
+#include <thread>
+
+#include "../../SMT/Matrix/BlockMatrix.h"
 #include "../../SMT/Matrix/FunctionMatrix.h"
 
 class FunctionMatrixTest : public MatrixTest
@@ -169,3 +173,311 @@ TEST_F(FunctionMatrixTest, Determination)
    auto result = matrix->Determinant();
    EXPECT_EQ(result.Code_, SMT::OperationResultCode::NotImplemented);
 }
+
+TEST_F(FunctionMatrixTest, MixedOperations)
+{
+   // A function matrix is read by tiles (FunctionMatrix::CopyTile) when it is added to/multiplied by a standard matrix
+   auto initFunc1 = [](size_t row, size_t column)->double { return static_cast<double>(row) * 10.0 + static_cast<double>(column); };
+   auto initFunc2 = [](size_t row, size_t column)->double { return static_cast<double>(column) * 3.0 - static_cast<double>(row); };
+   const size_t size = 23;
+   auto functionMatrix = CreateFunctionMatrix(size, size, initFunc1);
+   SMT::StandardMatrix<double> standardMatrix(size, size, initFunc2);
+
+   auto sumResult = SMT::Add(*functionMatrix, standardMatrix);
+   ASSERT_TRUE(sumResult.Matrix_ != nullptr);
+   auto sumFunc = [initFunc1, initFunc2](size_t row, size_t column) -> double { return initFunc1(row, column) + initFunc2(row, column); };
+   CheckForEachElement<double>(*sumResult.Matrix_, sumFunc, true, SMT::MatrixSettings::One<double>());
+
+   auto productResult = SMT::Multiply(*functionMatrix, standardMatrix);
+   ASSERT_TRUE(productResult.Matrix_ != nullptr);
+   auto productFunc = [initFunc1, initFunc2, size](size_t row, size_t column) -> double
+   {
+      double result = 0.0;
+      for (size_t i = 0; i < size; ++i)
+      {
+         result += initFunc1(row, i) * initFunc2(i, column);
+      }
+      return result;
+   };
+   CheckForEachElement<double>(*productResult.Matrix_, productFunc, true, SMT::MatrixSettings::One<double>());
+
+   auto identityMatrix = CreateFunctionMatrix(size, size, SMT::MatrixSettings::IdentityMatrixFunction<double>());
+   EXPECT_TRUE(SMT::CheckIfIdentityMatrix(*identityMatrix));
+   EXPECT_TRUE(SMT::CheckIfDiagonalMatrix(*identityMatrix));
+   EXPECT_FALSE(SMT::CheckIfZeroMatrix(*identityMatrix));
+   EXPECT_FALSE(SMT::CheckIfIdentityMatrix(*functionMatrix));
+}
+
+TEST_F(FunctionMatrixTest, TileCache)
+{
+   auto callCount = std::make_shared<std::atomic<size_t>>(0);
+   auto valueFunc = [](size_t row, size_t column)->double { return static_cast<double>(row) * 100.0 + static_cast<double>(column); };
+   auto initFunc = [callCount, valueFunc](size_t row, size_t column)->double { ++*callCount; return valueFunc(row, column); };
+   const size_t rowCount = 50;
+   const size_t columnCount = 70;
+   SMT::FunctionMatrix<double> matrix(rowCount, columnCount, initFunc);
+   SMT::FunctionMatrix<double>::CachePolicy policy;
+   policy.TileSize_ = 16;
+   policy.ByteBudget_ = rowCount * columnCount * sizeof(double);
+   matrix.SetCachePolicy(policy);
+
+   // Every element is computed once, then it is read from the cache
+   CheckForEachElement<double>(matrix, valueFunc, true, 1.0);
+   CheckForEachElement<double>(matrix, valueFunc, true, 1.0);
+   for (size_t row = 0; row < rowCount; ++row)
+   {
+      for (size_t column = 0; column < columnCount; ++column)
+      {
+         EXPECT_EQ(matrix.Element(row, column), valueFunc(row, column));
+      }
+   }
+   EXPECT_EQ(callCount->load(), rowCount * columnCount);
+   ASSERT_TRUE(matrix.Cache() != nullptr);
+   EXPECT_EQ(matrix.Cache()->MissCount(), 4u * 5u);
+
+   // A copy shares the cache
+   SMT::FunctionMatrix<double> copy(matrix);
+   *callCount = 0;
+   CheckForEachElement<double>(copy, valueFunc, true, 1.0);
+   EXPECT_EQ(callCount->load(), 0u);
+
+   // Tiles which don't fit into the budget are evicted (the least recently used first)
+   policy.ByteBudget_ = 2 * 16 * 16 * sizeof(double);
+   matrix.SetCachePolicy(policy);
+   CheckForEachElement<double>(matrix, valueFunc, true, 1.0);
+   EXPECT_LE(matrix.Cache()->ByteCount(), policy.ByteBudget_);
+   EXPECT_EQ(matrix.Cache()->Data(), nullptr);
+   EXPECT_EQ(matrix.RowData(0), nullptr);
+}
+
+TEST_F(FunctionMatrixTest, MaterializationOnMultiplication)
+{
+   auto callCount = std::make_shared<std::atomic<size_t>>(0);
+   auto leftValueFunc = [](size_t row, size_t column)->double { return static_cast<double>(row + 2 * column) * 0.25; };
+   auto leftFunc = [callCount, leftValueFunc](size_t row, size_t column)->double { ++*callCount; return leftValueFunc(row, column); };
+   auto rightFunc = [](size_t row, size_t column)->double { return static_cast<double>(row) - static_cast<double>(column); };
+   const size_t m = 40;
+   const size_t k = 30;
+   const size_t n = 20;
+   SMT::FunctionMatrix<double> left(m, k, leftFunc);
+   SMT::StandardMatrix<double> right(k, n, rightFunc);
+   SMT::FunctionMatrix<double>::CachePolicy policy;
+   policy.ByteBudget_ = m * k * sizeof(double);
+   policy.MaterializeReuseCount_ = n + 1;
+   left.SetCachePolicy(policy);
+
+   auto resultFunc = [leftValueFunc, rightFunc, k](size_t row, size_t column)->double
+   {
+      double sum = 0.0;
+      for (size_t i = 0; i < k; ++i)
+      {
+         sum += leftValueFunc(row, i) * rightFunc(i, column);
+      }
+      return sum;
+   };
+
+   // The reuse (n) is less than the policy requires: the matrix isn't materialized
+   auto result = SMT::Multiply<double>(left, right);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   EXPECT_EQ(left.RowData(0), nullptr);
+
+   // Enough reuse: the whole matrix is kept and its rows are available, the function isn't called again
+   policy.MaterializeReuseCount_ = n;
+   left.SetCachePolicy(policy);
+   result = SMT::Multiply<double>(left, right);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   ASSERT_TRUE(left.RowData(0) != nullptr);
+   *callCount = 0;
+   result = SMT::Multiply<double>(left, right);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   EXPECT_EQ(callCount->load(), 0u);
+   CheckForEachElement<double>(*result.Matrix_, resultFunc, false, 100.0);
+}
+
+TEST_F(FunctionMatrixTest, CompileTimeComposition)
+{
+   auto func1 = [](size_t row, size_t column)->double { return static_cast<double>(row) * 10.0 + static_cast<double>(column); };
+   auto func2 = [](size_t row, size_t column)->double { return static_cast<double>(row) - 3.0 * static_cast<double>(column); };
+   const size_t rowCount = 7;
+   const size_t columnCount = 5;
+   auto matrix1 = SMT::MakeFunctionMatrix<double>(rowCount, columnCount, func1);
+   auto matrix2 = SMT::MakeFunctionMatrix<double>(columnCount, rowCount, func2);
+
+   // (matrix1 * 2)^T + matrix2: the function of the result is a composition of the lambdas (no std::function inside)
+   auto result = matrix1.Scaled(2.0).Transposed().Plus(matrix2);
+   using ResultFunction = decltype(result)::Function;
+   static_assert(std::is_same<ResultFunction, SMT::Details::SumFunction<double,
+      SMT::Details::TransposedFunction<double, SMT::Details::ScaledFunction<double, decltype(func1)>>, decltype(func2)>>::value, "Composition is typed");
+   EXPECT_EQ(result.RowCount(), columnCount);
+   EXPECT_EQ(result.ColumnCount(), rowCount);
+   CheckForEachElement<double>(result, [func1, func2](size_t row, size_t column) { return func1(column, row) * 2.0 + func2(row, column); }, true, 1.0);
+
+   // Matrix operations return the type-erased matrix
+   auto sum = result.Add(result);
+   ASSERT_EQ(sum.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(std::dynamic_pointer_cast<SMT::FunctionMatrix<double>>(sum.Matrix_) != nullptr);
+   CheckForEachElement<double>(*sum.Matrix_, [func1, func2](size_t row, size_t column) { return 2.0 * (func1(column, row) * 2.0 + func2(row, column)); }, true, 1.0);
+   // A typed matrix is added to a type-erased one too
+   sum = sum.Matrix_->Add(result);
+   ASSERT_EQ(sum.Code_, SMT::OperationResultCode::Ok);
+   CheckForEachElement<double>(*sum.Matrix_, [func1, func2](size_t row, size_t column) { return 3.0 * (func1(column, row) * 2.0 + func2(row, column)); }, true, 1.0);
+}
+
+TEST_F(FunctionMatrixTest, RuntimeComposition)
+{
+   using ElementFunc = SMT::FunctionMatrix<double>::ElementFunc;
+   using ScaledFunction = SMT::Details::ScaledFunction<double, SMT::Details::SharedFunction<double, ElementFunc>>;
+   using TransposedFunction = SMT::Details::TransposedFunction<double, SMT::Details::SharedFunction<double, ElementFunc>>;
+   auto func = [](size_t row, size_t column)->double { return static_cast<double>(row) * 10.0 + static_cast<double>(column); };
+   SMT::FunctionMatrix<double> matrix(4, 6, func);
+
+   // Scaling of a scaled function isn't folded: the elements are rounded after every scaling, like the elements of a
+   // stored matrix (0.1 * 3.0 isn't 0.3 exactly, so one scaling by 0.3 would give other elements)
+   auto scaledOnce = matrix.MultiplyByNumber(0.1).Matrix_;
+   auto scaled = scaledOnce->MultiplyByNumber(3.0).Matrix_;
+   auto scaledFunc = std::dynamic_pointer_cast<SMT::FunctionMatrix<double>>(scaled)->GetFunction();
+   auto scaledTarget = scaledFunc.target<ScaledFunction>();
+   ASSERT_TRUE(scaledTarget != nullptr);
+   EXPECT_EQ(scaledTarget->Number_, 3.0);
+   EXPECT_EQ(scaledTarget->Func_.Func_, std::dynamic_pointer_cast<SMT::FunctionMatrix<double>>(scaledOnce)->ElementFunction());
+   CheckForEachElement<double>(*scaled, [func](size_t row, size_t column) { return (func(row, column) * 0.1) * 3.0; }, true, 1.0);
+   CheckEquality<double>(SMT::StandardMatrix<double>(*scaled), *SMT::StandardMatrix<double>(matrix).MultiplyByNumber(0.1).Matrix_->MultiplyByNumber(3.0).Matrix_, true, 1.0);
+
+   // Transposition of a transposed function gives the original function
+   auto transposed = matrix.Transpose().Matrix_->Transpose().Matrix_;
+   auto transposedMatrix = std::dynamic_pointer_cast<SMT::FunctionMatrix<double>>(transposed);
+   EXPECT_TRUE(transposedMatrix->GetFunction().target<TransposedFunction>() == nullptr);
+   EXPECT_EQ(transposedMatrix->ElementFunction(), matrix.ElementFunction());
+   EXPECT_EQ(transposed->RowCount(), 4u);
+   CheckForEachElement<double>(*transposed, func, true, 1.0);
+}
+
+TEST_F(FunctionMatrixTest, BatchGenerator)
+{
+   auto valueFunc = [](size_t row, size_t column)->double { return static_cast<double>(row) * 0.5 - static_cast<double>(column) * 0.25; };
+   auto tileCallCount = std::make_shared<std::atomic<size_t>>(0);
+   auto tileFunc = [valueFunc, tileCallCount](size_t row, size_t column, size_t rowCount, size_t columnCount, double* buffer, size_t stride)
+   {
+      ++*tileCallCount;
+      for (size_t tileRow = 0; tileRow < rowCount; ++tileRow)
+      {
+         const double rowValue = static_cast<double>(row + tileRow) * 0.5;
+         for (size_t tileColumn = 0; tileColumn < columnCount; ++tileColumn)
+         {
+            buffer[tileRow * stride + tileColumn] = rowValue - static_cast<double>(column + tileColumn) * 0.25;
+         }
+      }
+   };
+   const size_t rowCount = 45;
+   const size_t columnCount = 38;
+   auto matrix = SMT::MakeBatchFunctionMatrix<double>(rowCount, columnCount, tileFunc);
+
+   // Element() uses the batch generator through the adapter
+   EXPECT_EQ(matrix.Element(7, 3), valueFunc(7, 3));
+
+   // Conversions fill whole tiles
+   *tileCallCount = 0;
+   SMT::StandardMatrix<double> standardMatrix(matrix);
+   EXPECT_EQ(tileCallCount->load(), 1u);
+   CheckForEachElement<double>(standardMatrix, valueFunc, true, 1.0);
+   *tileCallCount = 0;
+   SMT::BlockMatrix<double> blockMatrix(matrix, 16);
+   EXPECT_EQ(tileCallCount->load(), 3u * 3u);
+   CheckForEachElement<double>(blockMatrix, valueFunc, true, 1.0);
+
+   // Results of operations keep the batch generator
+   auto scaled = matrix.MultiplyByNumber(3.0).Matrix_;
+   auto transposed = scaled->Transpose().Matrix_;
+   auto sum = transposed->Add(SMT::FunctionMatrix<double>(columnCount, rowCount, [valueFunc](size_t row, size_t column) { return valueFunc(column, row); }));
+   ASSERT_TRUE(sum.Matrix_ != nullptr);
+   *tileCallCount = 0;
+   CheckForEachElement<double>(*sum.Matrix_, [valueFunc](size_t row, size_t column) { return valueFunc(column, row) * 4.0; }, false, 10.0);
+   EXPECT_EQ(tileCallCount->load(), 1u);
+
+   // The multiplication reads the operands by tiles too
+   SMT::FunctionMatrix<double> right(columnCount, 9, [](size_t row, size_t column) { return static_cast<double>(row + column); });
+   auto product = SMT::Multiply<double>(matrix, right);
+   ASSERT_TRUE(product.Matrix_ != nullptr);
+   auto expected = SMT::StandardMatrix<double>::Multiply(standardMatrix, SMT::StandardMatrix<double>(right));
+   CheckForEachElement<double>(*product.Matrix_, [&expected](size_t row, size_t column) { return expected.Matrix_->Element(row, column); }, false, 10.0);
+}
+
+TEST_F(FunctionMatrixTest, ConcurrentEvaluationOfComposition)
+{
+   auto func = [](size_t row, size_t column)->double { return std::sin(static_cast<double>(row)) + static_cast<double>(column) * 0.5; };
+   const size_t rowCount = 300;
+   const size_t columnCount = 200;
+   auto resultFunc = [func](size_t row, size_t column) { return (func(column, row) + func(column, row)) * 3.0; };
+
+   // The operands are destroyed, the result keeps their functions
+   SMT::Matrix<double>::SharedPtr result;
+   {
+      SMT::FunctionMatrix<double> matrix(rowCount, columnCount, func);
+      matrix.SetParallelFill(true);
+      auto sum = matrix.Add(SMT::FunctionMatrix<double>(matrix));
+      result = sum.Matrix_->MultiplyByNumber(3.0).Matrix_->Transpose().Matrix_;
+   }
+   ASSERT_TRUE(result != nullptr);
+
+   // Many threads compute elements at once
+   std::vector<double> elements(rowCount * columnCount);
+   SMT::ParallelSettings::Pool().ParallelFor(columnCount, [&](size_t row)
+   {
+      for (size_t column = 0; column < rowCount; ++column)
+      {
+         elements[row * rowCount + column] = result->Element(row, column);
+      }
+   });
+   for (size_t row = 0; row < columnCount; ++row)
+   {
+      for (size_t column = 0; column < rowCount; ++column)
+      {
+         ASSERT_EQ(elements[row * rowCount + column], resultFunc(row, column));
+      }
+   }
+
+   // Large tiles are filled in parallel: the operands allow it, so the result does
+   const SMT::IFunctionMatrix<double>* functionMatrix = dynamic_cast<const SMT::IFunctionMatrix<double>*>(result.get());
+   ASSERT_TRUE(functionMatrix != nullptr);
+   EXPECT_TRUE(functionMatrix->ParallelFill());
+   const size_t fillThreshold = SMT::ParallelSettings::FillThreshold();
+   SMT::ParallelSettings::SetFillThreshold(64);
+   SMT::StandardMatrix<double> standardMatrix(*result);
+   SMT::ParallelSettings::SetFillThreshold(fillThreshold);
+   CheckForEachElement<double>(standardMatrix, resultFunc, true, 1.0);
+}
+
+TEST_F(FunctionMatrixTest, ParallelFillIsOptIn)
+{
+   const std::thread::id callerId = std::this_thread::get_id();
+   std::atomic<size_t> otherThreadCallCount(0);
+   auto func = [callerId, &otherThreadCallCount](size_t row, size_t column)->double
+   {
+      if (std::this_thread::get_id() != callerId)
+      {
+         ++otherThreadCallCount;
+      }
+      return static_cast<double>(row * 3 + column);
+   };
+   const size_t fillThreshold = SMT::ParallelSettings::FillThreshold();
+   SMT::ParallelSettings::SetFillThreshold(64);
+
+   // By default the function is called only by the thread which reads the matrix
+   SMT::FunctionMatrix<double> matrix(100, 100, func);
+   EXPECT_FALSE(matrix.ParallelFill());
+   SMT::StandardMatrix<double> standardMatrix(matrix);
+   EXPECT_EQ(otherThreadCallCount.load(), 0u);
+
+   // A result keeps the setting only if all its operands allow it
+   SMT::FunctionMatrix<double> parallelMatrix(matrix);
+   parallelMatrix.SetParallelFill(true);
+   EXPECT_TRUE(SMT::FunctionMatrix<double>(parallelMatrix).ParallelFill());
+   EXPECT_TRUE(parallelMatrix.Scaled(2.0).ParallelFill());
+   EXPECT_TRUE(dynamic_cast<const SMT::IFunctionMatrix<double>&>(*parallelMatrix.Transpose().Matrix_).ParallelFill());
+   EXPECT_FALSE(dynamic_cast<const SMT::IFunctionMatrix<double>&>(*parallelMatrix.Add(matrix).Matrix_).ParallelFill());
+   EXPECT_FALSE(parallelMatrix.Plus(matrix).ParallelFill());
+   SMT::StandardMatrix<double> parallelStandardMatrix(parallelMatrix);
+   CheckEquality<double>(parallelStandardMatrix, standardMatrix, true, 1.0);
+
+   SMT::ParallelSettings::SetFillThreshold(fillThreshold);
+}
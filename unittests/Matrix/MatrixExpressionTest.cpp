@@ -0,0 +1,103 @@
+#include "../stdafx.h"
+
+#include "MatrixTest.h"
+
+#include "../../SMT/Matrix/FunctionMatrix.h"
+#include "../../SMT/Matrix/MatrixExpression.h"
+
+class MatrixExpressionTest : public MatrixTest
+{
+protected:
+   static double Product(const std::function<double(size_t, size_t)>& func1, const std::function<double(size_t, size_t)>& func2, size_t innerCount, size_t row, size_t column)
+   {
+      double result = 0.0;
+      for (size_t i = 0; i < innerCount; ++i)
+      {
+         result += func1(row, i) * func2(i, column);
+      }
+      return result;
+   }
+};
+
+TEST_F(MatrixExpressionTest, ProductPlusScaledMatrix)
+{
+   // A * B + 2 * C - C
+   auto initFunc1 = [](size_t row, size_t column)->double { return static_cast<double>((row * 7 + column * 3) % 11) - 5.0; };
+   auto initFunc2 = [](size_t row, size_t column)->double { return static_cast<double>((row * 5 + column * 2) % 13) - 6.0; };
+   auto initFunc3 = [](size_t row, size_t column)->double { return static_cast<double>(row) * 10.0 + static_cast<double>(column); };
+   const size_t rowCount = 37;
+   const size_t innerCount = 45;
+   const size_t columnCount = 29;
+   SMT::StandardMatrix<double> a(rowCount, innerCount, initFunc1);
+   SMT::StandardMatrix<double> b(innerCount, columnCount, initFunc2);
+   SMT::FunctionMatrix<double> c(rowCount, columnCount, initFunc3);
+
+   const auto expression = SMT::Lazy(a) * b + 2.0 * SMT::Lazy(c) - c;
+   EXPECT_EQ(expression.Code(), SMT::OperationResultCode::Ok);
+   EXPECT_EQ(expression.RowCount(), rowCount);
+   EXPECT_EQ(expression.ColumnCount(), columnCount);
+
+   auto result = expression.Evaluate();
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   auto resultFunc = [&](size_t row, size_t column) -> double { return Product(initFunc1, initFunc2, innerCount, row, column) + initFunc3(row, column); };
+   CheckForEachElement<double>(*result.Matrix_, resultFunc, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(MatrixExpressionTest, GemmIntoDestination)
+{
+   // C = 0.5 * A * B + 3 * C and A = A * B (the destination is an operand)
+   auto initFunc1 = [](size_t row, size_t column)->double { return static_cast<double>(row) - static_cast<double>(column); };
+   auto initFunc2 = [](size_t row, size_t column)->double { return static_cast<double>(row + column) * 0.25; };
+   auto initFunc3 = [](size_t row, size_t column)->double { return static_cast<double>(row * column); };
+   const size_t size = 20;
+   auto a = std::make_shared<SMT::StandardMatrix<double>>(size, size, initFunc1);
+   SMT::StandardMatrix<double> b(size, size, initFunc2);
+   auto c = std::make_shared<SMT::StandardMatrix<double>>(size, size, initFunc3);
+
+   auto result = (0.5 * SMT::Lazy<double>(*a) * b + 3.0 * SMT::Lazy<double>(*c)).EvaluateTo(c);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   EXPECT_EQ(result.Matrix_, c);
+   auto resultFunc = [&](size_t row, size_t column) -> double { return 0.5 * Product(initFunc1, initFunc2, size, row, column) + 3.0 * initFunc3(row, column); };
+   CheckForEachElement<double>(*c, resultFunc, true, SMT::MatrixSettings::One<double>());
+
+   result = (SMT::Lazy<double>(*a) * b).EvaluateTo(a);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   auto productFunc = [&](size_t row, size_t column) -> double { return Product(initFunc1, initFunc2, size, row, column); };
+   CheckForEachElement<double>(*a, productFunc, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(MatrixExpressionTest, ProductOfSums)
+{
+   // (A + B) * (A - B)
+   auto initFunc1 = [](size_t row, size_t column)->double { return static_cast<double>(row + 2 * column); };
+   auto initFunc2 = [](size_t row, size_t column)->double { return static_cast<double>(row == column ? 1 : 0); };
+   const size_t size = 15;
+   SMT::StandardMatrix<double> a(size, size, initFunc1);
+   SMT::FunctionMatrix<double> b(size, size, initFunc2);
+
+   auto result = ((SMT::Lazy(a) + b) * (SMT::Lazy(a) - b)).Evaluate();
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   auto sumFunc = [&](size_t row, size_t column) -> double { return initFunc1(row, column) + initFunc2(row, column); };
+   auto differenceFunc = [&](size_t row, size_t column) -> double { return initFunc1(row, column) - initFunc2(row, column); };
+   auto resultFunc = [&](size_t row, size_t column) -> double { return Product(sumFunc, differenceFunc, size, row, column); };
+   CheckForEachElement<double>(*result.Matrix_, resultFunc, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(MatrixExpressionTest, WrongSizes)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row + column); };
+   SMT::StandardMatrix<double> a(4, 5, initFunc);
+   SMT::StandardMatrix<double> b(4, 5, initFunc);
+
+   const auto product = SMT::Lazy(a) * b;
+   EXPECT_EQ(product.Code(), SMT::OperationResultCode::Error);
+   EXPECT_EQ((product + a).Evaluate().Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ((SMT::Lazy(a) + b).Code(), SMT::OperationResultCode::Ok);
+
+   auto destination = std::make_shared<SMT::StandardMatrix<double>>(5, 4);
+   auto result = (SMT::Lazy(a) + b).EvaluateTo(destination);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Error);
+   EXPECT_TRUE(result.Matrix_ == nullptr);
+}
@@ -11,36 +11,69 @@
 class MatrixTest : public ::testing::Test 
 {
 protected:
+   // Elements of a dense matrix without any structure: small integers from -6 to 6, so sums and products are exact
+   static double DenseElement(size_t row, size_t column)
+   {
+      return static_cast<double>((row * 5 + column * 3) % 13) - 6.0;
+   }
+
+   // Checks the result of an operation: its code, its type and its elements (they are compared exactly)
+   static void CheckResult(const SMT::Matrix<double>::OperationResult& result, const std::string& typeName, const std::function<double(size_t /*row*/, size_t /*column*/)>& func)
+   {
+      EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+      ASSERT_TRUE(result.Matrix_ != nullptr);
+      EXPECT_EQ(result.Matrix_->TypeName(), typeName);
+      CheckForEachElement<double>(*result.Matrix_, func, true, SMT::MatrixSettings::One<double>());
+   }
+   // Checks the result of an operation: its code, its type and its elements (compared with the expected matrix, e.g. the
+   // result of the standard matrix)
+   static void CheckResult(const SMT::Matrix<double>::OperationResult& result, const std::string& typeName, const SMT::Matrix<double>& expectedMatrix, double factor)
+   {
+      EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+      ASSERT_TRUE(result.Matrix_ != nullptr);
+      EXPECT_EQ(result.Matrix_->TypeName(), typeName);
+      ASSERT_EQ(result.Matrix_->RowCount(), expectedMatrix.RowCount());
+      ASSERT_EQ(result.Matrix_->ColumnCount(), expectedMatrix.ColumnCount());
+      CheckForEachElement<double>(*result.Matrix_, [&](size_t row, size_t column) { return expectedMatrix.Element(row, column); }, false, factor);
+   }
+
+   // Elements of the checked matrices are copied out by bulk access (Matrix::CopyTo), so comparing doesn't depend on Element()
    template<typename ElementType>
    static void CheckForEachElement(const SMT::Matrix<ElementType>& matrix, const std::function<ElementType(size_t /*row*/, size_t /*column*/)>& func, bool epsilonIsZero, ElementType factor)
    {
-	   const size_t columnCount = matrix.ColumnCount();
-	   const size_t rowCount = matrix.RowCount();
-	   for (size_t i = 0; i < rowCount; ++i)
-	   {
-		  for (size_t j = 0; j < columnCount; ++j)
-		  {
-			  if (epsilonIsZero)
-			  {
-				  EXPECT_EQ(matrix.Element(i, j), func(i, j));
-			  }
-			  else
-			  {
-              ASSERT_TRUE(SMT::MatrixSettings::CanAssumeItIsZero<double>(matrix.Element(i, j) - func(i, j), factor));
-			  }
-		  }
-	   }
+      const size_t columnCount = matrix.ColumnCount();
+      const size_t rowCount = matrix.RowCount();
+      std::vector<ElementType> elements(rowCount * columnCount);
+      matrix.CopyTo(elements.data(), columnCount);
+      for (size_t i = 0; i < rowCount; ++i)
+      {
+         for (size_t j = 0; j < columnCount; ++j)
+         {
+            if (epsilonIsZero)
+            {
+               EXPECT_EQ(elements[i * columnCount + j], func(i, j));
+            }
+            else
+            {
+               ASSERT_TRUE(SMT::MatrixSettings::CanAssumeItIsZero<double>(elements[i * columnCount + j] - func(i, j), factor));
+            }
+         }
+      }
    }
 
    template<typename ElementType>
    static void CheckEquality(const SMT::Matrix<ElementType>& matrix1, const SMT::Matrix<ElementType>& matrix2, bool epsilonIsZero, ElementType factor)
    {
       EXPECT_EQ(matrix1.TypeName(), matrix2.TypeName());
-      EXPECT_EQ(matrix1.ColumnCount(), matrix2.ColumnCount());
-      EXPECT_EQ(matrix1.RowCount(), matrix2.RowCount());
+      ASSERT_EQ(matrix1.ColumnCount(), matrix2.ColumnCount());
+      ASSERT_EQ(matrix1.RowCount(), matrix2.RowCount());
 
       const size_t columnCount = matrix1.ColumnCount();
       const size_t rowCount = matrix1.RowCount();
+      std::vector<ElementType> elements1(rowCount * columnCount);
+      std::vector<ElementType> elements2(rowCount * columnCount);
+      matrix1.CopyTo(elements1.data(), columnCount);
+      matrix2.CopyTo(elements2.data(), columnCount);
 
       for (size_t i = 0; i < rowCount; ++i)
       {
@@ -48,11 +81,11 @@ protected:
          {
             if (epsilonIsZero)
             {
-               EXPECT_EQ(matrix1.Element(i, j), matrix2.Element(i, j));
+               EXPECT_EQ(elements1[i * columnCount + j], elements2[i * columnCount + j]);
             }
             else
             {
-               ASSERT_TRUE(SMT::MatrixSettings::CanAssumeItIsZero<double>(matrix1.Element(i, j) - matrix2.Element(i, j), factor));
+               ASSERT_TRUE(SMT::MatrixSettings::CanAssumeItIsZero<double>(elements1[i * columnCount + j] - elements2[i * columnCount + j], factor));
             }
          }
       }
@@ -71,4 +104,4 @@ protected:
    }
 };
 
-#endif __MATRIX_TEST_H__
+#endif // __MATRIX_TEST_H__
\ No newline at end of file
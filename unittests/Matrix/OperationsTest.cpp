@@ -2,6 +2,8 @@
 #include "gtest/gtest.h"
 
 #include "../../SMT/Matrix/MatrixOperations.h"
+#include "../../SMT/Matrix/BlockMatrix.h"
+#include "../../SMT/Matrix/FunctionMatrix.h"
 #include "MatrixTest.h"
 
 class OperationsTest : public MatrixTest
@@ -16,6 +18,71 @@ protected:
 
       return result;
    }
+
+   // Every operation into an existing matrix is checked for operands of other types and for the matrix itself as an operand.
+   // Elements are small integers, so all results are exact.
+   static void CheckOperationsInto(const std::function<std::unique_ptr<SMT::Matrix<double>>(size_t /*rowCount*/, size_t /*columnCount*/)>& createMatrix)
+   {
+      auto func1 = [](size_t row, size_t column)->double { return static_cast<double>((row * 5 + column * 3) % 7) - 3.0; };
+      auto func2 = [](size_t row, size_t column)->double { return static_cast<double>((row + column * 2) % 5) - 2.0; };
+      const auto matrix1 = CreateStandardMatrix(19, 27, func1);
+      const SMT::FunctionMatrix<double> matrix2(19, 27, func2);
+      const SMT::BlockMatrix<double> matrix3(27, 23, 5, func2);
+
+      auto result = createMatrix(19, 27);
+      EXPECT_EQ(SMT::AddInto(*result, *matrix1, matrix2).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*result, [&](size_t row, size_t column) { return func1(row, column) + func2(row, column); }, true, 1.0);
+      EXPECT_EQ(SMT::AddInPlace(*result, *result).Code_, SMT::OperationResultCode::Ok);
+      EXPECT_EQ(SMT::ScaleInPlace(*result, 0.5).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*result, [&](size_t row, size_t column) { return func1(row, column) + func2(row, column); }, true, 1.0);
+      EXPECT_EQ(SMT::AddInto(*result, matrix2, *result).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*result, [&](size_t row, size_t column) { return func1(row, column) + 2.0 * func2(row, column); }, true, 1.0);
+      EXPECT_EQ(SMT::CopyInto(*result, matrix2).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*result, func2, true, 1.0);
+      EXPECT_EQ(SMT::AddInto(*result, *matrix1, matrix3).Code_, SMT::OperationResultCode::Error);
+
+      // C = 2 * A * B + 3 * C
+      auto product = createMatrix(19, 23);
+      EXPECT_EQ(SMT::MultiplyInto(*product, *matrix1, matrix3).Code_, SMT::OperationResultCode::Ok);
+      const auto requiredProduct = SMT::Multiply(*matrix1, matrix3);
+      ASSERT_TRUE(requiredProduct.Matrix_ != nullptr);
+      CheckForEachElement<double>(*product, [&](size_t row, size_t column) { return requiredProduct.Matrix_->Element(row, column); }, true, 1.0);
+      EXPECT_EQ(SMT::MultiplyInto(*product, matrix2, matrix3, 2.0, 3.0).Code_, SMT::OperationResultCode::Ok);
+      const auto requiredProduct2 = SMT::Multiply(matrix2, matrix3);
+      ASSERT_TRUE(requiredProduct2.Matrix_ != nullptr);
+      CheckForEachElement<double>(*product, [&](size_t row, size_t column) { return 2.0 * requiredProduct2.Matrix_->Element(row, column) + 3.0 * requiredProduct.Matrix_->Element(row, column); }, true, 1.0);
+      EXPECT_EQ(SMT::MultiplyInto(*product, *matrix1, *matrix1).Code_, SMT::OperationResultCode::Error);
+      EXPECT_EQ(SMT::MultiplyInto(*result, *matrix1, matrix3).Code_, SMT::OperationResultCode::Error);
+
+      // The matrix itself as an operand: S = S * S
+      auto square = createMatrix(23, 23);
+      SMT::CopyInto(*square, SMT::FunctionMatrix<double>(23, 23, func1));
+      EXPECT_EQ(SMT::MultiplyInto(*square, *square, *square).Code_, SMT::OperationResultCode::Ok);
+      const SMT::StandardMatrix<double> squareOperand(23, 23, func1);
+      const auto requiredSquare = SMT::Multiply(squareOperand, squareOperand);
+      CheckEquality<double>(static_cast<const SMT::Matrix<double>&>(SMT::StandardMatrix<double>(*square)), *requiredSquare.Matrix_, true, 1.0);
+
+      // Transposition of other matrices and of the matrix itself
+      auto transposed = createMatrix(27, 19);
+      EXPECT_EQ(SMT::TransposeInto(*transposed, *matrix1).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*transposed, [&](size_t row, size_t column) { return func1(column, row); }, true, 1.0);
+      EXPECT_EQ(SMT::TransposeInto(*transposed, matrix2).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*transposed, [&](size_t row, size_t column) { return func2(column, row); }, true, 1.0);
+      EXPECT_EQ(SMT::TransposeInto(*transposed, *transposed).Code_, SMT::OperationResultCode::Error);
+      SMT::CopyInto(*square, SMT::FunctionMatrix<double>(23, 23, func1));
+      EXPECT_EQ(SMT::TransposeInto(*square, *square).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*square, [&](size_t row, size_t column) { return func1(column, row); }, true, 1.0);
+
+      // Inversion into the matrix itself: inv(inv(A)) = A
+      auto invertible = createMatrix(6, 6);
+      auto invertibleFunc = [](size_t row, size_t column)->double { return (row == column) ? 10.0 : static_cast<double>((row + 2 * column) % 3); };
+      SMT::CopyInto(*invertible, SMT::FunctionMatrix<double>(6, 6, invertibleFunc));
+      EXPECT_EQ(SMT::InvertInto(*invertible, *invertible).Code_, SMT::OperationResultCode::Ok);
+      EXPECT_EQ(SMT::InvertInto(*invertible, *invertible).Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<double>(*invertible, invertibleFunc, false, 100.0);
+      EXPECT_EQ(SMT::InvertInto(*invertible, SMT::FunctionMatrix<double>(6, 6)).Code_, SMT::OperationResultCode::Error);
+      EXPECT_EQ(SMT::InvertInto(*result, *matrix1).Code_, SMT::OperationResultCode::Error);
+   }
 };
 
 TEST_F(OperationsTest, Addition)
@@ -90,6 +157,48 @@ TEST_F(OperationsTest, Multiplication)
    CheckForEachElement<double>(*matrix_4x4_1mult2.Matrix_, func1mult2, false, 1.0);
 }
 
+TEST_F(OperationsTest, StrassenWinogradMultiplication)
+{
+   // Elements are small integers, so both algorithms are exact. Odd dimensions are split at every level.
+   auto func1 = [](size_t row, size_t column)->double { return static_cast<double>((row * 5 + column * 3) % 7) - 3.0; };
+   auto func2 = [](size_t row, size_t column)->double { return static_cast<double>((row + column * 2) % 5) - 2.0; };
+   const auto leftMatrix = CreateStandardMatrix(101, 75, func1);
+   const auto rightMatrix = CreateStandardMatrix(75, 83, func2);
+   const auto expected = SMT::Multiply(*leftMatrix, *rightMatrix);
+   ASSERT_TRUE(expected.Matrix_ != nullptr);
+
+   SMT::AlignedMemoryResource heap;
+   SMT::PoolMemoryResource pool(heap);
+   SMT::MultiplyOptions options;
+   options.Algorithm_ = SMT::MultiplyOptions::Algorithm::StrassenWinograd;
+   options.CrossoverSize_ = 8;
+   options.Workspace_ = &pool;
+   EXPECT_GT(SMT::Kernels::StrassenWinogradWorkspaceSize(101, 83, 75, 8), 0u);
+   for (size_t call = 0; call < 2; ++call)
+   {
+      const auto product = SMT::Multiply(*leftMatrix, *rightMatrix, options);
+      EXPECT_EQ(product.Code_, SMT::OperationResultCode::Ok);
+      ASSERT_TRUE(product.Matrix_ != nullptr);
+      EXPECT_NE(product.Description_.find("Strassen-Winograd"), std::string::npos);
+      CheckForEachElement<double>(*product.Matrix_, [&](size_t row, size_t column) { return expected.Matrix_->Element(row, column); }, true, 1.0);
+   }
+   // The workspace of the second product is reused
+   EXPECT_EQ(pool.MissCount(), 1u);
+   EXPECT_EQ(pool.HitCount(), 1u);
+
+   // Parallel leaf products give the same result
+   const size_t threshold = SMT::ParallelSettings::MultiplyThreshold();
+   SMT::ParallelSettings::SetMultiplyThreshold(1);
+   options.CrossoverSize_ = 30;
+   CheckForEachElement<double>(*SMT::Multiply(*leftMatrix, *rightMatrix, options).Matrix_, [&](size_t row, size_t column) { return expected.Matrix_->Element(row, column); }, true, 1.0);
+   SMT::ParallelSettings::SetMultiplyThreshold(threshold);
+
+   // Products which are smaller than the crossover use the default plan
+   options.CrossoverSize_ = SMT::MultiplyOptions::DefaultCrossoverSize;
+   EXPECT_EQ(SMT::Multiply(*leftMatrix, *rightMatrix, options).Description_.find("Strassen-Winograd"), std::string::npos);
+   EXPECT_EQ(SMT::Multiply(*leftMatrix, *leftMatrix, options).Code_, SMT::OperationResultCode::Error);
+}
+
 TEST_F(OperationsTest, MultiplicationByNumber)
 {
    auto func = [](size_t row, size_t column)->double
@@ -160,4 +269,74 @@ TEST_F(OperationsTest, Determinant)
    EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
    ASSERT_TRUE(result.Value_ != nullptr);
    ASSERT_TRUE(SMT::MatrixSettings::CanAssumeItIsZero<double>(*result.Value_ + 1.0, 1.0));
-}
\ No newline at end of file
+}
+
+TEST_F(OperationsTest, MultiplyChain)
+{
+   // Fixed constants of the cost model, so the order doesn't depend on the machine.
+   // The machine ones are restored even when an assertion returns early.
+   struct ConstantsGuard
+   {
+      const SMT::Planner::MachineConstants machineConstants_ = SMT::Planner::Constants();
+      ~ConstantsGuard() { SMT::Planner::SetConstants(machineConstants_); }
+   } constantsGuard;
+   SMT::Planner::MachineConstants constants;
+   constants.SecondsPerFlop_ = 1.0e-10;
+   constants.SecondsPerByte_ = 1.0e-10;
+   constants.SecondsPerCall_ = 2.0e-9;
+   SMT::Planner::SetConstants(constants);
+
+   // 30x2 * 2x40 * 40x3 * 3x25: the cheapest order (1890 multiplications instead of 8250 from left to right) is
+   // M0 * ((M1 * M2) * M3)
+   auto func = [](size_t row, size_t column)->double
+   {
+      return static_cast<double>((row * 7 + column * 3) % 11) - 5.0;
+   };
+   const auto matrix1 = CreateStandardMatrix(30, 2, func);
+   const auto matrix2 = CreateStandardMatrix(2, 40, func);
+   const SMT::FunctionMatrix<double> matrix3(40, 3, func);
+   const auto matrix4 = CreateStandardMatrix(3, 25, func);
+
+   const auto result = SMT::MultiplyChain(*matrix1, *matrix2, matrix3, *matrix4);
+   EXPECT_NE(result.Code_, SMT::OperationResultCode::Error);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   EXPECT_EQ(result.Matrix_->RowCount(), 30u);
+   EXPECT_EQ(result.Matrix_->ColumnCount(), 25u);
+   EXPECT_NE(result.Description_.find("in order (0 ((1 2) 3))"), std::string::npos) << result.Description_;
+
+   const auto product12 = SMT::Multiply(*matrix1, *matrix2);
+   const auto product123 = SMT::Multiply(*product12.Matrix_, matrix3);
+   const auto requiredResult = SMT::Multiply(*product123.Matrix_, *matrix4);
+   CheckEquality<double>(*result.Matrix_, *requiredResult.Matrix_, false, 1.0);
+
+   const std::vector<const SMT::Matrix<double>*> oneMatrix = { matrix1.get() };
+   const auto copyResult = SMT::MultiplyChain(oneMatrix);
+   ASSERT_TRUE(copyResult.Matrix_ != nullptr);
+   CheckEquality<double>(*copyResult.Matrix_, *matrix1, true, 1.0);
+
+   EXPECT_EQ(SMT::MultiplyChain(std::vector<const SMT::Matrix<double>*>()).Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ(SMT::MultiplyChain(*matrix1, *matrix2, *matrix4).Code_, SMT::OperationResultCode::Error);
+}
+
+TEST_F(OperationsTest, OperationsIntoExistingMatrix)
+{
+   CheckOperationsInto([](size_t rowCount, size_t columnCount) { return std::unique_ptr<SMT::Matrix<double>>(new SMT::StandardMatrix<double>(rowCount, columnCount)); });
+   CheckOperationsInto([](size_t rowCount, size_t columnCount) { return std::unique_ptr<SMT::Matrix<double>>(new SMT::BlockMatrix<double>(rowCount, columnCount, 8)); });
+
+   // The result is written into the same storage
+   auto func = [](size_t row, size_t column)->double { return static_cast<double>(row * 3 + column); };
+   const SMT::StandardMatrix<double> matrix(16, 16, func);
+   SMT::StandardMatrix<double> result(16, 16);
+   const double* data = result.Data();
+   for (size_t iteration = 0; iteration < 3; ++iteration)
+   {
+      EXPECT_EQ(SMT::MultiplyInto<double>(result, matrix, matrix, 1.0, 1.0).Code_, SMT::OperationResultCode::Ok);
+   }
+   EXPECT_EQ(result.Data(), data);
+   const auto product = SMT::Multiply(matrix, matrix);
+   CheckForEachElement<double>(result, [&product](size_t row, size_t column) { return 3.0 * product.Matrix_->Element(row, column); }, true, 1.0);
+
+   // Matrices which compute their elements can't hold results
+   SMT::FunctionMatrix<double> functionMatrix(16, 16, func);
+   EXPECT_EQ(SMT::AddInPlace<double>(functionMatrix, matrix).Code_, SMT::OperationResultCode::NotImplemented);
+}
@@ -0,0 +1,114 @@
+#include "../stdafx.h"
+
+#include <cstdio>
+
+#include "MatrixTest.h"
+
+#include "../../SMT/Matrix/FunctionMatrix.h"
+#include "../../SMT/Matrix/MatrixPlanner.h"
+
+class PlannerTest : public MatrixTest
+{
+protected:
+   virtual void SetUp() override
+   {
+      // Fixed constants, so the choices don't depend on the machine
+      savedConstants_ = SMT::Planner::Constants();
+      SMT::Planner::MachineConstants constants;
+      constants.SecondsPerFlop_ = 1.0e-10;
+      constants.SecondsPerByte_ = 1.0e-10;
+      constants.SecondsPerCall_ = 2.0e-9;
+      SMT::Planner::SetConstants(constants);
+   }
+   virtual void TearDown() override
+   {
+      SMT::Planner::SetConstants(savedConstants_);
+   }
+
+   SMT::Planner::MachineConstants savedConstants_;
+};
+
+TEST_F(PlannerTest, SaveAndLoadCalibration)
+{
+   const SMT::Planner::MachineConstants calibrated = SMT::Planner::Calibrate();
+   EXPECT_GT(calibrated.SecondsPerFlop_, 0.0);
+   EXPECT_GT(calibrated.SecondsPerByte_, 0.0);
+   EXPECT_GT(calibrated.SecondsPerCall_, 0.0);
+
+   const std::string file = "smt_calibration_test.txt";
+   ASSERT_TRUE(SMT::Planner::Save(calibrated, file));
+   SMT::Planner::MachineConstants loaded;
+   ASSERT_TRUE(SMT::Planner::Load(file, loaded));
+   EXPECT_DOUBLE_EQ(loaded.SecondsPerFlop_, calibrated.SecondsPerFlop_);
+   EXPECT_DOUBLE_EQ(loaded.SecondsPerByte_, calibrated.SecondsPerByte_);
+   EXPECT_DOUBLE_EQ(loaded.SecondsPerCall_, calibrated.SecondsPerCall_);
+   std::remove(file.c_str());
+
+   EXPECT_FALSE(SMT::Planner::Load(file, loaded));
+}
+
+TEST_F(PlannerTest, PlansDependOnMatrixTypes)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row * 3 + column); };
+   const size_t size = 64;
+   SMT::StandardMatrix<double> standardMatrix(size, size, initFunc);
+   SMT::FunctionMatrix<double> functionMatrix(size, size, initFunc);
+
+   // Two standard matrices: the GEMM kernel of the standard matrix itself
+   auto plans = SMT::Planner::MultiplicationPlans<double>(standardMatrix, standardMatrix);
+   ASSERT_FALSE(plans.empty());
+   EXPECT_EQ(plans.front().Strategy_, SMT::Planner::Strategy::NativeFirst);
+   EXPECT_EQ(plans.back().Strategy_, SMT::Planner::Strategy::ConvertThenKernel);
+
+   // Two function matrices are added together lazily
+   plans = SMT::Planner::AdditionPlans<double>(functionMatrix, functionMatrix);
+   ASSERT_FALSE(plans.empty());
+   EXPECT_NE(plans.front().Strategy_, SMT::Planner::Strategy::ConvertThenKernel);
+   EXPECT_NE(plans.front().Description_.find("lazy"), std::string::npos);
+
+   // Function matrices can't be multiplied natively
+   plans = SMT::Planner::MultiplicationPlans<double>(functionMatrix, functionMatrix);
+   ASSERT_EQ(plans.size(), 1u);
+   EXPECT_EQ(plans.front().Strategy_, SMT::Planner::Strategy::ConvertThenKernel);
+
+   auto result = SMT::Multiply<double>(functionMatrix, functionMatrix);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Warning);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   auto productFunc = [initFunc, size](size_t row, size_t column) -> double
+   {
+      double result = 0.0;
+      for (size_t i = 0; i < size; ++i)
+      {
+         result += initFunc(row, i) * initFunc(i, column);
+      }
+      return result;
+   };
+   CheckForEachElement<double>(*result.Matrix_, productFunc, true, SMT::MatrixSettings::One<double>());
+
+   // A function matrix and a standard matrix: the standard matrix reads the function matrix by tiles
+   result = SMT::Multiply<double>(functionMatrix, standardMatrix);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   CheckForEachElement<double>(*result.Matrix_, productFunc, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(PlannerTest, PlanningDoesNotReadMatrices)
+{
+   size_t callCount = 0;
+   SMT::FunctionMatrix<double> functionMatrix(64, 64, [&callCount](size_t row, size_t column)->double { ++callCount; return static_cast<double>(row + column); });
+   SMT::StandardMatrix<double> standardMatrix(64, 64, [](size_t row, size_t column)->double { return static_cast<double>(row * column); });
+
+   // Plans depend only on the constants and the cost hints of the types, so they are the same every time
+   const auto plans = SMT::Planner::MultiplicationPlans<double>(functionMatrix, standardMatrix);
+   const auto otherPlans = SMT::Planner::MultiplicationPlans<double>(functionMatrix, standardMatrix);
+   SMT::Planner::AdditionPlans<double>(functionMatrix, standardMatrix);
+   EXPECT_EQ(callCount, 0u);
+   ASSERT_EQ(plans.size(), otherPlans.size());
+   for (size_t i = 0; i < plans.size(); ++i)
+   {
+      EXPECT_EQ(plans[i].Strategy_, otherPlans[i].Strategy_);
+      EXPECT_EQ(plans[i].Seconds_, otherPlans[i].Seconds_);
+   }
+   EXPECT_EQ(functionMatrix.CallsPerElement(), 1.0);
+   EXPECT_EQ(standardMatrix.CallsPerElement(), 0.0);
+}
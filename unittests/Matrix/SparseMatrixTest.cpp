@@ -0,0 +1,248 @@
+#include "../stdafx.h"
+
+#include "MatrixTest.h"
+#include "../../SMT/Matrix/SparseMatrix.h"
+
+class SparseMatrixTest : public MatrixTest
+{
+protected:
+   // About every fifth element is nonzero
+   static double SparseElement(size_t row, size_t column)
+   {
+      return ((row * 7 + column * 3) % 5 == 0) ? static_cast<double>(row + 2 * column + 1) : 0.0;
+   }
+
+   static std::shared_ptr<SMT::SparseMatrix<double>> CreateSparseMatrix(size_t rowCount, size_t columnCount, const std::function<double(size_t /*row*/, size_t /*column*/)>& func)
+   {
+      const SMT::StandardMatrix<double> standardMatrix(rowCount, columnCount, func);
+      auto result = std::make_shared<SMT::SparseMatrix<double>>(standardMatrix);
+
+      EXPECT_EQ(rowCount, result->RowCount());
+      EXPECT_EQ(columnCount, result->ColumnCount());
+
+      return result;
+   }
+};
+
+TEST_F(SparseMatrixTest, Construction)
+{
+   // Elements of the same position are added together
+   const std::vector<SMT::SparseMatrix<double>::Triplet> triplets = { { 2, 3, 1.0 }, { 0, 1, 2.0 }, { 2, 0, 3.0 }, { 2, 3, 4.0 }, { 3, 4, 5.0 } };
+   SMT::SparseMatrix<double> matrix(4, 5, triplets);
+   EXPECT_EQ(matrix.NonZeroCount(), 4u);
+   auto elementFunc = [](size_t row, size_t column)->double
+   {
+      return (row == 0 && column == 1) ? 2.0 : (row == 2 && column == 0) ? 3.0 : (row == 2 && column == 3) ? 5.0 : (row == 3 && column == 4) ? 5.0 : 0.0;
+   };
+   CheckForEachElement<double>(matrix, elementFunc, true, SMT::MatrixSettings::One<double>());
+   for (size_t row = 0; row < matrix.RowCount(); ++row)
+   {
+      for (size_t column = 0; column < matrix.ColumnCount(); ++column)
+      {
+         EXPECT_EQ(matrix.Element(row, column), elementFunc(row, column));
+      }
+   }
+   const std::vector<size_t> rowOffsets = { 0, 1, 1, 3, 4 };
+   EXPECT_TRUE(std::equal(rowOffsets.begin(), rowOffsets.end(), matrix.RowOffsets()));
+   EXPECT_EQ(matrix.ColumnIndices()[1], 0u);
+   EXPECT_EQ(matrix.ColumnIndices()[2], 3u);
+
+   // Adopted arrays are used as they are
+   std::vector<size_t> offsets(rowOffsets);
+   std::vector<size_t> columnIndices = { 1, 0, 3, 4 };
+   std::vector<double> values = { 2.0, 3.0, 5.0, 5.0 };
+   const double* valuesData = values.data();
+   SMT::SparseMatrix<double> adoptedMatrix(4, 5, std::move(offsets), std::move(columnIndices), std::move(values));
+   EXPECT_EQ(adoptedMatrix.Values(), valuesData);
+   CheckEquality(matrix, adoptedMatrix, true, SMT::MatrixSettings::One<double>());
+
+   SMT::SparseMatrix<double> zeroMatrix(3, 2);
+   EXPECT_EQ(zeroMatrix.NonZeroCount(), 0u);
+   EXPECT_TRUE(SMT::CheckIfZeroMatrix(zeroMatrix));
+}
+
+TEST_F(SparseMatrixTest, DenseConversion)
+{
+   auto matrix = CreateSparseMatrix(37, 23, SparseElement);
+   CheckForEachElement<double>(*matrix, SparseElement, true, SMT::MatrixSettings::One<double>());
+   EXPECT_LT(matrix->NonZeroCount(), 37u * 23u / 4);
+   EXPECT_TRUE(matrix->RowData(0) == nullptr);
+
+   // The tile starts and ends between nonzeros
+   const size_t tileRow = 5;
+   const size_t tileColumn = 3;
+   const size_t tileRowCount = 11;
+   const size_t tileColumnCount = 13;
+   std::vector<double> tile(tileRowCount * tileColumnCount, -1.0);
+   matrix->CopyTile(tileRow, tileColumn, tileRowCount, tileColumnCount, tile.data(), tileColumnCount);
+   for (size_t row = 0; row < tileRowCount; ++row)
+   {
+      for (size_t column = 0; column < tileColumnCount; ++column)
+      {
+         EXPECT_EQ(tile[row * tileColumnCount + column], SparseElement(tileRow + row, tileColumn + column));
+      }
+   }
+
+   // Copies share the storage
+   EXPECT_EQ(matrix->CopyingComplexity(), SMT::Complexity::Constant);
+   auto copyResult = matrix->Copy();
+   EXPECT_EQ(copyResult.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(copyResult.Matrix_ != nullptr);
+   EXPECT_EQ(static_cast<const SMT::SparseMatrix<double>&>(*copyResult.Matrix_).Values(), matrix->Values());
+   CheckEquality(*matrix, *copyResult.Matrix_, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(SparseMatrixTest, Addition)
+{
+   auto otherElement = [](size_t row, size_t column)->double { return (row == column) ? -static_cast<double>(row + 1) : 0.0; };
+   auto matrix1 = CreateSparseMatrix(40, 30, SparseElement);
+   auto matrix2 = CreateSparseMatrix(40, 30, otherElement);
+   auto sumFunc = [&](size_t row, size_t column)->double { return SparseElement(row, column) + otherElement(row, column); };
+
+   // The sum of sparse matrices stays sparse
+   auto result = SMT::Add<double>(*matrix1, *matrix2);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   EXPECT_EQ(result.Matrix_->TypeName(), "SparseMatrix");
+   CheckForEachElement<double>(*result.Matrix_, sumFunc, true, SMT::MatrixSettings::One<double>());
+
+   // The sum with a standard matrix is standard, the sparse matrix does it
+   const SMT::StandardMatrix<double> standardMatrix(40, 30, otherElement);
+   result = SMT::Add<double>(standardMatrix, *matrix1);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   EXPECT_EQ(result.Matrix_->TypeName(), "StandardMatrix");
+   CheckForEachElement<double>(*result.Matrix_, sumFunc, true, SMT::MatrixSettings::One<double>());
+
+   result = matrix1->MultiplyByNumber(-2.0);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   CheckForEachElement<double>(*result.Matrix_, [](size_t row, size_t column) { return -2.0 * SparseElement(row, column); }, true, SMT::MatrixSettings::One<double>());
+
+   auto wrongMatrix = CreateSparseMatrix(30, 40, SparseElement);
+   EXPECT_EQ(matrix1->Add(*wrongMatrix).Code_, SMT::OperationResultCode::Error);
+}
+
+TEST_F(SparseMatrixTest, Multiplication)
+{
+   auto rightElement = [](size_t row, size_t column)->double { return ((row + column) % 4 == 0) ? 0.5 * static_cast<double>(row) - static_cast<double>(column) : 0.0; };
+   auto denseElement = [](size_t row, size_t column)->double { return std::sin(static_cast<double>(row * 31 + column)); };
+   auto leftMatrix = CreateSparseMatrix(45, 35, SparseElement);
+   auto rightMatrix = CreateSparseMatrix(35, 50, rightElement);
+   const SMT::StandardMatrix<double> standardLeftMatrix(*leftMatrix);
+   const SMT::StandardMatrix<double> standardRightMatrix(*rightMatrix);
+   const SMT::StandardMatrix<double> denseRightMatrix(35, 20, denseElement);
+   const SMT::StandardMatrix<double> denseLeftMatrix(15, 45, denseElement);
+   const SMT::StandardMatrix<double> vector(35, 1, denseElement);
+
+   // Elements of the products are up to about 1e5, so the tolerance is absolute 2e-8
+   auto checkProduct = [&](const SMT::Matrix<double>& left, const SMT::Matrix<double>& right, const SMT::Matrix<double>& standardLeft, const SMT::Matrix<double>& standardRight, const std::string& typeName)
+   {
+      auto result = SMT::Multiply<double>(left, right);
+      EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+      ASSERT_TRUE(result.Matrix_ != nullptr);
+      EXPECT_EQ(result.Matrix_->TypeName(), typeName);
+      auto expected = SMT::StandardMatrix<double>::Multiply(standardLeft, standardRight);
+      ASSERT_TRUE(expected.Matrix_ != nullptr);
+      const SMT::StandardMatrix<double> product(*result.Matrix_);
+      CheckForEachElement<double>(product, [&](size_t row, size_t column) { return expected.Matrix_->Element(row, column); }, false, 1.0e8);
+   };
+   checkProduct(*leftMatrix, *rightMatrix, standardLeftMatrix, standardRightMatrix, "SparseMatrix");
+   checkProduct(*leftMatrix, denseRightMatrix, standardLeftMatrix, denseRightMatrix, "StandardMatrix");
+   checkProduct(denseLeftMatrix, *leftMatrix, denseLeftMatrix, standardLeftMatrix, "StandardMatrix");
+   checkProduct(*leftMatrix, vector, standardLeftMatrix, vector, "StandardMatrix");
+
+   // Rows are distributed between threads: the result is the same
+   const size_t multiplyThreshold = SMT::ParallelSettings::MultiplyThreshold();
+   SMT::ParallelSettings::SetThreadCount(1);
+   auto serialResult = leftMatrix->Multiply(*rightMatrix, false);
+   SMT::ParallelSettings::SetThreadCount(4);
+   SMT::ParallelSettings::SetMultiplyThreshold(0);
+   auto parallelResult = leftMatrix->Multiply(*rightMatrix, false);
+   auto parallelDenseResult = leftMatrix->Multiply(denseLeftMatrix, true);
+   auto parallelSum = leftMatrix->Add(*leftMatrix);
+   SMT::ParallelSettings::SetThreadCount(0);
+   SMT::ParallelSettings::SetMultiplyThreshold(multiplyThreshold);
+   ASSERT_TRUE(serialResult.Matrix_ != nullptr);
+   ASSERT_TRUE(parallelResult.Matrix_ != nullptr);
+   ASSERT_TRUE(parallelDenseResult.Matrix_ != nullptr);
+   ASSERT_TRUE(parallelSum.Matrix_ != nullptr);
+   CheckEquality(*serialResult.Matrix_, *parallelResult.Matrix_, true, SMT::MatrixSettings::One<double>());
+   CheckEquality(*leftMatrix->Multiply(denseLeftMatrix, true).Matrix_, *parallelDenseResult.Matrix_, true, SMT::MatrixSettings::One<double>());
+   CheckForEachElement<double>(*parallelSum.Matrix_, [](size_t row, size_t column) { return 2.0 * SparseElement(row, column); }, true, SMT::MatrixSettings::One<double>());
+
+   EXPECT_EQ(leftMatrix->Multiply(*leftMatrix, false).Code_, SMT::OperationResultCode::Error);
+}
+
+TEST_F(SparseMatrixTest, ParallelMultiplicationByVectorWithLeadingEmptyRows)
+{
+   // Rows 0-9 are empty, so their offsets equal the offset of the first nonempty row
+   const size_t size = 1000;
+   std::vector<SMT::SparseMatrix<double>::Triplet> triplets;
+   for (size_t row = 10; row < size; ++row)
+   {
+      for (size_t column = row % 7; column < size; column += 7)
+      {
+         triplets.push_back({ row, column, static_cast<double>(row + column) });
+      }
+   }
+   const SMT::SparseMatrix<double> matrix(size, size, triplets);
+   std::vector<double> vector(size);
+   for (size_t i = 0; i < size; ++i)
+   {
+      vector[i] = static_cast<double>(i % 13) - 6.0;
+   }
+   std::vector<double> serialResult(size, -777.0);
+   SMT::ParallelSettings::SetThreadCount(1);
+   matrix.MultiplyVector(vector.data(), serialResult.data());
+
+   // Every element of the result is written even if the buffer isn't zeroed
+   const size_t multiplyThreshold = SMT::ParallelSettings::MultiplyThreshold();
+   SMT::ParallelSettings::SetThreadCount(4);
+   SMT::ParallelSettings::SetMultiplyThreshold(matrix.NonZeroCount() / 2);
+   std::vector<double> parallelResult(size, -777.0);
+   matrix.MultiplyVector(vector.data(), parallelResult.data());
+   SMT::ParallelSettings::SetThreadCount(0);
+   SMT::ParallelSettings::SetMultiplyThreshold(multiplyThreshold);
+
+   for (size_t row = 0; row < 10; ++row)
+   {
+      EXPECT_EQ(serialResult[row], 0.0);
+   }
+   EXPECT_EQ(parallelResult, serialResult);
+}
+
+TEST_F(SparseMatrixTest, Transposition)
+{
+   auto matrix = CreateSparseMatrix(27, 41, SparseElement);
+   auto result = SMT::Transpose<double>(*matrix);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(result.Matrix_ != nullptr);
+   EXPECT_EQ(result.Matrix_->TypeName(), "SparseMatrix");
+   EXPECT_EQ(result.Matrix_->RowCount(), 41u);
+   EXPECT_EQ(result.Matrix_->ColumnCount(), 27u);
+   CheckForEachElement<double>(*result.Matrix_, [](size_t row, size_t column) { return SparseElement(column, row); }, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(SparseMatrixTest, Planning)
+{
+   // Sparse operands are handled by the sparse matrix instead of being converted into standard ones
+   auto sparseMatrix = CreateSparseMatrix(200, 200, [](size_t row, size_t column) { return (row == column || row + 1 == column) ? 1.0 : 0.0; });
+   const SMT::StandardMatrix<double> standardMatrix(200, 200, [](size_t row, size_t column) { return static_cast<double>(row + column); });
+   EXPECT_EQ(sparseMatrix->AdditionComplexity(*sparseMatrix), SMT::Complexity::Linear);
+   EXPECT_EQ(sparseMatrix->MultiplyComplexity(*sparseMatrix, false), SMT::Complexity::Linear);
+   EXPECT_EQ(sparseMatrix->MultiplyComplexity(standardMatrix, true), SMT::Complexity::Quadratic);
+   EXPECT_EQ(SMT::Planner::AdditionPlans<double>(*sparseMatrix, *sparseMatrix).front().Strategy_, SMT::Planner::Strategy::NativeFirst);
+   EXPECT_EQ(SMT::Planner::MultiplicationPlans<double>(*sparseMatrix, *sparseMatrix).front().Strategy_, SMT::Planner::Strategy::NativeFirst);
+   EXPECT_EQ(SMT::Planner::MultiplicationPlans<double>(*sparseMatrix, standardMatrix).front().Strategy_, SMT::Planner::Strategy::NativeFirst);
+   EXPECT_EQ(SMT::Planner::MultiplicationPlans<double>(standardMatrix, *sparseMatrix).front().Strategy_, SMT::Planner::Strategy::NativeSecond);
+
+   // Sparse operands are priced by their nonzeros: 399 of 40000 elements
+   EXPECT_LT(SMT::Planner::ReadSeconds<double>(*sparseMatrix), SMT::Planner::ReadSeconds<double>(standardMatrix) / 10.0);
+   EXPECT_LT(SMT::Planner::AdditionPlans<double>(*sparseMatrix, *sparseMatrix).front().Seconds_, SMT::Planner::AdditionPlans<double>(standardMatrix, standardMatrix).front().Seconds_ / 10.0);
+   EXPECT_LT(SMT::Planner::MultiplicationPlans<double>(*sparseMatrix, *sparseMatrix).front().Seconds_, SMT::Planner::MultiplicationPlans<double>(standardMatrix, standardMatrix).front().Seconds_ / 10.0);
+
+   // A filled matrix is reported like a standard one
+   auto filledMatrix = CreateSparseMatrix(20, 20, [](size_t row, size_t column) { return static_cast<double>(row + column + 1); });
+   EXPECT_EQ(filledMatrix->MultiplyComplexity(*filledMatrix, false), SMT::Complexity::Cubic);
+}
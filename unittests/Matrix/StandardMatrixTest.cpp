@@ -1,6 +1,8 @@
 #include "../stdafx.h"
 
 #include "MatrixTest.h"
+#include "../../SMT/Matrix/MatrixExpression.h"
+#include "../../SMT/Matrix/MatrixSimd.h"
 
 class StandardMatrixTest : public MatrixTest
 {
@@ -140,6 +142,61 @@ TEST_F(StandardMatrixTest, Multiplication)
    CheckForEachElement<double>(*resultMatrix, resultFunc, false, SMT::MatrixSettings::One<double>());
 }
 
+TEST_F(StandardMatrixTest, MultiplicationOfLargeMatrices)
+{
+   // Sizes are not multiples of the GEMM blocking parameters, so ragged register tiles and blocks are checked too
+   auto initFunc1 = [](size_t row, size_t column)->double { return static_cast<double>((row * 7 + column * 3) % 11) - 5.0; };
+   auto initFunc2 = [](size_t row, size_t column)->double { return static_cast<double>((row * 5 + column * 2) % 13) - 6.0; };
+   const size_t rowCount = 137;
+   const size_t innerCount = 263;
+   const size_t columnCount = 91;
+   auto matrix1 = CreateStandardMatrix(rowCount, innerCount, initFunc1);
+   auto matrix2 = CreateStandardMatrix(innerCount, columnCount, initFunc2);
+
+   auto result = matrix1->Multiply(*matrix2, false);
+   EXPECT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+   auto resultMatrix = result.Matrix_;
+
+   ASSERT_TRUE(resultMatrix != nullptr);
+   EXPECT_EQ(resultMatrix->RowCount(), rowCount);
+   EXPECT_EQ(resultMatrix->ColumnCount(), columnCount);
+
+   auto resultFunc = [initFunc1, initFunc2, innerCount](size_t row, size_t column) -> double
+   {
+      double result = 0.0;
+      for (size_t i = 0; i < innerCount; ++i)
+      {
+         result += initFunc1(row, i) * initFunc2(i, column);
+      }
+      return result;
+   };
+   CheckForEachElement<double>(*resultMatrix, resultFunc, true, SMT::MatrixSettings::One<double>());
+}
+
+TEST_F(StandardMatrixTest, MultithreadedMultiplication)
+{
+   // The result consists of several tiles of the parallel GEMM; it must be bit-identical to the serial one
+   auto initFunc1 = [](size_t row, size_t column)->double { return 1.0 / (1.0 + static_cast<double>(row) + 0.5 * static_cast<double>(column)); };
+   auto initFunc2 = [](size_t row, size_t column)->double { return std::sin(static_cast<double>(row * 31 + column)); };
+   auto matrix1 = CreateStandardMatrix(300, 260, initFunc1);
+   auto matrix2 = CreateStandardMatrix(260, 530, initFunc2);
+   const size_t multiplyThreshold = SMT::ParallelSettings::MultiplyThreshold();
+
+   SMT::ParallelSettings::SetThreadCount(1);
+   auto serialResult = matrix1->Multiply(*matrix2, false);
+   SMT::ParallelSettings::SetThreadCount(4);
+   SMT::ParallelSettings::SetMultiplyThreshold(0);
+   auto parallelResult = matrix1->Multiply(*matrix2, false);
+   SMT::ParallelSettings::SetThreadCount(0);
+   SMT::ParallelSettings::SetMultiplyThreshold(multiplyThreshold);
+
+   EXPECT_EQ(serialResult.Code_, SMT::OperationResultCode::Ok);
+   EXPECT_EQ(parallelResult.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(serialResult.Matrix_ != nullptr);
+   ASSERT_TRUE(parallelResult.Matrix_ != nullptr);
+   CheckEquality(*serialResult.Matrix_, *parallelResult.Matrix_, true, SMT::MatrixSettings::One<double>());
+}
+
 TEST_F(StandardMatrixTest, Inversion1)
 {
    //     |  3  -2   4  |                 |   1   -2    2  |
@@ -168,7 +225,7 @@ TEST_F(StandardMatrixTest, Inversion1)
       if (row == 2 && column == 0) return -0.5; if (row == 2 && column == 1) return  1.5; if (row == 2 && column == 2) return -1.0;
       return 100000.0;
    };
-   CheckForEachElement<double>(*resultMatrix, resultFunc, false, SMT::MatrixSettings::One<double>());
+   CheckForEachElement<double>(*resultMatrix, resultFunc, false, 10.0);
 }
 
 TEST_F(StandardMatrixTest, Inversion2)
@@ -201,7 +258,7 @@ TEST_F(StandardMatrixTest, Inversion2)
    ASSERT_TRUE(identityMatrix1 != nullptr);
    EXPECT_EQ(identityMatrix1->ColumnCount(), 10);
    EXPECT_EQ(identityMatrix1->RowCount(), 10);
-   CheckForEachElement<double>(*identityMatrix1, identityFunc, false, SMT::MatrixSettings::One<double>());
+   CheckForEachElement<double>(*identityMatrix1, identityFunc, false, 10.0);
 
    auto identityMatrixResult2 = resultMatrix->Multiply(*matrix, true);
    EXPECT_EQ(identityMatrixResult2.Code_, SMT::OperationResultCode::Ok);
@@ -209,7 +266,63 @@ TEST_F(StandardMatrixTest, Inversion2)
    ASSERT_TRUE(identityMatrix2 != nullptr);
    EXPECT_EQ(identityMatrix2->ColumnCount(), 10);
    EXPECT_EQ(identityMatrix2->RowCount(), 10);
-   CheckForEachElement<double>(*identityMatrix2, identityFunc, false, SMT::MatrixSettings::One<double>());
+   CheckForEachElement<double>(*identityMatrix2, identityFunc, false, 10.0);
+}
+
+TEST_F(StandardMatrixTest, LUDecomposition)
+{
+   // One factorization is reused for the determinant, the inverse and a linear solve.
+   // The size isn't a multiple of the block size, so the blocked panels, the trailing update and the blocked solves are used.
+   auto initFunc = [](size_t row, size_t column)->double
+   {
+      return (row == column) ? 10.0 : 1.0 / (1.0 + static_cast<double>(row) + 2.0 * static_cast<double>(column));
+   };
+   const size_t size = 150;
+   SMT::StandardMatrix<double> matrix(size, size, initFunc);
+   const auto decomposition = matrix.FactorizeLU();
+   EXPECT_EQ(decomposition.Code(), SMT::OperationResultCode::Ok);
+   ASSERT_FALSE(decomposition.IsSingular());
+
+   auto determinant = matrix.Determinant();
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   CheckEquality<double>(*determinant.Value_, decomposition.Determinant(), true, 1.0);
+
+   // A * x = b where x(i) = i
+   std::vector<double> b(size, 0.0);
+   for (size_t row = 0; row < size; ++row)
+   {
+      for (size_t column = 0; column < size; ++column)
+      {
+         b[row] += initFunc(row, column) * static_cast<double>(column);
+      }
+   }
+   ASSERT_TRUE(decomposition.Solve(b.data(), 1, 1));
+   for (size_t row = 0; row < size; ++row)
+   {
+      CheckEquality<double>(b[row], static_cast<double>(row), false, 100.0 * static_cast<double>(size));
+   }
+
+   auto inverseResult = matrix.Invert();
+   EXPECT_EQ(inverseResult.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(inverseResult.Matrix_ != nullptr);
+   auto identityResult = matrix.Multiply(*inverseResult.Matrix_, false);
+   ASSERT_TRUE(identityResult.Matrix_ != nullptr);
+   CheckForEachElement<double>(*identityResult.Matrix_, SMT::MatrixSettings::IdentityMatrixFunction<double>(), false, 100.0);
+}
+
+TEST_F(StandardMatrixTest, SingularMatrix)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row + 1) * static_cast<double>(column + 1); };
+   auto matrix = CreateStandardMatrix(4, 4, initFunc);
+
+   auto inverseResult = matrix->Invert();
+   EXPECT_EQ(inverseResult.Code_, SMT::OperationResultCode::Error);
+   EXPECT_TRUE(inverseResult.Matrix_ == nullptr);
+
+   auto determinant = matrix->Determinant();
+   EXPECT_EQ(determinant.Code_, SMT::OperationResultCode::Ok);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   CheckEquality<double>(*determinant.Value_, 0.0, true, 1.0);
 }
 
 TEST_F(StandardMatrixTest, Transposition)
@@ -248,7 +361,8 @@ TEST_F(StandardMatrixTest, Determination1)
    auto value = result.Value_;
 
    ASSERT_TRUE(value != nullptr);
-   CheckEquality<double>(*value, 1.0, false, 1.0);
+   // The product of 50 pivots after row exchanges is off by about 15 epsilons
+   CheckEquality<double>(*value, 1.0, false, 20.0);
 }
 
 TEST_F(StandardMatrixTest, Determination2)
@@ -276,7 +390,8 @@ TEST_F(StandardMatrixTest, Determination2)
    auto value = result.Value_;
 
    ASSERT_TRUE(value != nullptr);
-   CheckEquality<double>(*value, -34.0, false, 1.0);
+   // Partial pivoting reorders the rows, so the product of the pivots is off by about 96 epsilons
+   CheckEquality<double>(*value, -34.0, false, 200.0);
 }
 
 TEST_F(StandardMatrixTest, InversionAndDetermination)
@@ -324,4 +439,253 @@ TEST_F(StandardMatrixTest, InversionAndDetermination)
    CheckEquality<double>(*resultDeterminent.Value_, (*matrixDeterminant.Value_) * (*invertedMatrixDeterminant.Value_), false, 100.0);
    CheckEquality<double>(1.0, (*matrixDeterminant.Value_) * (*invertedMatrixDeterminant.Value_), false, 10.0);
    CheckEquality<double>(*resultDeterminent.Value_, 1.0, false, 10.0);
-}
\ No newline at end of file
+}
+
+TEST_F(StandardMatrixTest, ElementaryOperationsForEveryInstructionSet)
+{
+   // The number of columns isn't a multiple of any vector width, so the scalar tails are checked too
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row + 1) * 0.37 + static_cast<double>(column) * 1.13; };
+   const size_t columnCount = 37;
+   const size_t rowCount = 3;
+   const double number1 = 1.3;
+   const double number2 = -0.7;
+   // Expected result: Row#0 = (Row#0 - Row#2 * number1) * number2, then Row#0 <-> Row#1
+   auto resultFunc = [initFunc, number1, number2](size_t row, size_t column) -> double
+   {
+      if (row == 1)
+      {
+         return (initFunc(0, column) - initFunc(2, column) * number1) * number2;
+      }
+      return (row == 0) ? initFunc(1, column) : initFunc(row, column);
+   };
+
+   const SMT::Simd::InstructionSet detectedInstructionSet = SMT::Simd::DetectInstructionSet();
+   for (int instructionSet = static_cast<int>(SMT::Simd::InstructionSet::Generic); instructionSet <= static_cast<int>(detectedInstructionSet); ++instructionSet)
+   {
+      ASSERT_TRUE(SMT::Simd::SetInstructionSet(static_cast<SMT::Simd::InstructionSet>(instructionSet)));
+      SMT::StandardMatrix<double> matrix(rowCount, columnCount, initFunc);
+      auto elementaryOperations = matrix.ElementaryOperations();
+      ASSERT_TRUE(elementaryOperations != nullptr);
+      EXPECT_TRUE(elementaryOperations->MultiplyAndSubtract(0, 2, number1));
+      EXPECT_TRUE(elementaryOperations->MultiplyRowByNumber(0, number2));
+      EXPECT_TRUE(elementaryOperations->SwapRows(0, 1));
+      CheckForEachElement<double>(matrix, resultFunc, false, 10.0);
+   }
+   SMT::Simd::SetInstructionSet(detectedInstructionSet);
+}
+
+TEST_F(StandardMatrixTest, TranspositionForEveryInstructionSet)
+{
+   // Sizes aren't multiples of the micro-kernel sizes and exceed the tile, so the recursion and the edges are checked too
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row) * 1000.0 + static_cast<double>(column); };
+   auto floatInitFunc = [initFunc](size_t row, size_t column)->float { return static_cast<float>(initFunc(row, column)); };
+   const size_t rowCount = 83;
+   const size_t columnCount = 67;
+
+   const SMT::Simd::InstructionSet detectedInstructionSet = SMT::Simd::DetectInstructionSet();
+   for (int instructionSet = static_cast<int>(SMT::Simd::InstructionSet::Generic); instructionSet <= static_cast<int>(detectedInstructionSet); ++instructionSet)
+   {
+      ASSERT_TRUE(SMT::Simd::SetInstructionSet(static_cast<SMT::Simd::InstructionSet>(instructionSet)));
+      SMT::StandardMatrix<double> matrix(rowCount, columnCount, initFunc);
+      auto result = matrix.Transpose();
+      ASSERT_EQ(result.Code_, SMT::OperationResultCode::Ok);
+      ASSERT_EQ(result.Matrix_->RowCount(), columnCount);
+      CheckForEachElement<double>(*result.Matrix_, [initFunc](size_t row, size_t column) { return initFunc(column, row); }, true, 1.0);
+
+      SMT::StandardMatrix<float> floatMatrix(rowCount, columnCount, floatInitFunc);
+      auto floatResult = floatMatrix.Transpose();
+      ASSERT_EQ(floatResult.Code_, SMT::OperationResultCode::Ok);
+      CheckForEachElement<float>(*floatResult.Matrix_, [floatInitFunc](size_t row, size_t column) { return floatInitFunc(column, row); }, true, 1.0f);
+   }
+   SMT::Simd::SetInstructionSet(detectedInstructionSet);
+}
+
+TEST_F(StandardMatrixTest, InPlaceTransposition)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row) * 1000.0 + static_cast<double>(column); };
+   auto resultFunc = [initFunc](size_t row, size_t column) -> double { return initFunc(column, row); };
+
+   // Square: diagonal blocks are transposed, off-diagonal blocks are exchanged
+   SMT::StandardMatrix<double> square(70, 70, initFunc);
+   square.TransposeInPlace();
+   CheckForEachElement<double>(square, resultFunc, true, 1.0);
+
+   // Non-square: permutation cycles
+   SMT::StandardMatrix<double> rectangular(37, 53, initFunc);
+   rectangular.TransposeInPlace();
+   EXPECT_EQ(rectangular.RowCount(), 53u);
+   EXPECT_EQ(rectangular.ColumnCount(), 37u);
+   CheckForEachElement<double>(rectangular, resultFunc, true, 1.0);
+
+   // Twice gives the original matrix
+   rectangular.TransposeInPlace();
+   EXPECT_EQ(rectangular.RowCount(), 37u);
+   CheckForEachElement<double>(rectangular, initFunc, true, 1.0);
+}
+
+TEST_F(StandardMatrixTest, AlignedStorage)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row * 10 + column); };
+   for (size_t columnCount = 1; columnCount < 10; ++columnCount)
+   {
+      SMT::StandardMatrix<double> matrix(3, columnCount, initFunc);
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(matrix.Data()) % SMT::MemoryResource::CacheLineAlignment, 0u);
+
+      // The copy owns its (aligned) elements
+      SMT::StandardMatrix<double> copy(matrix);
+      EXPECT_NE(copy.Data(), matrix.Data());
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(copy.Data()) % SMT::MemoryResource::CacheLineAlignment, 0u);
+      CheckForEachElement<double>(copy, initFunc, true, 1.0);
+   }
+
+   // A matrix over external data shares it with copies
+   std::vector<double> data(6, 2.0);
+   SMT::StandardMatrix<double> external(2, 3, data[0]);
+   SMT::StandardMatrix<double> externalCopy(external);
+   EXPECT_EQ(externalCopy.Data(), data.data());
+}
+
+TEST_F(StandardMatrixTest, PooledStorage)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row) - static_cast<double>(column); };
+   SMT::AlignedMemoryResource heap;
+   SMT::PoolMemoryResource pool(heap);
+   EXPECT_EQ(SMT::PoolMemoryResource::ClassBytes(1), 256u);
+   EXPECT_EQ(SMT::PoolMemoryResource::ClassBytes(1024), 1024u);
+   EXPECT_EQ(SMT::PoolMemoryResource::ClassBytes(1025), 1280u);
+   {
+      SMT::StandardMatrix<double> matrix(20, 30, initFunc, &pool);
+      CheckForEachElement<double>(matrix, initFunc, true, 1.0);
+   }
+   EXPECT_EQ(pool.MissCount(), 1u);
+   EXPECT_EQ(pool.CachedBytes(), SMT::PoolMemoryResource::ClassBytes(20 * 30 * sizeof(double)));
+
+   // Results of operations are allocated by the default resource, so a solver loop reuses the same buffers
+   SMT::MemorySettings::SetDefaultResource(&pool);
+   {
+      const SMT::StandardMatrix<double> matrix(20, 30, initFunc);
+      EXPECT_EQ(pool.HitCount(), 1u);
+      double squaredNorm = 0.0;
+      for (size_t column = 0; column < 30; ++column)
+      {
+         squaredNorm += matrix.Element(3, column) * matrix.Element(3, column);
+      }
+      for (size_t iteration = 0; iteration < 10; ++iteration)
+      {
+         const auto transposed = matrix.Transpose();
+         ASSERT_TRUE(transposed.Matrix_ != nullptr);
+         const auto product = SMT::StandardMatrix<double>::Multiply(matrix, *transposed.Matrix_);
+         ASSERT_TRUE(product.Matrix_ != nullptr);
+         EXPECT_DOUBLE_EQ(product.Matrix_->Element(3, 3), squaredNorm);
+      }
+   }
+   SMT::MemorySettings::SetDefaultResource(nullptr);
+   EXPECT_EQ(&SMT::MemorySettings::DefaultResource(), &SMT::MemorySettings::Details::AlignedResource());
+   // The source matrix, the transposed one and the product
+   EXPECT_EQ(pool.MissCount(), 3u);
+   EXPECT_EQ(pool.HitCount(), 1u + 2u * 9u);
+
+   pool.Release();
+   EXPECT_EQ(pool.CachedBytes(), 0u);
+}
+
+TEST_F(StandardMatrixTest, MoveAndOwnershipTransfer)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row * 10 + column); };
+
+   // A vector is adopted and taken back without copying
+   std::vector<double> elements(4 * 6);
+   for (size_t i = 0; i < elements.size(); ++i)
+   {
+      elements[i] = initFunc(i / 6, i % 6);
+   }
+   const double* vectorData = elements.data();
+   SMT::StandardMatrix<double> matrix(4, 6, std::move(elements));
+   EXPECT_EQ(matrix.Data(), vectorData);
+   CheckForEachElement<double>(matrix, initFunc, true, 1.0);
+
+   // Moving keeps the storage and leaves the source empty. It doesn't throw, so containers move matrices instead of copying them.
+   static_assert(std::is_nothrow_move_constructible<SMT::StandardMatrix<double>>::value, "StandardMatrix is moved without exceptions");
+   static_assert(std::is_nothrow_move_assignable<SMT::StandardMatrix<double>>::value, "StandardMatrix is moved without exceptions");
+   static_assert(std::is_nothrow_move_constructible<SMT::MatrixBuffer<double>>::value, "MatrixBuffer is moved without exceptions");
+   static_assert(std::is_nothrow_move_assignable<SMT::MatrixBuffer<double>>::value, "MatrixBuffer is moved without exceptions");
+   SMT::StandardMatrix<double> movedMatrix(std::move(matrix));
+   EXPECT_EQ(movedMatrix.Data(), vectorData);
+   EXPECT_EQ(matrix.RowCount(), 0u);
+   EXPECT_EQ(matrix.ColumnCount(), 0u);
+   SMT::StandardMatrix<double> assignedMatrix(1, 1);
+   assignedMatrix = std::move(movedMatrix);
+   EXPECT_EQ(assignedMatrix.Data(), vectorData);
+   EXPECT_EQ(assignedMatrix.RowCount(), 4u);
+   CheckForEachElement<double>(assignedMatrix, initFunc, true, 1.0);
+
+   SMT::MatrixBuffer<double> buffer = assignedMatrix.Release();
+   EXPECT_EQ(assignedMatrix.RowCount(), 0u);
+   EXPECT_EQ(buffer.Data(), vectorData);
+   EXPECT_EQ(buffer.Resource(), nullptr);
+   const std::vector<double> releasedElements = buffer.ReleaseVector();
+   EXPECT_EQ(releasedElements.data(), vectorData);
+   EXPECT_TRUE(buffer.Empty());
+
+   // An aligned buffer is adopted without copying as well, the copy of a matrix has its own buffer
+   SMT::MatrixBuffer<double> alignedBuffer(3 * 5, 1.5, nullptr);
+   const double* alignedData = alignedBuffer.Data();
+   SMT::StandardMatrix<double> alignedMatrix(3, 5, std::move(alignedBuffer));
+   EXPECT_EQ(alignedMatrix.Data(), alignedData);
+   EXPECT_TRUE(alignedBuffer.Empty());
+   SMT::StandardMatrix<double> copy(alignedMatrix);
+   EXPECT_NE(copy.Data(), alignedData);
+   CheckEquality<double>(copy, alignedMatrix, true, 1.0);
+   SMT::MatrixBuffer<double> releasedBuffer = alignedMatrix.Release();
+   EXPECT_EQ(releasedBuffer.Data(), alignedData);
+   EXPECT_EQ(releasedBuffer.ReleaseVector(), std::vector<double>(3 * 5, 1.5));
+}
+
+TEST_F(StandardMatrixTest, CopyOnWrite)
+{
+   auto initFunc = [](size_t row, size_t column)->double { return static_cast<double>(row * 10 + column); };
+   const SMT::StandardMatrix<double> matrix(5, 5, initFunc);
+   EXPECT_EQ(matrix.CopyingComplexity(), SMT::Complexity::Constant);
+
+   // Copies share elements until they are changed
+   const auto copyResult = matrix.Copy();
+   ASSERT_EQ(copyResult.Code_, SMT::OperationResultCode::Ok);
+   auto& copy = dynamic_cast<SMT::StandardMatrix<double>&>(*copyResult.Matrix_);
+   EXPECT_EQ(static_cast<const SMT::StandardMatrix<double>&>(copy).Data(), matrix.Data());
+   SMT::StandardMatrix<double> secondCopy(matrix);
+   EXPECT_EQ(static_cast<const SMT::StandardMatrix<double>&>(secondCopy).Data(), matrix.Data());
+
+   // Elementary operations detach the changed copy only
+   ASSERT_TRUE(copy.ElementaryOperations() != nullptr);
+   EXPECT_TRUE(copy.ElementaryOperations()->SwapRows(0, 4));
+   EXPECT_NE(static_cast<const SMT::StandardMatrix<double>&>(copy).Data(), matrix.Data());
+   CheckForEachElement<double>(matrix, initFunc, true, 1.0);
+   CheckForEachElement<double>(copy, [&initFunc](size_t row, size_t column) { return initFunc((row == 0) ? 4 : ((row == 4) ? 0 : row), column); }, true, 1.0);
+   EXPECT_EQ(static_cast<const SMT::StandardMatrix<double>&>(secondCopy).Data(), matrix.Data());
+
+   // In-place operations detach as well, an operand which shares the storage is read before it is overwritten
+   EXPECT_EQ(SMT::MultiplyInto<double>(secondCopy, matrix, matrix).Code_, SMT::OperationResultCode::Ok);
+   const auto product = SMT::Multiply(matrix, matrix);
+   CheckEquality<double>(secondCopy, *product.Matrix_, true, 1.0);
+   CheckForEachElement<double>(matrix, initFunc, true, 1.0);
+
+   // A lazy expression overwrites the destination: its shared storage is replaced, the source isn't changed
+   auto destination = std::make_shared<SMT::StandardMatrix<double>>(matrix);
+   EXPECT_EQ((2.0 * SMT::Lazy<double>(matrix)).EvaluateTo(destination).Code_, SMT::OperationResultCode::Ok);
+   EXPECT_NE(static_cast<const SMT::StandardMatrix<double>&>(*destination).Data(), matrix.Data());
+   CheckForEachElement<double>(*destination, [&initFunc](size_t row, size_t column) { return 2.0 * initFunc(row, column); }, true, 1.0);
+   CheckForEachElement<double>(matrix, initFunc, true, 1.0);
+
+   // Gauss–Jordan elimination changes its copy only
+   const auto inverse = SMT::Algorithms::GaussJordanElimination<double>(SMT::StandardMatrix<double>(3, 3, [](size_t row, size_t column) { return (row == column) ? 2.0 : 1.0; }),
+      [](size_t size) { return std::make_shared<SMT::StandardMatrix<double>>(size, size, SMT::MatrixSettings::IdentityMatrixFunction<double>()); });
+   EXPECT_EQ(inverse.Code_, SMT::OperationResultCode::Ok);
+
+   // External data is copied
+   std::vector<double> data(4, 1.0);
+   const SMT::StandardMatrix<double> external(2, 2, data[0]);
+   EXPECT_EQ(external.CopyingComplexity(), SMT::Complexity::Quadratic);
+   const auto externalCopy = external.Copy();
+   ASSERT_TRUE(externalCopy.Matrix_ != nullptr);
+   EXPECT_NE(externalCopy.Matrix_->RowData(0), data.data());
+}
@@ -0,0 +1,124 @@
+#include "../stdafx.h"
+
+#include "MatrixTest.h"
+#include "../../SMT/Matrix/MatrixOperations.h"
+#include "../../SMT/Matrix/SymmetricMatrix.h"
+
+class SymmetricMatrixTest : public MatrixTest
+{
+protected:
+   // The diagonal dominates: the matrix is positive definite
+   static double PositiveDefiniteElement(size_t row, size_t column)
+   {
+      return (row == column) ? 2.0 * static_cast<double>(row + 1) + 10.0 : 1.0 / (1.0 + static_cast<double>(row + column));
+   }
+   // The diagonal alternates its sign: the matrix is indefinite
+   static double IndefiniteElement(size_t row, size_t column)
+   {
+      return (row == column) ? ((row % 2 == 0) ? 10.0 : -10.0) : 1.0 / (1.0 + static_cast<double>(row + column));
+   }
+};
+
+TEST_F(SymmetricMatrixTest, Elements)
+{
+   const size_t size = 9;
+   const SMT::SymmetricMatrix<double> symmetricMatrix(size, DenseElement);
+   auto symmetricFunc = [](size_t row, size_t column) { return DenseElement(std::max(row, column), std::min(row, column)); };
+   CheckForEachElement<double>(symmetricMatrix, symmetricFunc, true, SMT::MatrixSettings::One<double>());
+
+   // The lower triangle of a standard matrix
+   const SMT::SymmetricMatrix<double> copy(SMT::StandardMatrix<double>(size, size, DenseElement));
+   CheckForEachElement<double>(copy, symmetricFunc, true, SMT::MatrixSettings::One<double>());
+
+   // Copies and the transposed matrix share the triangle
+   auto transposeResult = SMT::Transpose<double>(symmetricMatrix);
+   ASSERT_TRUE(transposeResult.Matrix_ != nullptr);
+   EXPECT_EQ(transposeResult.Matrix_->TypeName(), "SymmetricMatrix");
+   EXPECT_EQ(static_cast<const SMT::SymmetricMatrix<double>&>(*transposeResult.Matrix_).Elements(), symmetricMatrix.Elements());
+
+   const SMT::StandardMatrix<double> standardMatrix(symmetricMatrix);
+   CheckResult(SMT::Add<double>(symmetricMatrix, symmetricMatrix), "SymmetricMatrix", *SMT::MultiplyByNumber<double>(standardMatrix, 2.0).Matrix_, 1.0);
+   CheckResult(SMT::Add<double>(symmetricMatrix, SMT::StandardMatrix<double>(size, size, DenseElement)), "StandardMatrix",
+      *SMT::Add<double>(standardMatrix, SMT::StandardMatrix<double>(size, size, DenseElement)).Matrix_, 1.0);
+   CheckResult(SMT::MultiplyByNumber<double>(symmetricMatrix, -0.5), "SymmetricMatrix", *SMT::MultiplyByNumber<double>(standardMatrix, -0.5).Matrix_, 1.0);
+   CheckResult(SMT::Multiply<double>(symmetricMatrix, symmetricMatrix), "StandardMatrix", *SMT::Multiply<double>(standardMatrix, standardMatrix).Matrix_, 1e2);
+}
+
+TEST_F(SymmetricMatrixTest, RankKUpdate)
+{
+   // Several blocks, the last one is incomplete
+   const size_t size = 2 * SMT::SymmetricMatrix<double>::BlockSize + 7;
+   const SMT::StandardMatrix<double> matrix(31, size, DenseElement);
+   auto expectedMatrix = SMT::Multiply<double>(*matrix.Transpose().Matrix_, matrix).Matrix_;
+
+   auto gramMatrix = SMT::SymmetricMatrix<double>::RankKUpdate(matrix);
+   EXPECT_EQ(gramMatrix->RowCount(), size);
+   CheckForEachElement<double>(*gramMatrix, [&](size_t row, size_t column) { return expectedMatrix->Element(row, column); }, false, 1e4);
+
+   // Parallel products are the same as serial ones
+   const size_t threshold = SMT::ParallelSettings::MultiplyThreshold();
+   SMT::ParallelSettings::SetMultiplyThreshold(1);
+   gramMatrix = SMT::SymmetricMatrix<double>::RankKUpdate(matrix, 0.5);
+   CheckForEachElement<double>(*gramMatrix, [&](size_t row, size_t column) { return 0.5 * expectedMatrix->Element(row, column); }, false, 1e4);
+   SMT::ParallelSettings::SetMultiplyThreshold(threshold);
+}
+
+TEST_F(SymmetricMatrixTest, Factorizations)
+{
+   const size_t size = 2 * SMT::Algorithms::CholeskyDecomposition<double>::DefaultBlockSize + 5;
+   const SMT::StandardMatrix<double> rightHandSide(size, 3, DenseElement);
+   const SMT::StandardMatrix<double> identityMatrix(size, size, SMT::MatrixSettings::IdentityMatrixFunction<double>());
+   for (auto elementFunc : { PositiveDefiniteElement, IndefiniteElement })
+   {
+      const SMT::SymmetricMatrix<double> symmetricMatrix(size, elementFunc);
+      const SMT::StandardMatrix<double> standardMatrix(symmetricMatrix);
+
+      auto solution = SMT::Solve<double>(symmetricMatrix, rightHandSide);
+      ASSERT_TRUE(solution.Matrix_ != nullptr);
+      CheckResult(SMT::Multiply<double>(standardMatrix, *solution.Matrix_), "StandardMatrix", rightHandSide, 1e4);
+
+      auto inverse = SMT::Invert<double>(symmetricMatrix);
+      ASSERT_TRUE(inverse.Matrix_ != nullptr);
+      EXPECT_EQ(inverse.Matrix_->TypeName(), "SymmetricMatrix");
+      CheckResult(SMT::Multiply<double>(standardMatrix, *inverse.Matrix_), "StandardMatrix", identityMatrix, 1e4);
+
+      const SMT::SymmetricMatrix<double> smallMatrix(12, elementFunc);
+      auto determinant = SMT::Determinant<double>(smallMatrix);
+      auto expectedDeterminant = SMT::Determinant<double>(SMT::StandardMatrix<double>(smallMatrix));
+      ASSERT_TRUE(determinant.Value_ != nullptr);
+      ASSERT_TRUE(expectedDeterminant.Value_ != nullptr);
+      EXPECT_NEAR(*determinant.Value_ / *expectedDeterminant.Value_, 1.0, 1e-9);
+   }
+
+   // Cholesky agrees with the positive definiteness
+   const SMT::StandardMatrix<double> positiveDefiniteMatrix(size, size, PositiveDefiniteElement);
+   EXPECT_TRUE(SMT::Algorithms::CholeskyDecomposition<double>(size, positiveDefiniteMatrix.Data(), size).IsPositiveDefinite());
+   EXPECT_TRUE(SMT::Algorithms::CholeskyDecomposition<double>(size, positiveDefiniteMatrix.Data(), size, 16).IsPositiveDefinite());
+   const SMT::StandardMatrix<double> indefiniteMatrix(size, size, IndefiniteElement);
+   EXPECT_FALSE(SMT::Algorithms::CholeskyDecomposition<double>(size, indefiniteMatrix.Data(), size).IsPositiveDefinite());
+
+   // Zeros on the diagonal: Cholesky fails, pivoted LU solves the system
+   const SMT::SymmetricMatrix<double> permutationMatrix(2, [](size_t row, size_t column) { return (row == column) ? 0.0 : 1.0; });
+   const SMT::StandardMatrix<double> vector(2, 1, [](size_t row, size_t) { return static_cast<double>(row) + 1.0; });
+   CheckResult(SMT::Solve<double>(permutationMatrix, vector), "StandardMatrix", SMT::StandardMatrix<double>(2, 1, [](size_t row, size_t) { return 2.0 - static_cast<double>(row); }), 1.0);
+   auto determinant = SMT::Determinant<double>(permutationMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, -1.0);
+
+   // A tiny leading pivot of an indefinite, well conditioned matrix: the pivoted factorization keeps full accuracy
+   const SMT::SymmetricMatrix<double> smallPivotMatrix(2, [](size_t row, size_t column) { return (row + column == 0) ? 1e-13 : 1.0; });
+   auto smallPivotSolution = SMT::Solve<double>(smallPivotMatrix, vector);
+   ASSERT_TRUE(smallPivotSolution.Matrix_ != nullptr);
+   EXPECT_NEAR(smallPivotSolution.Matrix_->Element(0, 0), 1.0 / (1.0 - 1e-13), 1e-15);
+   EXPECT_NEAR(smallPivotSolution.Matrix_->Element(1, 0), (1.0 - 2e-13) / (1.0 - 1e-13), 1e-15);
+   determinant = SMT::Determinant<double>(smallPivotMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_NEAR(*determinant.Value_, 1e-13 - 1.0, 1e-15);
+
+   const SMT::SymmetricMatrix<double> singularMatrix(3, [](size_t, size_t) { return 1.0; });
+   EXPECT_EQ(SMT::Invert<double>(singularMatrix).Code_, SMT::OperationResultCode::Error);
+   EXPECT_EQ(SMT::Solve<double>(singularMatrix, SMT::StandardMatrix<double>(3, 1)).Code_, SMT::OperationResultCode::Error);
+   determinant = SMT::Determinant<double>(singularMatrix);
+   ASSERT_TRUE(determinant.Value_ != nullptr);
+   EXPECT_EQ(*determinant.Value_, 0.0);
+}
@@ -0,0 +1,125 @@
+#include "../stdafx.h"
+
+#include "MatrixTest.h"
+#include "../../SMT/Matrix/MatrixOperations.h"
+#include "../../SMT/Matrix/TriangularMatrix.h"
+
+class TriangularMatrixTest : public MatrixTest
+{
+protected:
+   using Part = SMT::TriangularMatrix<double>::Part;
+
+   // The diagonal dominates, so solves are well-conditioned
+   static double TriangleElement(size_t row, size_t column)
+   {
+      return (row == column) ? 4.0 + static_cast<double>(row % 5) : 1.0 / (1.0 + static_cast<double>((row * 7 + column * 3) % 11));
+   }
+   static std::function<double(size_t, size_t)> TriangleFunc(Part part)
+   {
+      return [part](size_t row, size_t column) { return ((part == Part::Lower) ? (column <= row) : (column >= row)) ? TriangleElement(row, column) : 0.0; };
+   }
+};
+
+TEST_F(TriangularMatrixTest, Elements)
+{
+   const size_t size = 9;
+   for (Part part : { Part::Lower, Part::Upper })
+   {
+      const SMT::TriangularMatrix<double> triangularMatrix(size, part, TriangleElement);
+      CheckForEachElement<double>(triangularMatrix, TriangleFunc(part), true, SMT::MatrixSettings::One<double>());
+
+      // The tile crosses the diagonal
+      std::vector<double> tile(4 * 5, -1.0);
+      triangularMatrix.CopyTile(3, 2, 4, 5, tile.data(), 5);
+      for (size_t row = 0; row < 4; ++row)
+      {
+         for (size_t column = 0; column < 5; ++column)
+         {
+            EXPECT_EQ(tile[row * 5 + column], TriangleFunc(part)(3 + row, 2 + column));
+         }
+      }
+
+      // The triangle of a standard matrix
+      const SMT::TriangularMatrix<double> copy(SMT::StandardMatrix<double>(size, size, TriangleElement), part);
+      CheckForEachElement<double>(copy, TriangleFunc(part), true, SMT::MatrixSettings::One<double>());
+
+      // Copies share the triangle
+      auto copyResult = triangularMatrix.Copy();
+      EXPECT_EQ(copyResult.Matrix_->TypeName(), "TriangularMatrix");
+      EXPECT_EQ(static_cast<const SMT::TriangularMatrix<double>&>(*copyResult.Matrix_).Elements(), triangularMatrix.Elements());
+
+      auto transposeResult = SMT::Transpose<double>(triangularMatrix);
+      ASSERT_TRUE(transposeResult.Matrix_ != nullptr);
+      EXPECT_EQ(transposeResult.Matrix_->TypeName(), "TriangularMatrix");
+      CheckForEachElement<double>(*transposeResult.Matrix_, [&](size_t row, size_t column) { return TriangleFunc(part)(column, row); }, true, SMT::MatrixSettings::One<double>());
+   }
+}
+
+TEST_F(TriangularMatrixTest, AdditionAndMultiplication)
+{
+   // Several blocks, the last one is incomplete
+   const size_t size = 2 * SMT::TriangularMatrix<double>::BlockSize + 13;
+   const SMT::StandardMatrix<double> rightMatrix(size, 17, DenseElement);
+   const SMT::StandardMatrix<double> leftMatrix(11, size, DenseElement);
+   for (Part part : { Part::Lower, Part::Upper })
+   {
+      const SMT::TriangularMatrix<double> triangularMatrix(size, part, TriangleElement);
+      const SMT::TriangularMatrix<double> otherMatrix(size, (part == Part::Lower) ? Part::Upper : Part::Lower, TriangleElement);
+      const SMT::StandardMatrix<double> standardMatrix(triangularMatrix);
+
+      CheckResult(SMT::Add<double>(triangularMatrix, triangularMatrix), "TriangularMatrix", *SMT::MultiplyByNumber<double>(standardMatrix, 2.0).Matrix_, 1.0);
+      CheckResult(SMT::Add<double>(triangularMatrix, otherMatrix), "StandardMatrix", *SMT::Add<double>(standardMatrix, SMT::StandardMatrix<double>(otherMatrix)).Matrix_, 1.0);
+      CheckResult(SMT::MultiplyByNumber<double>(triangularMatrix, -3.0), "TriangularMatrix", *SMT::MultiplyByNumber<double>(standardMatrix, -3.0).Matrix_, 1.0);
+
+      // Blocked products are compared with the dense ones
+      CheckResult(SMT::Multiply<double>(triangularMatrix, rightMatrix), "StandardMatrix", *SMT::Multiply<double>(standardMatrix, rightMatrix).Matrix_, 1e4);
+      CheckResult(SMT::Multiply<double>(leftMatrix, triangularMatrix), "StandardMatrix", *SMT::Multiply<double>(leftMatrix, standardMatrix).Matrix_, 1e4);
+      CheckResult(SMT::Multiply<double>(triangularMatrix, triangularMatrix), "TriangularMatrix", *SMT::Multiply<double>(standardMatrix, standardMatrix).Matrix_, 1e4);
+      CheckResult(SMT::Multiply<double>(triangularMatrix, otherMatrix), "StandardMatrix", *SMT::Multiply<double>(standardMatrix, SMT::StandardMatrix<double>(otherMatrix)).Matrix_, 1e4);
+
+      // Parallel products are the same as serial ones
+      const size_t threshold = SMT::ParallelSettings::MultiplyThreshold();
+      SMT::ParallelSettings::SetMultiplyThreshold(1);
+      CheckResult(SMT::Multiply<double>(triangularMatrix, rightMatrix), "StandardMatrix", *SMT::Multiply<double>(standardMatrix, rightMatrix).Matrix_, 1e4);
+      CheckResult(SMT::Multiply<double>(leftMatrix, triangularMatrix), "StandardMatrix", *SMT::Multiply<double>(leftMatrix, standardMatrix).Matrix_, 1e4);
+      SMT::ParallelSettings::SetMultiplyThreshold(threshold);
+
+      EXPECT_EQ(triangularMatrix.Multiply(leftMatrix, false).Code_, SMT::OperationResultCode::Error);
+   }
+}
+
+TEST_F(TriangularMatrixTest, SolvingAndInversion)
+{
+   const size_t size = 2 * SMT::TriangularMatrix<double>::BlockSize + 13;
+   const SMT::StandardMatrix<double> rightHandSide(size, 5, DenseElement);
+   for (Part part : { Part::Lower, Part::Upper })
+   {
+      const SMT::TriangularMatrix<double> triangularMatrix(size, part, TriangleElement);
+      EXPECT_EQ(triangularMatrix.SolvingComplexity(SMT::StandardMatrix<double>(size, 1)), SMT::Complexity::Quadratic);
+
+      // This * X gives the right-hand side back
+      auto solution = SMT::Solve<double>(triangularMatrix, rightHandSide);
+      ASSERT_TRUE(solution.Matrix_ != nullptr);
+      CheckResult(SMT::Multiply<double>(triangularMatrix, *solution.Matrix_), "StandardMatrix", rightHandSide, 1e4);
+
+      auto inverse = SMT::Invert<double>(triangularMatrix);
+      ASSERT_TRUE(inverse.Matrix_ != nullptr);
+      EXPECT_EQ(inverse.Matrix_->TypeName(), "TriangularMatrix");
+      CheckResult(SMT::Multiply<double>(triangularMatrix, *inverse.Matrix_), "TriangularMatrix", SMT::StandardMatrix<double>(size, size, SMT::MatrixSettings::IdentityMatrixFunction<double>()), 1e4);
+
+      double expectedDeterminant = 1.0;
+      for (size_t index = 0; index < 7; ++index)
+      {
+         expectedDeterminant *= TriangleElement(index, index);
+      }
+      auto determinant = SMT::Determinant<double>(SMT::TriangularMatrix<double>(7, part, TriangleElement));
+      ASSERT_TRUE(determinant.Value_ != nullptr);
+      EXPECT_EQ(*determinant.Value_, expectedDeterminant);
+
+      // A zero on the diagonal
+      const SMT::TriangularMatrix<double> singularMatrix(4, part, [](size_t row, size_t column) { return (row == column && row == 2) ? 0.0 : 1.0; });
+      EXPECT_EQ(SMT::Solve<double>(singularMatrix, SMT::StandardMatrix<double>(4, 1)).Code_, SMT::OperationResultCode::Error);
+      EXPECT_EQ(SMT::Invert<double>(singularMatrix).Code_, SMT::OperationResultCode::Error);
+      EXPECT_EQ(SMT::Solve<double>(triangularMatrix, SMT::StandardMatrix<double>(size + 1, 1)).Code_, SMT::OperationResultCode::Error);
+   }
+}
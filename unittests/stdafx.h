@@ -8,7 +8,9 @@
 #include "targetver.h"
 
 #include <stdio.h>
+#if defined(_WIN32)
 #include <tchar.h>
+#endif
 
 
 
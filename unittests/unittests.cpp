@@ -5,11 +5,13 @@
 
 #include "gtest/gtest.h"
 
-int _tmain(int argc, _TCHAR* argv[])
+int main(int argc, char* argv[])
 {
    ::testing::InitGoogleTest(&argc, argv);
    const int result = RUN_ALL_TESTS();
-   getchar();
+#if defined(_WIN32)
+   getchar();                                   // Keeps the console window open
+#endif
    return result;
 }
 